@@ -43,8 +43,12 @@ int main(int argc, char* argv[]) {
         bool has_limitless_instance = GetLimitlessInstance((SQLTCHAR *) conn_str, server_port, service_id, MAX_SERVER_HOST_SIZE, &limitless_info);
 
         // ... do things with new server host...
+        // If connecting to the server host fails, report it so other connections skip it until it is reachable again
+        // ReportLimitlessRouterFailure(service_id, limitless_info.server);
 
         // Cleanup
+        // Once the connection to the server host is closed, release it for the power_of_two and least_outstanding router selections
+        // ReleaseLimitlessInstance(service_id, limitless_info.server);
         free(limitless_info.server);
         // Decrements reference count for thread running for the given service ID
         // Once reference count reaches 0, the thread will stop
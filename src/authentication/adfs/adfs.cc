@@ -22,9 +22,6 @@
 #include "../html_util.h"
 #include "../util/logger_wrapper.h"
 
-const std::string AdfsCredentialsProvider::FORM_ACTION_PATTERN = "<form.*?action=\"([^\"]+)\"";
-const std::string AdfsCredentialsProvider::INPUT_TAG_PATTERN = "<input id=(.*)";
-const std::string AdfsCredentialsProvider::SAML_RESPONSE_PATTERN = "name=\"SAMLResponse\"\\s+value=\"([^\"]+)\"";
 const std::string AdfsCredentialsProvider::URL_PATTERN = "^(https)://[-a-zA-Z0-9+&@#/%?=~_!:,.']*[-a-zA-Z0-9+&@#/%=~_']";
 
 std::string AdfsCredentialsProvider::GetSAMLAssertion(std::string& err_info) {
@@ -45,16 +42,10 @@ std::string AdfsCredentialsProvider::GetSAMLAssertion(std::string& err_info) {
         return retval;
     }
 
-    std::istreambuf_iterator<char> eos;
-    std::string body(std::istreambuf_iterator<char>(response->GetResponseBody().rdbuf()), eos);
-    DLOG(INFO) << "Signout response body: " << body;
-
-    // retrieve SAMLResponse value
-    std::smatch matches;
+    // retrieve the form action and inputs, read straight from the response stream
     std::string action;
-    if (std::regex_search(body, matches, std::regex(FORM_ACTION_PATTERN))) {
-        action = HtmlUtil::EscapeHtmlEntity(matches.str(1));
-    } else {
+    std::vector<std::pair<std::string, std::string>> inputs;
+    if (!HtmlUtil::ExtractForm(response->GetResponseBody(), action, inputs)) {
         err_info = "Could not extract action from the response body";
         return retval;
     }
@@ -68,12 +59,11 @@ std::string AdfsCredentialsProvider::GetSAMLAssertion(std::string& err_info) {
     }
     DLOG(INFO) << "Updated URL [" << url << "] using Action [" << action << "]";
 
-    std::map<std::string, std::string> params = get_para_from_html_body(body);
-    std::string content = get_form_action_body(url, params);
-
-    if (std::regex_search(content, matches, std::regex(SAML_RESPONSE_PATTERN))) {
-        DLOG(INFO) << "SAML Response: " << matches.str(1);
-        return matches.str(1);
+    std::map<std::string, std::string> params = get_para_from_html_body(inputs);
+    std::string saml_response = get_saml_response(url, params);
+    if (!saml_response.empty()) {
+        DLOG(INFO) << "SAML Response: " << saml_response;
+        return saml_response;
     }
     LOG(WARNING) << "Failed SAML Asesertion";
     return retval;
@@ -90,7 +80,7 @@ std::string AdfsCredentialsProvider::get_signin_url() {
 }
 
 bool AdfsCredentialsProvider::validate_url(const std::string& url) {
-    std::regex pattern(URL_PATTERN);
+    static const std::regex pattern(URL_PATTERN);
 
     if (!regex_match(url, pattern)) {
         LOG(WARNING) << "Invalid URL, failed to match ADFS URL pattern";
@@ -99,55 +89,18 @@ bool AdfsCredentialsProvider::validate_url(const std::string& url) {
     return true;
 }
 
-std::vector<std::string> AdfsCredentialsProvider::get_input_tags_from_html(const std::string& body) {
-    std::unordered_set<std::string> hash_set;
-    std::vector<std::string> retval;
-
-    std::smatch matches;
-    std::regex pattern(INPUT_TAG_PATTERN);
-    std::string source = body;
-    while (std::regex_search(source,matches,pattern)) {
-        std::string tag = matches.str(0);
-        std::string tag_name = get_value_by_key(tag, std::string("name"));
-        DLOG(INFO) << "Tag [" << tag << "], Tag Name [" << tag_name << "]";
-        std::transform(tag_name.begin(), tag_name.end(), tag_name.begin(), [](unsigned char c) {
-            return std::tolower(c);
-        });
-        if (!tag_name.empty() && !hash_set.contains(tag_name)) {
-            hash_set.insert(tag_name);
-            retval.push_back(tag);
-            DLOG(INFO) << "Saved input_tag: " << tag;
-        }
-
-        source = matches.suffix().str();
-    }
-
-	DLOG(INFO) << "Input tags vector size: " << retval.size();
-    return retval;
-}
-
-std::string AdfsCredentialsProvider::get_value_by_key(const std::string& input, const std::string& key) {
-    std::string pattern("(");
-    pattern += key;
-    pattern += ")\\s*=\\s*\"(.*?)\"";
-
-    std::smatch matches;
-    if (std::regex_search(input, matches, std::regex(pattern))) {
-        return HtmlUtil::EscapeHtmlEntity(matches.str(2));
-    }
-    return "";
-}
-
-std::map<std::string, std::string> AdfsCredentialsProvider::get_para_from_html_body(std::string& body) {
+std::map<std::string, std::string> AdfsCredentialsProvider::get_para_from_html_body(const std::vector<std::pair<std::string, std::string>>& inputs) {
     std::map<std::string, std::string> parameters;
-    for (auto& input_tag : get_input_tags_from_html(body)) {
-        std::string name = get_value_by_key(input_tag, std::string("name"));
-        std::string value = get_value_by_key(input_tag, std::string("value"));
-        DLOG(INFO) << "Input Tag [" << input_tag << "], Name [" << name << "], Value [" << value << "]";
+    std::unordered_set<std::string> seen_names;
+    for (const auto& [name, value] : inputs) {
         std::string name_lower(name);
         std::transform(name_lower.begin(), name_lower.end(), name_lower.begin(), [](unsigned char c) {
             return std::tolower(c);
         });
+        // Only the first input of a name is submitted, regardless of case
+        if (!seen_names.insert(name_lower).second) {
+            continue;
+        }
 
         if (name_lower.find("username") != std::string::npos) {
             parameters.insert(std::pair<std::string, std::string>(name, std::string(cfg.idp_username)));
@@ -170,7 +123,7 @@ std::map<std::string, std::string> AdfsCredentialsProvider::get_para_from_html_b
     return parameters;
 }
 
-std::string AdfsCredentialsProvider::get_form_action_body(std::string& url, std::map<std::string, std::string>& params) {
+std::string AdfsCredentialsProvider::get_saml_response(std::string& url, std::map<std::string, std::string>& params) {
     if (!validate_url(url)) {
         return "";
     }
@@ -201,7 +154,7 @@ std::string AdfsCredentialsProvider::get_form_action_body(std::string& url, std:
         return "";
     }
 
-    std::istreambuf_iterator< char > eos;
-    std::string resp_body(std::istreambuf_iterator< char >(response->GetResponseBody().rdbuf()), eos);
-    return resp_body;
+    std::string saml_response;
+    HtmlUtil::ExtractInputValue(response->GetResponseBody(), "SAMLResponse", saml_response);
+    return saml_response;
 }
@@ -17,6 +17,8 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "../authentication_provider.h"
 #include "../federation.h"
@@ -32,9 +34,6 @@ public:
         ), cfg(config) {}
 
     // constant pattern strings 
-    static const std::string FORM_ACTION_PATTERN;
-    static const std::string INPUT_TAG_PATTERN;
-    static const std::string SAML_RESPONSE_PATTERN;
     static const std::string URL_PATTERN;
 
 protected:
@@ -42,12 +41,10 @@ protected:
 
 private:
     std::string get_signin_url();
-    std::map<std::string, std::string> get_para_from_html_body(std::string& body);
-    std::string get_form_action_body(std::string& url, std::map<std::string, std::string>& params);
+    std::map<std::string, std::string> get_para_from_html_body(const std::vector<std::pair<std::string, std::string>>& inputs);
+    std::string get_saml_response(std::string& url, std::map<std::string, std::string>& params);
 
     static bool validate_url(const std::string& url);
-    static std::vector<std::string> get_input_tags_from_html(const std::string& body);
-    static std::string get_value_by_key(const std::string& input, const std::string& key);
 
     FederatedAuthConfig cfg;
 };
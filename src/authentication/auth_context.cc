@@ -0,0 +1,282 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "auth_context.h"
+
+#include <adfs/adfs.h>
+#include <okta/okta.h>
+
+#include <aws/core/auth/AWSCredentialsProviderChain.h>
+#include <aws/core/http/HttpClient.h>
+#include <aws/sts/STSClient.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <string_view>
+
+#include "../util/logger_wrapper.h"
+#include "../util/refresh_scheduler.h"
+#include "../util/string_to_number_converter.h"
+
+namespace {
+    constexpr uint64_t DEFAULT_SOCKET_TIMEOUT = 3000;
+    constexpr uint64_t DEFAULT_CONNECT_TIMEOUT = 5000;
+
+    bool validate_char_arr(std::string_view str) {
+        return !str.empty();
+    }
+
+    bool validate_adfs_conf(const FederatedAuthConfig& config) {
+        return validate_char_arr(config.idp_endpoint) &&
+            validate_char_arr(config.idp_port) &&
+            validate_char_arr(config.relaying_party_id) &&
+            validate_char_arr(config.iam_role_arn) &&
+            validate_char_arr(config.iam_idp_arn) &&
+            validate_char_arr(config.idp_username) &&
+            validate_char_arr(config.idp_password);
+    }
+
+    bool validate_okta_conf(const FederatedAuthConfig& config) {
+        return validate_char_arr(config.idp_endpoint) &&
+            validate_char_arr(config.idp_port) &&
+            validate_char_arr(config.app_id) &&
+            validate_char_arr(config.iam_role_arn) &&
+            validate_char_arr(config.iam_idp_arn) &&
+            validate_char_arr(config.idp_username) &&
+            validate_char_arr(config.idp_password);
+    }
+
+    uint64_t parse_number(const char* str_in, const uint64_t default_val) {
+        try {
+            return StringToNumberConverter::toLong(str_in);
+        } catch (std::exception& e) {
+            return default_val;
+        }
+    }
+
+    std::shared_ptr<Aws::Http::HttpClient> create_http_client(const FederatedAuthConfig& config, bool follow_redirects) {
+        Aws::Client::ClientConfiguration http_client_cfg;
+        http_client_cfg.requestTimeoutMs = parse_number(config.http_client_socket_timeout, DEFAULT_SOCKET_TIMEOUT);
+        http_client_cfg.connectTimeoutMs = parse_number(config.http_client_connect_timeout, DEFAULT_CONNECT_TIMEOUT);
+        http_client_cfg.verifySSL = true;
+        if (follow_redirects) {
+            http_client_cfg.followRedirects = Aws::Client::FollowRedirectsPolicy::ALWAYS;
+        }
+        return Aws::Http::CreateHttpClient(http_client_cfg);
+    }
+
+    std::unique_ptr<FederationCredentialProvider> create_federated_provider(FederatedAuthType type, const FederatedAuthConfig& config) {
+        switch (type) {
+            case ADFS:
+                return std::make_unique<AdfsCredentialsProvider>(config, create_http_client(config, false), std::make_shared<Aws::STS::STSClient>());
+            case OKTA:
+                return std::make_unique<OktaCredentialsProvider>(config, create_http_client(config, true), std::make_shared<Aws::STS::STSClient>());
+            default:
+                return nullptr;
+        }
+    }
+
+    void append_field(std::string& key, const char* field) {
+        // Fields are NUL terminated and cannot contain one, so it safely separates them
+        key += field;
+        key += '\0';
+    }
+}
+
+Aws::Auth::AWSCredentials FederatedCredentialsHolder::GetAWSCredentials() {
+    std::shared_lock<std::shared_mutex> lock(credentials_mutex_);
+    return credentials_;
+}
+
+void FederatedCredentialsHolder::SetCredentials(const Aws::Auth::AWSCredentials& credentials) {
+    std::unique_lock<std::shared_mutex> lock(credentials_mutex_);
+    credentials_ = credentials;
+}
+
+AuthContext::AuthContext(FederatedAuthType type, const FederatedAuthConfig& config)
+    : AuthContext(type, create_federated_provider(type, config)) {}
+
+AuthContext::AuthContext(FederatedAuthType type, std::unique_ptr<FederationCredentialProvider> federated_provider)
+    : type_{ type }, federated_provider_{ std::move(federated_provider) } {
+    if (federated_provider_) {
+        federated_holder_ = std::make_shared<FederatedCredentialsHolder>();
+        credentials_provider_ = federated_holder_;
+    } else {
+        // Resolves and refreshes the credentials of the environment on its own
+        credentials_provider_ = std::make_shared<Aws::Auth::DefaultAWSCredentialsProviderChain>();
+    }
+
+    Aws::RDS::RDSClientConfiguration rds_client_cfg;
+    rds_client_ = std::make_unique<Aws::RDS::RDSClient>(credentials_provider_, rds_client_cfg);
+}
+
+AuthContext::~AuthContext() {
+    uint64_t task_id;
+    {
+        std::lock_guard<std::mutex> lock(credentials_mutex_);
+        task_id = refresh_task_id_;
+    }
+    // Waits for a sign in in progress
+    if (task_id > 0) {
+        RefreshScheduler::Cancel(task_id);
+    }
+}
+
+std::string AuthContext::Key(FederatedAuthType type, const FederatedAuthConfig& config) {
+    std::string key(federated_auth_type_str[type]);
+    key += '\0';
+    if (IAM == type) {
+        // The configuration only applies to federated authentication
+        return key;
+    }
+    append_field(key, config.idp_endpoint);
+    append_field(key, config.idp_port);
+    append_field(key, config.relaying_party_id);
+    append_field(key, config.app_id);
+    append_field(key, config.iam_role_arn);
+    append_field(key, config.iam_idp_arn);
+    append_field(key, config.idp_username);
+    append_field(key, config.idp_password);
+    append_field(key, config.http_client_socket_timeout);
+    append_field(key, config.http_client_connect_timeout);
+    append_field(key, config.ssl_insecure);
+    return key;
+}
+
+bool AuthContext::ValidateConfig(FederatedAuthType type, const FederatedAuthConfig& config) {
+    bool valid = false;
+    switch (type) {
+        case ADFS:
+            valid = validate_adfs_conf(config);
+            break;
+        case IAM:
+            return true;
+        case OKTA:
+            valid = validate_okta_conf(config);
+            break;
+        default:
+            LOG(ERROR) << federated_auth_type_str[type] << " is not a valid authentication type.";
+            return false;
+    }
+    if (!valid) {
+        LOG(ERROR) << "Configuration for " << federated_auth_type_str[type] << " is invalid/incomplete.";
+    }
+    return valid;
+}
+
+bool AuthContext::GenerateConnectAuthToken(std::string& token, const std::string& db_hostname, const std::string& db_region, unsigned port, const std::string& db_user) {
+    LOG(INFO) << "Generating token for " << federated_auth_type_str[type_];
+
+    Aws::Auth::AWSCredentials credentials;
+    if (!get_credentials(credentials)) {
+        return false;
+    }
+
+    // Signed locally, the RDS client makes no request
+    Aws::String new_token = rds_client_->GenerateConnectAuthToken(db_hostname.c_str(), db_region.c_str(), port, db_user.c_str());
+    token.assign(new_token.c_str(), new_token.size());
+    return !token.empty();
+}
+
+bool AuthContext::get_credentials(Aws::Auth::AWSCredentials& credentials) {
+    if (federated_provider_) {
+        return get_federated_credentials(credentials);
+    }
+
+    credentials = credentials_provider_->GetAWSCredentials();
+    if (credentials.IsEmpty()) {
+        LOG(ERROR) << federated_auth_type_str[type_] << " provider failed to get valid credentials.";
+        return false;
+    }
+    return true;
+}
+
+bool AuthContext::get_federated_credentials(Aws::Auth::AWSCredentials& credentials) {
+    {
+        std::lock_guard<std::mutex> lock(credentials_mutex_);
+        if (Clock::now() < usable_until_) {
+            credentials = cached_credentials_;
+            if (!credentials_used_) {
+                credentials_used_ = true;
+                // The credentials may already be due for a refresh
+                if (refresh_task_id_ > 0) {
+                    RefreshScheduler::Wake(refresh_task_id_);
+                }
+            }
+            return true;
+        }
+    }
+    return fetch_federated_credentials(credentials, false);
+}
+
+bool AuthContext::fetch_federated_credentials(Aws::Auth::AWSCredentials& credentials, bool force) {
+    std::lock_guard<std::mutex> fetch_lock(fetch_mutex_);
+    if (!force) {
+        std::lock_guard<std::mutex> lock(credentials_mutex_);
+        if (Clock::now() < usable_until_) {
+            // Fetched by another thread while waiting
+            credentials = cached_credentials_;
+            return true;
+        }
+    }
+
+    if (!federated_provider_->GetAWSCredentials(credentials)) {
+        LOG(ERROR) << federated_auth_type_str[type_] << " provider failed to get valid credentials.";
+        return false;
+    }
+    federated_holder_->SetCredentials(credentials);
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point expiration = credentials.GetExpiration().UnderlyingTimestamp();
+    std::lock_guard<std::mutex> lock(credentials_mutex_);
+    cached_credentials_ = credentials;
+    credentials_used_ = false;
+    if (expiration <= now) {
+        // No usable expiration, sign in again for every token
+        usable_until_ = Clock::time_point();
+        refresh_at_ = Clock::time_point();
+        return true;
+    }
+
+    Clock::duration margin = std::min<Clock::duration>((expiration - now) / 4, MAX_USABLE_MARGIN);
+    usable_until_ = expiration - margin;
+    refresh_at_ = expiration - 2 * margin;
+    if (refresh_task_id_ == 0) {
+        refresh_task_id_ = RefreshScheduler::Schedule([this] { return run_credentials_refresh(); }, MAX_REFRESH_DELAY);
+    }
+    return true;
+}
+
+std::chrono::milliseconds AuthContext::run_credentials_refresh() {
+    std::unique_lock<std::mutex> lock(credentials_mutex_);
+    while (credentials_used_ && Clock::time_point() != refresh_at_) {
+        if (Clock::time_point now = Clock::now(); now < refresh_at_) {
+            return std::min(std::chrono::ceil<std::chrono::milliseconds>(refresh_at_ - now), MAX_REFRESH_DELAY);
+        }
+
+        lock.unlock();
+        Aws::Auth::AWSCredentials credentials;
+        bool success = fetch_federated_credentials(credentials, true);
+        lock.lock();
+
+        if (!success) {
+            refresh_at_ = Clock::now() + REFRESH_RETRY_INTERVAL;
+            if (refresh_at_ >= usable_until_) {
+                // Give up, the next token generation signs in once the credentials are no longer usable
+                credentials_used_ = false;
+            }
+        }
+    }
+    return MAX_REFRESH_DELAY;
+}
@@ -0,0 +1,107 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AUTH_CONTEXT_H_
+#define AUTH_CONTEXT_H_
+
+#include <aws/core/Aws.h>
+#include <aws/core/auth/AWSCredentials.h>
+#include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/rds/RDSClient.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+#include "authentication_provider.h"
+#include "federation.h"
+
+/**
+ * Hands the credentials last fetched from a federated identity provider to the signer of an RDS client.
+ */
+class FederatedCredentialsHolder : public Aws::Auth::AWSCredentialsProvider {
+public:
+    Aws::Auth::AWSCredentials GetAWSCredentials() override;
+    void SetCredentials(const Aws::Auth::AWSCredentials& credentials);
+
+private:
+    std::shared_mutex credentials_mutex_;
+    Aws::Auth::AWSCredentials credentials_;
+};
+
+/**
+ * Long lived AWS clients and credential providers for one authentication type and configuration.
+ * The AWS SDK must be initialized before a context is created, and shut down only after every context is destroyed.
+ * Contexts only lock to run the federated sign in, tokens for different contexts are generated in parallel.
+ *
+ * Federated credentials are reused until shortly before their STS expiration. While they are in use,
+ * a RefreshScheduler task signs in again once half of their usable lifetime has passed,
+ * so presigning a token needs no network I/O as long as the credentials are valid.
+ */
+class AuthContext {
+public:
+    AuthContext(FederatedAuthType type, const FederatedAuthConfig& config);
+    // Federated provider is null for IAM
+    AuthContext(FederatedAuthType type, std::unique_ptr<FederationCredentialProvider> federated_provider);
+    ~AuthContext();
+
+    /**
+     * Identifies the authentication type and the configuration fields it uses.
+     */
+    static std::string Key(FederatedAuthType type, const FederatedAuthConfig& config);
+    static bool ValidateConfig(FederatedAuthType type, const FederatedAuthConfig& config);
+
+    /**
+     * Presigns an RDS IAM authentication token with the context's credentials.
+     * Federated credentials are fetched from the identity provider first.
+     */
+    bool GenerateConnectAuthToken(std::string& token, const std::string& db_hostname, const std::string& db_region, unsigned port, const std::string& db_user);
+
+private:
+    typedef std::chrono::system_clock Clock;
+
+    // Longest lifetime of an RDS IAM authentication token, credentials are only handed out if they outlive it
+    static constexpr std::chrono::minutes MAX_USABLE_MARGIN = std::chrono::minutes(15);
+    static constexpr std::chrono::seconds REFRESH_RETRY_INTERVAL = std::chrono::seconds(30);
+    // Longest wait of the refresh task, which is otherwise woken when the credentials are first used
+    static constexpr std::chrono::milliseconds MAX_REFRESH_DELAY = std::chrono::minutes(1);
+
+    bool get_credentials(Aws::Auth::AWSCredentials& credentials);
+    bool get_federated_credentials(Aws::Auth::AWSCredentials& credentials);
+    bool fetch_federated_credentials(Aws::Auth::AWSCredentials& credentials, bool force);
+    std::chrono::milliseconds run_credentials_refresh();
+
+    FederatedAuthType type_;
+    // Used for IAM, federated types hand out their credentials through federated_holder_
+    std::shared_ptr<Aws::Auth::AWSCredentialsProvider> credentials_provider_;
+    std::unique_ptr<FederationCredentialProvider> federated_provider_;
+    std::shared_ptr<FederatedCredentialsHolder> federated_holder_;
+    std::unique_ptr<Aws::RDS::RDSClient> rds_client_;
+
+    // The sign in flow of the identity provider is not thread safe, readers of cached credentials never wait on it
+    std::mutex fetch_mutex_;
+    std::mutex credentials_mutex_;
+    Aws::Auth::AWSCredentials cached_credentials_;
+    Clock::time_point usable_until_;
+    Clock::time_point refresh_at_;
+    // Set by readers, credentials nobody reads are left to expire
+    bool credentials_used_ = false;
+    // Scheduled once credentials with an expiration are fetched, 0 until then
+    uint64_t refresh_task_id_ = 0;
+};
+
+#endif // AUTH_CONTEXT_H_
@@ -14,156 +14,125 @@
 
 #include "authentication_provider.h"
 
-#include <adfs/adfs.h>
-#include <okta/okta.h>
-
 #include <aws/core/Aws.h>
-#include <aws/core/auth/AWSCredentials.h>
-#include <aws/core/auth/AWSCredentialsProviderChain.h>
-#include <aws/core/http/HttpClient.h>
-#include <aws/rds/RDSClient.h>
-#include <aws/sts/STSClient.h>
 #include <glog/logging.h>
 
 #include <algorithm>
-#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
 #include "../util/logger_wrapper.h"
 #include "../util/string_to_number_converter.h"
+#include "auth_context.h"
+#include "secrets_cache.h"
 #include "secrets_manager_helper.h"
+#include "token_cache.h"
+
+/**
+ * Initializes the AWS SDK on first use, until ShutdownAuthentication shuts it down.
+ */
+class AwsSdk {
+public:
+    void Init() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!initialized_) {
+            Aws::InitAPI(sdk_opts_);
+            initialized_ = true;
+        }
+    }
 
-static Aws::SDKOptions sdk_opts;
-static std::atomic<int> sdk_ref_count{0};
-static std::mutex sdk_mutex;
+    void Shutdown() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (initialized_) {
+            Aws::ShutdownAPI(sdk_opts_);
+            initialized_ = false;
+        }
+    }
 
-static std::mutex global_auth_mutex;
+private:
+    Aws::SDKOptions sdk_opts_;
+    std::mutex mutex_;
+    bool initialized_ = false;
+};
 
-static constexpr uint64_t DEFAULT_SOCKET_TIMEOUT = 3000;
-static constexpr uint64_t DEFAULT_CONNECT_TIMEOUT = 5000;
+static bool FetchSecret(const std::string& secret_id, const std::string& region, SecretsCache::Secret& secret);
 
-struct TokenInfo {
-    std::string token;
-    uint64_t    expiration;  // the expiration time in second
-}; // TokenInfo;
+// None of these are ever destroyed. Shutting down the SDK or joining refresh threads from static destructors
+// deadlocks under the loader lock on Windows, and hangs the exit while a refresh waits on the network.
+// Everything is released by ShutdownAuthentication instead, or left to the OS if it is not called.
+static AwsSdk& aws_sdk = *new AwsSdk();
 
-// Cached TokenInfo
-static std::unordered_map<std::string, TokenInfo> cached_tokens;
+// Keys include the identity provider password, every password change leaves a context behind
+static constexpr size_t MAX_AUTH_CONTEXTS = 100;
+static std::mutex& auth_contexts_mutex = *new std::mutex();
+static std::unordered_map<std::string, std::shared_ptr<AuthContext>>& auth_contexts =
+    *new std::unordered_map<std::string, std::shared_ptr<AuthContext>>();
 
-static bool ValidateCharArr(std::string_view str) {
-    return !str.empty();
-}
+static std::mutex& sm_clients_mutex = *new std::mutex();
+static std::unordered_map<std::string, std::shared_ptr<Aws::SecretsManager::SecretsManagerClient>>& sm_clients =
+    *new std::unordered_map<std::string, std::shared_ptr<Aws::SecretsManager::SecretsManagerClient>>();
 
-static bool ValidateAdfsConf(FederatedAuthConfig config) {
-    return ValidateCharArr(config.idp_endpoint) &&
-        ValidateCharArr(config.idp_port) &&
-        ValidateCharArr(config.relaying_party_id) &&
-        ValidateCharArr(config.iam_role_arn) &&
-        ValidateCharArr(config.iam_idp_arn) &&
-        ValidateCharArr(config.idp_username) &&
-        ValidateCharArr(config.idp_password);
-}
+static TokenCache& cached_tokens = *new TokenCache();
+static SecretsCache& cached_secrets = *new SecretsCache(FetchSecret);
 
-static bool ValidateOktaConf(FederatedAuthConfig config) {
-    return ValidateCharArr(config.idp_endpoint) &&
-        ValidateCharArr(config.idp_port) &&
-        ValidateCharArr(config.app_id) &&
-        ValidateCharArr(config.iam_role_arn) &&
-        ValidateCharArr(config.iam_idp_arn) &&
-        ValidateCharArr(config.idp_username) &&
-        ValidateCharArr(config.idp_password);
-}
+static std::shared_ptr<AuthContext> GetAuthContext(FederatedAuthType type, const FederatedAuthConfig& config) {
+    if (!AuthContext::ValidateConfig(type, config)) {
+        return nullptr;
+    }
 
-static uint64_t ParseNumber(const char* str_in, const uint64_t default_val) {
-    try {
-        return StringToNumberConverter::toLong(str_in);
-    } catch (std::exception& e) {
-        return default_val;
+    std::string key = AuthContext::Key(type, config);
+    std::lock_guard<std::mutex> lock(auth_contexts_mutex);
+    auto itr = auth_contexts.find(key);
+    if (itr != auth_contexts.end()) {
+        return itr->second;
     }
-}
 
-static Aws::RDS::RDSClient* CreateRDSClient(FederatedAuthType type, FederatedAuthConfig config) {
-    Aws::Auth::AWSCredentials credentials;
-    switch (type) {
-        case ADFS: {
-            if (!ValidateAdfsConf(config)) {
-                LOG(ERROR) << "Configuration for " << federated_auth_type_str[type] << " is invalid/incomplete.";
-                return nullptr;
-            };
-            Aws::Client::ClientConfiguration http_client_cfg;
-            http_client_cfg.requestTimeoutMs = ParseNumber(config.http_client_socket_timeout, DEFAULT_SOCKET_TIMEOUT);
-            http_client_cfg.connectTimeoutMs = ParseNumber(config.http_client_connect_timeout, DEFAULT_CONNECT_TIMEOUT);
-            http_client_cfg.verifySSL = true;
-            std::shared_ptr<Aws::Http::HttpClient> http_client = Aws::Http::CreateHttpClient(http_client_cfg);
-            std::shared_ptr<Aws::STS::STSClient> sts_client = std::make_shared<Aws::STS::STSClient>();
-            AdfsCredentialsProvider adfs(config, http_client, sts_client);
-            if (!adfs.GetAWSCredentials(credentials)) {
-                LOG(ERROR) << federated_auth_type_str[type] << " provider failed to get valid credentials.";
-                return nullptr;
-            }
-            break;
-        }
-        case IAM: {
-            Aws::Auth::DefaultAWSCredentialsProviderChain cred_provider;
-            credentials = cred_provider.GetAWSCredentials();
-            break;
-        }
-        case OKTA: {
-            if (!ValidateOktaConf(config)) {
-                LOG(ERROR) << "Configuration for " << federated_auth_type_str[type] << " is invalid/incomplete.";
-                return nullptr;
-            };
-            Aws::Client::ClientConfiguration http_client_cfg;
-            http_client_cfg.requestTimeoutMs = ParseNumber(config.http_client_socket_timeout, DEFAULT_SOCKET_TIMEOUT);
-            http_client_cfg.connectTimeoutMs = ParseNumber(config.http_client_connect_timeout, DEFAULT_CONNECT_TIMEOUT);
-            http_client_cfg.verifySSL = true;
-            http_client_cfg.followRedirects = Aws::Client::FollowRedirectsPolicy::ALWAYS;
-            std::shared_ptr<Aws::Http::HttpClient> http_client = Aws::Http::CreateHttpClient(http_client_cfg);
-            std::shared_ptr<Aws::STS::STSClient> sts_client = std::make_shared<Aws::STS::STSClient>();
-            OktaCredentialsProvider okta(config, http_client, sts_client);
-            if (!okta.GetAWSCredentials(credentials)) {
-                LOG(ERROR) << federated_auth_type_str[type] << " provider failed to get valid credentials.";
-                return nullptr;
-            }
-            break;
-        }
-        default:
-            LOG(ERROR) << federated_auth_type_str[type] << " is not a valid authentication type.";
-            return nullptr;
+    if (auth_contexts.size() >= MAX_AUTH_CONTEXTS) {
+        // Drops the contexts no cached token generates with anymore, they are created again on their next use
+        std::erase_if(auth_contexts, [](const auto& item) { return item.second.use_count() == 1; });
     }
-    Aws::RDS::RDSClientConfiguration rds_client_cfg;
-    return new Aws::RDS::RDSClient(credentials, rds_client_cfg);
+
+    aws_sdk.Init();
+    std::shared_ptr<AuthContext> context = std::make_shared<AuthContext>(type, config);
+    auth_contexts.emplace(std::move(key), context);
+    return context;
 }
 
-static void ShutdownAwsAPI() {
-    if (0 == --sdk_ref_count) {
-        std::lock_guard<std::mutex> lock(sdk_mutex);
-        Aws::ShutdownAPI(sdk_opts);
+static std::shared_ptr<Aws::SecretsManager::SecretsManagerClient> GetSecretsManagerClient(const std::string& region) {
+    std::lock_guard<std::mutex> lock(sm_clients_mutex);
+    std::shared_ptr<Aws::SecretsManager::SecretsManagerClient>& sm_client = sm_clients[region];
+    if (!sm_client) {
+        aws_sdk.Init();
+        Aws::SecretsManager::SecretsManagerClientConfiguration sm_client_cfg;
+        sm_client_cfg.region = region;
+        sm_client = std::make_shared<Aws::SecretsManager::SecretsManagerClient>(sm_client_cfg);
     }
+    return sm_client;
 }
 
-static void FreeAwsResource(Aws::RDS::RDSClient* client) {
-    delete client;
+static bool FetchSecret(const std::string& secret_id, const std::string& region, SecretsCache::Secret& secret) {
+    SecretsManagerHelper sm_helper(GetSecretsManagerClient(region));
+    if (!sm_helper.FetchCredentials(secret_id)) {
+        return false;
+    }
 
-    // Shut down AWS API
-    ShutdownAwsAPI();
+    secret.username = sm_helper.GetUsername();
+    secret.password = sm_helper.GetPassword();
+    return true;
 }
 
-static void GenKeyAndTime(const char* db_hostname, const char* db_region, const char* port, const char* db_user, std::string& key, uint64_t& curr_time_in_sec) {
-    key = std::string(db_hostname);
+static std::string GenKey(const char* db_hostname, const char* db_region, const char* port, const char* db_user) {
+    std::string key(db_hostname);
     key += "-";
-    key += std::string(db_region);
+    key += db_region;
     key += "-";
-    key += std::string(port);
+    key += port;
     key += "-";
-    key += std::string(db_user);
-
-    // Get the current time point
-    auto curr_time = std::chrono::system_clock::now();
-
-    // Convert the time point to seconds
-    curr_time_in_sec = std::chrono::duration_cast<std::chrono::seconds>(curr_time.time_since_epoch()).count();
+    key += db_user;
+    return key;
 }
 
 static bool UpdateTokenValue(char* token, const unsigned max_size, const char* new_value) {
@@ -178,6 +147,11 @@ static bool UpdateTokenValue(char* token, const unsigned max_size, const char* n
     return true;
 }
 
+static bool UpdateCredentials(Credentials* credentials, const SecretsCache::Secret& secret) {
+    return UpdateTokenValue(credentials->username, credentials->username_size, secret.username.c_str())
+        && UpdateTokenValue(credentials->password, credentials->password_size, secret.password.c_str());
+}
+
 FederatedAuthType GetFedAuthTypeEnum(const char *str) {
     std::string upper_str(str);
     std::transform(upper_str.begin(), upper_str.end(), upper_str.begin(), ::toupper);
@@ -190,49 +164,47 @@ FederatedAuthType GetFedAuthTypeEnum(const char *str) {
 }
 
 bool GetCachedToken(char* token, unsigned int max_size, const char* db_hostname, const char* db_region, const char* port, const char* db_user) {
-    std::string key;
-    uint64_t curr_time_in_sec = 0;
-    GenKeyAndTime(db_hostname, db_region, port, db_user, key, curr_time_in_sec);
-
-    auto itr = cached_tokens.find(key);
-    if (itr == cached_tokens.end() || curr_time_in_sec > itr->second.expiration) {
+    std::string cached;
+    if (!cached_tokens.Get(GenKey(db_hostname, db_region, port, db_user), cached)) {
         LOG(WARNING) << "No cached token";
         return false;
     }
 
-    int token_size = itr->second.token.size();
+    int token_size = cached.size();
     LOG(INFO) << "Token size is " << token_size;
-    return UpdateTokenValue(token, max_size, itr->second.token.c_str());
+    return UpdateTokenValue(token, max_size, cached.c_str());
 }
 
 void UpdateCachedToken(const char* db_hostname, const char* db_region, const char* port, const char* db_user, const char* token, const char* expiration_time) {
-    std::string key;
-    uint64_t curr_time_in_sec = 0;
-    GenKeyAndTime(db_hostname, db_region, port, db_user, key, curr_time_in_sec);
-
-    TokenInfo ti;
-    ti.token = std::string(token);
-    ti.expiration = curr_time_in_sec + StringToNumberConverter::toLong(expiration_time);
-    cached_tokens[key] = ti;
+    std::chrono::seconds ttl(StringToNumberConverter::toLong(expiration_time));
+    cached_tokens.Put(GenKey(db_hostname, db_region, port, db_user), token, ttl);
 }
 
-bool GenerateConnectAuthToken(char* token, unsigned int max_size, const char* db_hostname, const char* db_region, unsigned port, const char* db_user, FederatedAuthType type, FederatedAuthConfig config) {
-    std::lock_guard<std::mutex> global_lock(global_auth_mutex);
-    if (1 == ++sdk_ref_count) {
-        std::lock_guard<std::mutex> lock(sdk_mutex);
-        Aws::InitAPI(sdk_opts);
-    }
+void ConfigureTokenCache(unsigned int max_size, unsigned int refresh_percent) {
+    cached_tokens.Configure(max_size, refresh_percent);
+}
 
-    LOG(INFO) << "Generating token for " << federated_auth_type_str[type];
+void GetTokenCacheStats(TokenCacheStats* stats) {
+    TokenCache::Stats cache_stats = cached_tokens.GetStats();
+    stats->hits = cache_stats.hits;
+    stats->misses = cache_stats.misses;
+    stats->refreshes = cache_stats.refreshes;
+    stats->refresh_failures = cache_stats.refresh_failures;
+    stats->evictions = cache_stats.evictions;
+}
 
-    Aws::RDS::RDSClient* client = CreateRDSClient(type, config);
-    if (!client) {
-        FreeAwsResource(nullptr);
+bool GenerateConnectAuthToken(char* token, unsigned int max_size, const char* db_hostname, const char* db_region, unsigned port, const char* db_user, FederatedAuthType type, FederatedAuthConfig config) {
+    std::shared_ptr<AuthContext> context = GetAuthContext(type, config);
+    std::string new_token;
+    if (!context || !context->GenerateConnectAuthToken(new_token, db_hostname, db_region, port, db_user)) {
         return false;
     }
 
-    Aws::String new_token = client->GenerateConnectAuthToken(db_hostname, db_region, port, db_user);
-    FreeAwsResource(client);
+    // Lets the cache regenerate the token in the background before the one cached by the caller expires
+    cached_tokens.SetGenerator(GenKey(db_hostname, db_region, std::to_string(port).c_str(), db_user),
+        [context, hostname = std::string(db_hostname), region = std::string(db_region), port, user = std::string(db_user)](std::string& refreshed) {
+            return context->GenerateConnectAuthToken(refreshed, hostname, region, port, user);
+        });
 
     int token_size = new_token.size();
     LOG(INFO) << "RDS Client generated token length is " << token_size;
@@ -240,28 +212,40 @@ bool GenerateConnectAuthToken(char* token, unsigned int max_size, const char* db
 }
 
 bool GetCredentialsFromSecretsManager(const char* secret_id, const char* region, Credentials* credentials) {
-    if (1 == ++sdk_ref_count) {
-        std::lock_guard<std::mutex> lock(sdk_mutex);
-        Aws::InitAPI(sdk_opts);
-    }
+    std::string region_str = region;
+    SecretsManagerHelper::ParseRegionFromSecretId(secret_id, region_str);
 
+    SecretsCache::Secret secret;
+    // don't copy any memory if there was a failure fetching the credentials
+    return cached_secrets.Get(secret_id, region_str, secret) && UpdateCredentials(credentials, secret);
+}
+
+bool RefreshCredentialsFromSecretsManager(const char* secret_id, const char* region, Credentials* credentials) {
     std::string region_str = region;
     SecretsManagerHelper::ParseRegionFromSecretId(secret_id, region_str);
 
-    // configure the secrets manager client according to the region determined
-    Aws::SecretsManager::SecretsManagerClientConfiguration sm_client_cfg;
-    sm_client_cfg.region = region_str;
-    std::shared_ptr<Aws::SecretsManager::SecretsManagerClient> sm_client = std::make_shared<Aws::SecretsManager::SecretsManagerClient>(sm_client_cfg);
+    SecretsCache::Secret rejected{ credentials->username, credentials->password };
+    SecretsCache::Secret secret;
+    return cached_secrets.Refresh(secret_id, region_str, rejected, secret) && UpdateCredentials(credentials, secret);
+}
 
-    SecretsManagerHelper sm_helper(sm_client);
-    bool is_success = sm_helper.FetchCredentials(secret_id);
-    ShutdownAwsAPI(); // done using the AWS API
+void ConfigureSecretsManagerCache(unsigned int ttl_seconds) {
+    cached_secrets.SetTtl(std::chrono::seconds(ttl_seconds));
+}
 
-    // don't copy any memory if there was a failure fetching the credentials
-    if (!is_success) {
-        return false;
+void ShutdownAuthentication() {
+    // Background refreshes use the contexts and clients, they are stopped first
+    cached_tokens.Stop();
+    cached_tokens.Clear();
+    cached_secrets.Stop();
+    cached_secrets.Clear();
+    {
+        std::lock_guard<std::mutex> lock(auth_contexts_mutex);
+        auth_contexts.clear();
     }
-
-    return UpdateTokenValue(credentials->username, credentials->username_size, sm_helper.GetUsername().c_str())
-        && UpdateTokenValue(credentials->password, credentials->password_size, sm_helper.GetPassword().c_str());
+    {
+        std::lock_guard<std::mutex> lock(sm_clients_mutex);
+        sm_clients.clear();
+    }
+    aws_sdk.Shutdown();
 }
@@ -58,6 +58,14 @@ typedef struct {
     char ssl_insecure[SMALL_REGISTRY_LEN];
 } FederatedAuthConfig;
 
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long refreshes;
+    unsigned long long refresh_failures;
+    unsigned long long evictions;
+} TokenCacheStats;
+
 typedef struct Credentials {
     char *username;
     char *password;
@@ -99,6 +107,22 @@ bool GetCachedToken(char* token, unsigned int max_size, const char* db_hostname,
  */
 void UpdateCachedToken(const char* db_hostname, const char* db_region, const char* port, const char* db_user, const char* token, const char* expiration_time);
 
+/**
+ * Sets the maximum number of cached tokens, least recently used tokens are evicted past it,
+ * and the percentage of a token's lifetime after which tokens that are in use are regenerated in the background
+ * 
+ * @param max_size the maximum number of cached tokens
+ * @param refresh_percent the percentage of the expiration time after which a token is refreshed, between 1 and 99
+ */
+void ConfigureTokenCache(unsigned int max_size, unsigned int refresh_percent);
+
+/**
+ * Retrieves the hit, miss, background refresh and eviction counters of the token cache
+ * 
+ * @param stats a struct to return the counters in
+ */
+void GetTokenCacheStats(TokenCacheStats* stats);
+
 /**
  * Given the hostname, region, port, and username, generates a new token for the given authentication type
  * Configuration for the authentication will specify which server to federate against
@@ -112,6 +136,7 @@ void UpdateCachedToken(const char* db_hostname, const char* db_region, const cha
  * @param type the enum of the authentication type
  * @param config a struct with 
  * @return True if a cached value was returned in token
+ * Tokens cached with UpdateCachedToken for the same hostname, region, port, and username are then refreshed in the background
  */
 bool GenerateConnectAuthToken(char* token, unsigned int max_size, const char* db_hostname, const char* db_region, unsigned port, const char* db_user, FederatedAuthType type, FederatedAuthConfig config);
 
@@ -123,10 +148,38 @@ bool GenerateConnectAuthToken(char* token, unsigned int max_size, const char* db
  * @param secret_id the full ARN or secret ID of a Secret, given a full
  * @param region the region of the Secret ID
  * @param credentials a struct containing allocated memory space to return the username and password from Secrets Manager
+ * Credentials are cached per secret and region, concurrent calls for a secret that is not cached share a single request
  * @return True if credentials were retrieved and updated
  */
 bool GetCredentialsFromSecretsManager(const char* secret_id, const char* region, Credentials* credentials);
 
+/**
+ * Given a secret ID and region, retrieves the Username and Password again after the database rejected the ones in credentials,
+ * for instance because the secret was rotated
+ * The secret is only fetched again if no other connection already did so
+ * 
+ * @param secret_id the full ARN or secret ID of a Secret
+ * @param region the region of the Secret ID
+ * @param credentials a struct holding the rejected username and password, updated with the ones from Secrets Manager
+ * @return True if credentials were retrieved and updated
+ */
+bool RefreshCredentialsFromSecretsManager(const char* secret_id, const char* region, Credentials* credentials);
+
+/**
+ * Sets how long credentials retrieved from Secrets Manager are cached, credentials in use are retrieved again in the background before then
+ * 
+ * @param ttl_seconds the number of seconds credentials are cached for, 0 disables caching
+ */
+void ConfigureSecretsManagerCache(unsigned int ttl_seconds);
+
+/**
+ * Stops the background refreshes of tokens, credentials and secrets, releases the cached values and AWS clients,
+ * and shuts down the AWS SDK. To be called before the library is unloaded, from outside of DllMain,
+ * and while no other authentication call is in progress. Authentication calls made afterwards initialize the SDK again.
+ * If it is not called, the SDK and the refresh threads are left running until the process exits.
+ */
+void ShutdownAuthentication();
+
 #ifdef __cplusplus
 }
 #endif
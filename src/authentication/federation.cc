@@ -33,6 +33,7 @@ bool FederationCredentialProvider::FetchCredentialsWithSAMLAssertion(
         credentials.SetAWSAccessKeyId(new_cred.GetAccessKeyId());
         credentials.SetAWSSecretKey(new_cred.GetSecretAccessKey());
         credentials.SetSessionToken(new_cred.GetSessionToken());
+        credentials.SetExpiration(new_cred.GetExpiration());
 
         retval = true;
     } else {
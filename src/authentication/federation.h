@@ -26,6 +26,7 @@ public:
         std::shared_ptr<Aws::Http::HttpClient> http_client, std::shared_ptr<Aws::STS::STSClient> sts_client)
         : idp_arn(std::move(idp_arn)), role_arn(std::move(role_arn)),
         http_client(std::move(http_client)), sts_client(std::move(sts_client)) {}
+    virtual ~FederationCredentialProvider() = default;
 
     bool GetAWSCredentials(Aws::Auth::AWSCredentials& credentials);
 
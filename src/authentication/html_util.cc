@@ -1,4 +1,3 @@
-
 // Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 //
 // Licensed under the Apache License, Version 2.0 (the "License");
@@ -17,44 +16,271 @@
 
 #include <glog/logging.h>
 
+#include <array>
+#include <cctype>
+
 #include "../util/logger_wrapper.h"
 
-const std::unordered_map<std::string, char> HtmlUtil::HTML_DECODE_MAP = {
-    {"&#x2b;", '+'},
-    {"&#x3d;", '='},
-    {"&lt;", '<'},
-    {"&gt;", '>'},
-    {"&amp;", '&'},
-    {"&apos;", '\''},
-    {"&quot;", '"'}
-};
-
-std::string HtmlUtil::EscapeHtmlEntity(const std::string& html) {
-    std::string retval;
-    DLOG(INFO) << "Before HTML escape modification: " << html;
-    int i = 0;
-    int length = html.length();
-    while (i < length) {
-        char c = html[i];
-        if (c != '&') {
-            retval.append(1, c);
-            i++;
+namespace {
+    const std::array<std::pair<std::string_view, char>, 5> NAMED_ENTITIES = {{
+        {"lt", '<'},
+        {"gt", '>'},
+        {"amp", '&'},
+        {"apos", '\''},
+        {"quot", '"'}
+    }};
+
+    // Longest entity decoded, from the ampersand to the semicolon
+    constexpr size_t MAX_ENTITY_LENGTH = 8;
+    // Longest lowercase terminator skipped to, the end tag of a style
+    constexpr size_t MAX_TERMINATOR_LENGTH = 8;
+
+    bool is_space(int c) {
+        return c != EOF && std::isspace(static_cast<unsigned char>(c));
+    }
+
+    char to_lower(int c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    bool equals_ignore_case(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (to_lower(a[i]) != to_lower(b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Decodes named entities and numeric entities of ASCII characters, the entity excludes '&' and ';'
+    bool decode_entity(std::string_view entity, char& decoded) {
+        if (entity.size() > 1 && '#' == entity[0]) {
+            bool hex = 'x' == entity[1] || 'X' == entity[1];
+            size_t start = hex ? 2 : 1;
+            if (start == entity.size()) {
+                return false;
+            }
+            int code = 0;
+            for (size_t i = start; i < entity.size(); i++) {
+                char c = to_lower(entity[i]);
+                int digit = -1;
+                if (c >= '0' && c <= '9') {
+                    digit = c - '0';
+                } else if (hex && c >= 'a' && c <= 'f') {
+                    digit = c - 'a' + 10;
+                }
+                if (digit < 0) {
+                    return false;
+                }
+                code = code * (hex ? 16 : 10) + digit;
+            }
+            if (code <= 0 || code > 127) {
+                return false;
+            }
+            decoded = static_cast<char>(code);
+            return true;
+        }
+
+        for (const auto& [name, value] : NAMED_ENTITIES) {
+            if (entity == name) {
+                decoded = value;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+bool HtmlTagReader::Next() {
+    for (int c = next_char(); c != EOF; c = next_char()) {
+        if (c != '<') {
             continue;
         }
 
-        size_t semicolon_idx = html.find(';', i);
-        if (semicolon_idx != std::string::npos) {
-            std::string html_code = html.substr(i, semicolon_idx - i + 1);
-            if (auto itr = HtmlUtil::HTML_DECODE_MAP.find(html_code); itr != HtmlUtil::HTML_DECODE_MAP.end()) {
-                retval.append(1, itr->second);
-                i = semicolon_idx + 1;
+        c = buf->sgetc();
+        if ('!' == c) {
+            buf->sbumpc();
+            if ('-' == buf->sgetc() && '-' == buf->snextc()) {
+                buf->sbumpc();
+                skip_until("-->");
+            } else {
+                skip_until(">");
             }
-        } else {
-            retval.append(1, c);
-            i++;
+            continue;
+        }
+        if ('/' == c || '?' == c) {
+            skip_until(">");
+            continue;
+        }
+        if (EOF == c || !std::isalpha(static_cast<unsigned char>(c))) {
+            // Stray '<' in text
+            continue;
         }
 
+        name.clear();
+        attributes.clear();
+        while ((c = buf->sgetc()) != EOF && !is_space(c) && c != '>' && c != '/') {
+            name.push_back(to_lower(buf->sbumpc()));
+        }
+        read_attributes();
+
+        if ("script" == name || "style" == name) {
+            // Raw text, may contain anything that looks like markup
+            skip_until("</" + name);
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool HtmlTagReader::GetAttribute(std::string_view attribute_name, std::string& value) const {
+    for (const auto& [attr_name, raw_value] : attributes) {
+        if (equals_ignore_case(attr_name, attribute_name)) {
+            value = HtmlUtil::EscapeHtmlEntity(raw_value);
+            return true;
+        }
+    }
+    return false;
+}
+
+int HtmlTagReader::next_char() {
+    return buf->sbumpc();
+}
+
+void HtmlTagReader::skip_until(std::string_view terminator) {
+    // Knuth-Morris-Pratt over the short terminator, each character of the document is looked at once
+    std::array<size_t, MAX_TERMINATOR_LENGTH> fallback = {};
+    for (size_t i = 1, k = 0; i < terminator.size(); i++) {
+        while (k > 0 && terminator[i] != terminator[k]) {
+            k = fallback[k - 1];
+        }
+        if (terminator[i] == terminator[k]) {
+            k++;
+        }
+        fallback[i] = k;
+    }
+
+    size_t matched = 0;
+    for (int c = next_char(); c != EOF; c = next_char()) {
+        char lower = to_lower(c);
+        while (matched > 0 && lower != terminator[matched]) {
+            matched = fallback[matched - 1];
+        }
+        if (lower == terminator[matched] && ++matched == terminator.size()) {
+            return;
+        }
+    }
+}
+
+void HtmlTagReader::skip_whitespace() {
+    while (is_space(buf->sgetc())) {
+        buf->sbumpc();
+    }
+}
+
+void HtmlTagReader::read_attributes() {
+    while (true) {
+        skip_whitespace();
+        int c = buf->sgetc();
+        if (EOF == c) {
+            return;
+        }
+        if ('>' == c) {
+            buf->sbumpc();
+            return;
+        }
+        if ('/' == c) {
+            buf->sbumpc();
+            continue;
+        }
+
+        std::string attr_name;
+        while ((c = buf->sgetc()) != EOF && !is_space(c) && c != '=' && c != '>' && c != '/') {
+            attr_name.push_back(to_lower(buf->sbumpc()));
+        }
+        skip_whitespace();
+
+        std::string value;
+        if ('=' == buf->sgetc()) {
+            buf->sbumpc();
+            skip_whitespace();
+            c = buf->sgetc();
+            if ('"' == c || '\'' == c) {
+                int quote = buf->sbumpc();
+                while ((c = buf->sbumpc()) != EOF && c != quote) {
+                    value.push_back(static_cast<char>(c));
+                }
+            } else {
+                while ((c = buf->sgetc()) != EOF && !is_space(c) && c != '>') {
+                    value.push_back(static_cast<char>(buf->sbumpc()));
+                }
+            }
+        }
+
+        if (!attr_name.empty()) {
+            attributes.emplace_back(std::move(attr_name), std::move(value));
+        }
+    }
+}
+
+std::string HtmlUtil::EscapeHtmlEntity(std::string_view html) {
+    std::string retval;
+    retval.reserve(html.size());
+    size_t i = 0;
+    while (i < html.size()) {
+        size_t ampersand = html.find('&', i);
+        if (ampersand == std::string_view::npos) {
+            retval.append(html.substr(i));
+            break;
+        }
+        retval.append(html.substr(i, ampersand - i));
+
+        size_t semicolon = html.find(';', ampersand);
+        char decoded = 0;
+        if (semicolon != std::string_view::npos && semicolon - ampersand <= MAX_ENTITY_LENGTH &&
+            decode_entity(html.substr(ampersand + 1, semicolon - ampersand - 1), decoded)) {
+            retval.push_back(decoded);
+            i = semicolon + 1;
+        } else {
+            // Not an entity, keep the ampersand as is
+            retval.push_back('&');
+            i = ampersand + 1;
+        }
     }
-    DLOG(INFO) << "After HTML escape modification: " << html;
     return retval;
 }
+
+bool HtmlUtil::ExtractForm(std::istream& html, std::string& action, std::vector<std::pair<std::string, std::string>>& inputs) {
+    HtmlTagReader reader(html);
+    bool found_action = false;
+    while (reader.Next()) {
+        if ("form" == reader.GetName()) {
+            found_action = found_action || (reader.GetAttribute("action", action) && !action.empty());
+            continue;
+        }
+
+        std::string name;
+        if ("input" == reader.GetName() && reader.GetAttribute("name", name) && !name.empty()) {
+            std::string value;
+            reader.GetAttribute("value", value);
+            DLOG(INFO) << "Input Name [" << name << "], Value Size [" << value.size() << "]";
+            inputs.emplace_back(std::move(name), std::move(value));
+        }
+    }
+    return found_action;
+}
+
+bool HtmlUtil::ExtractInputValue(std::istream& html, std::string_view input_name, std::string& value) {
+    HtmlTagReader reader(html);
+    std::string name;
+    while (reader.Next()) {
+        if ("input" == reader.GetName() && reader.GetAttribute("name", name) && name == input_name) {
+            return reader.GetAttribute("value", value) && !value.empty();
+        }
+    }
+    return false;
+}
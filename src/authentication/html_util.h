@@ -15,14 +15,56 @@
 #ifndef HTML_UTIL_H_
 #define HTML_UTIL_H_
 
+#include <istream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
+#include <vector>
 
-class HtmlUtil {
+/**
+ * Single pass reader over the start tags of an HTML document, read straight from a stream.
+ * Only the tag being parsed is buffered, text, comments, end tags and the content of scripts and styles are skipped.
+ * A tag cut off by the end of the document is still returned with the attributes read so far.
+ */
+class HtmlTagReader {
 public:
-    static std::string EscapeHtmlEntity(const std::string& html);
+    explicit HtmlTagReader(std::istream& html) : buf(html.rdbuf()) {}
+
+    // Advances to the next start tag, false once the document is exhausted
+    bool Next();
+
+    // Lowercase name of the current tag
+    const std::string& GetName() const { return name; }
+
+    // Value of an attribute of the current tag with entities decoded, attribute names are case insensitive
+    bool GetAttribute(std::string_view attribute_name, std::string& value) const;
+
 private:
-    static const std::unordered_map<std::string, char> HTML_DECODE_MAP;
+    int next_char();
+    void skip_until(std::string_view terminator);
+    void skip_whitespace();
+    void read_attributes();
+
+    std::streambuf* buf;
+    std::string name;
+    // Lowercase name and raw value
+    std::vector<std::pair<std::string, std::string>> attributes;
+};
+
+class HtmlUtil {
+public:
+    static std::string EscapeHtmlEntity(std::string_view html);
+
+    /**
+     * Reads the action of the first form with one, and the name and value of every named input of the document.
+     * Returns false if no form has an action.
+     */
+    static bool ExtractForm(std::istream& html, std::string& action, std::vector<std::pair<std::string, std::string>>& inputs);
+
+    /**
+     * Reads the value of the first input with the given name, stopping as soon as it is found.
+     */
+    static bool ExtractInputValue(std::istream& html, std::string_view input_name, std::string& value);
 };
 
 #endif // HTML_UTIL_H_
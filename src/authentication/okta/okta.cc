@@ -14,15 +14,11 @@
 
 #include "okta.h"
 
-#include <regex>
-
 #include <glog/logging.h>
 
 #include "../html_util.h"
 #include "../util/logger_wrapper.h"
 
-const std::string OktaCredentialsProvider::SAML_RESPONSE_PATTERN = "<input name=\"SAMLResponse\".+value=\"(.+)\"/\\>";
-
 std::string OktaCredentialsProvider::GetSAMLAssertion(std::string& err_info) {
     // SAML Assertion
     std::string url = get_signin_page_url();
@@ -49,13 +45,9 @@ std::string OktaCredentialsProvider::GetSAMLAssertion(std::string& err_info) {
         return retval;
     }
 
-    std::istreambuf_iterator<char> eos;
-    std::string body(std::istreambuf_iterator<char>(response->GetResponseBody().rdbuf()), eos);
-    DLOG(INFO) << "Signout response body: " << body;
-
-    std::smatch matches;
-    if (std::regex_search(body, matches, std::regex(SAML_RESPONSE_PATTERN))) {
-        return HtmlUtil::EscapeHtmlEntity(matches.str(1));
+    // read straight from the response stream, stopping at the SAMLResponse input
+    if (HtmlUtil::ExtractInputValue(response->GetResponseBody(), "SAMLResponse", retval)) {
+        return retval;
     }
     LOG(WARNING) << "No SAML response found in response";
     return "";
@@ -30,9 +30,6 @@ public:
             config.iam_idp_arn, config.iam_role_arn, std::move(http_client), std::move(sts_client)
         ), cfg(config) {}
 
-    // constant pattern strings 
-    static const std::string SAML_RESPONSE_PATTERN;
-
 protected:
     std::string GetSAMLAssertion(std::string& err_info) override;
 
@@ -0,0 +1,204 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "secrets_cache.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "../util/logger_wrapper.h"
+#include "../util/refresh_scheduler.h"
+
+SecretsCache::SecretsCache(Fetcher fetcher, std::chrono::seconds ttl)
+    : fetcher_{ std::move(fetcher) }, ttl_{ std::max(ttl, std::chrono::seconds(0)) } {}
+
+SecretsCache::~SecretsCache() {
+    Stop();
+}
+
+void SecretsCache::Stop() {
+    uint64_t task_id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_id = std::exchange(refresh_task_id_, 0);
+    }
+    // Outside of the lock, a refresh in progress needs it to finish
+    if (task_id > 0) {
+        RefreshScheduler::Cancel(task_id);
+    }
+}
+
+void SecretsCache::SetTtl(std::chrono::seconds ttl) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttl_ = std::max(ttl, std::chrono::seconds(0));
+}
+
+bool SecretsCache::Get(const std::string& secret_id, const std::string& region, Secret& secret) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::shared_ptr<Entry> entry = get_or_create(secret_id, region);
+    Clock::time_point now = Clock::now();
+    if (entry->valid && now < entry->expiry) {
+        read(*entry, secret);
+        return true;
+    }
+    return fetch(lock, entry, secret);
+}
+
+bool SecretsCache::Refresh(const std::string& secret_id, const std::string& region, const Secret& rejected, Secret& secret) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::shared_ptr<Entry> entry = get_or_create(secret_id, region);
+    if (entry->fetching) {
+        // Started after the rejected secret was read, or about to replace an expired one
+        return wait_for_fetch(lock, entry, secret);
+    }
+
+    Clock::time_point now = Clock::now();
+    if (entry->valid && (entry->secret != rejected || now < entry->refetched_at + REFETCH_INTERVAL)) {
+        // Already rotated, or fetched again so recently that the secret is unlikely to have changed since
+        secret = entry->secret;
+        return true;
+    }
+
+    // Keeps other connections from reading the rejected secret while it is fetched again
+    entry->valid = false;
+    entry->refetched_at = now;
+    return fetch(lock, entry, secret);
+}
+
+void SecretsCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+size_t SecretsCache::Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::shared_ptr<SecretsCache::Entry> SecretsCache::get_or_create(const std::string& secret_id, const std::string& region) {
+    std::string key(secret_id);
+    key.push_back('\0');
+    key.append(region);
+
+    std::shared_ptr<Entry>& entry = entries_[key];
+    if (!entry) {
+        entry = std::make_shared<Entry>();
+        entry->secret_id = secret_id;
+        entry->region = region;
+    }
+    return entry;
+}
+
+bool SecretsCache::fetch(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Entry>& entry, Secret& secret) {
+    if (entry->fetching) {
+        return wait_for_fetch(lock, entry, secret);
+    }
+
+    entry->fetching = true;
+    lock.unlock();
+
+    Secret fetched;
+    bool success = fetcher_(entry->secret_id, entry->region, fetched);
+
+    lock.lock();
+    entry->fetching = false;
+    entry->last_fetch_succeeded = success;
+    entry->fetch_count++;
+    if (success) {
+        issue(*entry, fetched, Clock::now());
+        secret = std::move(fetched);
+    }
+    fetch_cv_.notify_all();
+    return success;
+}
+
+bool SecretsCache::wait_for_fetch(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Entry>& entry, Secret& secret) {
+    uint64_t fetch_count = entry->fetch_count;
+    fetch_cv_.wait(lock, [&entry, fetch_count] { return entry->fetch_count != fetch_count; });
+    if (!entry->last_fetch_succeeded) {
+        // Readers that queued up behind a failed fetch fail with it instead of retrying one after another
+        return false;
+    }
+    read(*entry, secret);
+    return true;
+}
+
+void SecretsCache::issue(Entry& entry, const Secret& secret, Clock::time_point now) {
+    entry.secret = secret;
+    entry.valid = true;
+    entry.expiry = now + ttl_;
+    entry.refresh_at = now + std::chrono::duration_cast<std::chrono::milliseconds>(ttl_) * REFRESH_PERCENT / 100;
+    entry.used = false;
+    if (ttl_.count() > 0 && refresh_task_id_ == 0) {
+        refresh_task_id_ = RefreshScheduler::Schedule([this] { return run_refresh(); }, MAX_REFRESH_DELAY);
+    }
+}
+
+void SecretsCache::read(Entry& entry, Secret& secret) {
+    secret = entry.secret;
+    if (!entry.used) {
+        entry.used = true;
+        // The refresh task skips unused secrets, it may be waiting for another one or for none at all
+        if (refresh_task_id_ > 0) {
+            RefreshScheduler::Wake(refresh_task_id_);
+        }
+    }
+}
+
+std::chrono::milliseconds SecretsCache::run_refresh() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Linear scan, an application only reads a handful of secrets
+        std::shared_ptr<Entry> next;
+        for (const auto& [key, entry] : entries_) {
+            if (entry->valid && entry->used && !entry->fetching && entry->expiry > entry->refresh_at &&
+                (!next || entry->refresh_at < next->refresh_at)) {
+                next = entry;
+            }
+        }
+
+        if (!next) {
+            return MAX_REFRESH_DELAY;
+        }
+        if (Clock::time_point now = Clock::now(); now < next->refresh_at) {
+            return std::min(std::chrono::ceil<std::chrono::milliseconds>(next->refresh_at - now), MAX_REFRESH_DELAY);
+        }
+
+        next->fetching = true;
+        lock.unlock();
+
+        Secret fetched;
+        bool success = fetcher_(next->secret_id, next->region, fetched);
+
+        lock.lock();
+        next->fetching = false;
+        next->last_fetch_succeeded = success;
+        next->fetch_count++;
+        fetch_cv_.notify_all();
+        Clock::time_point now = Clock::now();
+        if (success) {
+            issue(*next, fetched, now);
+            continue;
+        }
+
+        next->refresh_at = now + REFRESH_RETRY_INTERVAL;
+        if (next->refresh_at >= next->expiry) {
+            // Give up, the next connection fetches the secret once the cached one expired
+            next->used = false;
+        }
+        LOG(WARNING) << "Failed to refresh the cached secret, " << (next->used ? "retrying" : "letting it expire");
+    }
+}
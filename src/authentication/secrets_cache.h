@@ -0,0 +1,118 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SECRETS_CACHE_H_
+#define SECRETS_CACHE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Thread safe cache of database credentials read from Secrets Manager, keyed by secret ID and region.
+ * Concurrent reads of a secret that is not cached share a single fetch, so a burst of connections
+ * makes one Secrets Manager call. Secrets that are read are fetched again by a RefreshScheduler task
+ * before their TTL runs out, secrets nobody reads are left to expire.
+ */
+class SecretsCache {
+public:
+    struct Secret {
+        std::string username;
+        std::string password;
+
+        bool operator==(const Secret& other) const = default;
+    };
+
+    typedef std::function<bool(const std::string& secret_id, const std::string& region, Secret& secret)> Fetcher;
+
+    static constexpr std::chrono::seconds DEFAULT_TTL = std::chrono::hours(1);
+    // Percentage of the TTL after which secrets in use are fetched again
+    static constexpr uint32_t REFRESH_PERCENT = 75;
+
+    explicit SecretsCache(Fetcher fetcher, std::chrono::seconds ttl = DEFAULT_TTL);
+    ~SecretsCache();
+
+    /**
+     * Sets the TTL of secrets fetched from now on, a TTL of 0 disables caching.
+     */
+    void SetTtl(std::chrono::seconds ttl);
+
+    /**
+     * Stops background refreshes, waiting for one in progress. The next secret fetched with a TTL starts them again.
+     */
+    void Stop();
+
+    /**
+     * Returns the cached secret, or fetches it if it is not cached or has expired.
+     */
+    bool Get(const std::string& secret_id, const std::string& region, Secret& secret);
+
+    /**
+     * To be called after the database rejected a secret, for instance because it was rotated.
+     * The secret is fetched again unless the cache already holds a different one,
+     * and at most once per REFETCH_INTERVAL while the fetched secret is still the rejected one.
+     */
+    bool Refresh(const std::string& secret_id, const std::string& region, const Secret& rejected, Secret& secret);
+
+    void Clear();
+    size_t Size();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        std::string secret_id;
+        std::string region;
+        Secret secret;
+        bool valid = false;
+        Clock::time_point expiry;
+        Clock::time_point refresh_at;
+        // Last time a rejected secret was fetched again
+        Clock::time_point refetched_at = Clock::time_point::min();
+        // Set by readers, refreshes are skipped for secrets that were not read since they were fetched
+        bool used = false;
+        bool fetching = false;
+        // Outcome of the last fetch, handed to the readers that waited on it
+        bool last_fetch_succeeded = false;
+        uint64_t fetch_count = 0;
+    };
+
+    static constexpr std::chrono::seconds REFRESH_RETRY_INTERVAL = std::chrono::seconds(5);
+    static constexpr std::chrono::seconds REFETCH_INTERVAL = std::chrono::seconds(5);
+    // Readers wake the refresh task, it also looks for due secrets this often in case a wake came while it was finishing
+    static constexpr std::chrono::milliseconds MAX_REFRESH_DELAY = std::chrono::minutes(1);
+
+    std::shared_ptr<Entry> get_or_create(const std::string& secret_id, const std::string& region);
+    bool fetch(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Entry>& entry, Secret& secret);
+    bool wait_for_fetch(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Entry>& entry, Secret& secret);
+    void issue(Entry& entry, const Secret& secret, Clock::time_point now);
+    void read(Entry& entry, Secret& secret);
+    std::chrono::milliseconds run_refresh();
+
+    Fetcher fetcher_;
+    std::chrono::seconds ttl_;
+    // Entries are shared with the readers waiting on their fetch, which outlive a Clear
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+    std::mutex mutex_;
+    std::condition_variable fetch_cv_;
+    // Scheduled once a secret is cached with a TTL, 0 until then
+    uint64_t refresh_task_id_ = 0;
+};
+
+#endif // SECRETS_CACHE_H_
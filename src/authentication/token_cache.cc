@@ -0,0 +1,195 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "token_cache.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "../util/refresh_scheduler.h"
+
+namespace {
+    uint32_t clamp_refresh_percent(uint32_t refresh_percent) {
+        // Refreshing at or past the expiry would leave readers with expired tokens
+        return std::clamp<uint32_t>(refresh_percent, 1, 99);
+    }
+}
+
+TokenCache::TokenCache() : TokenCache(DEFAULT_MAX_SIZE, DEFAULT_REFRESH_PERCENT) {}
+
+TokenCache::TokenCache(size_t max_size, uint32_t refresh_percent)
+    : max_size_{ std::max<size_t>(max_size, 1) }, refresh_percent_{ clamp_refresh_percent(refresh_percent) } {}
+
+TokenCache::~TokenCache() {
+    Stop();
+}
+
+void TokenCache::Stop() {
+    uint64_t task_id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_id = std::exchange(refresh_task_id_, 0);
+    }
+    // Waits for a refresh in progress, which locks the cache once its generator returns
+    if (task_id > 0) {
+        RefreshScheduler::Cancel(task_id);
+    }
+}
+
+void TokenCache::Configure(size_t max_size, uint32_t refresh_percent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_size_ = std::max<size_t>(max_size, 1);
+    refresh_percent_ = clamp_refresh_percent(refresh_percent);
+    evict_over_limit();
+}
+
+bool TokenCache::Get(const std::string& key, std::string& token) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr = entries_.find(key);
+    if (itr == entries_.end() || itr->second.token.empty() || Clock::now() > itr->second.expiry) {
+        misses_++;
+        return false;
+    }
+
+    Entry& entry = itr->second;
+    touch(entry);
+    token = entry.token;
+    if (!entry.used) {
+        entry.used = true;
+        if (entry.generator && refresh_task_id_ > 0) {
+            // The entry may already be due for a refresh
+            RefreshScheduler::Wake(refresh_task_id_);
+        }
+    }
+    hits_++;
+    return true;
+}
+
+void TokenCache::Put(const std::string& key, const std::string& token, std::chrono::seconds ttl) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = get_or_create(key);
+    issue(entry, token, ttl, Clock::now());
+    evict_over_limit();
+}
+
+void TokenCache::SetGenerator(const std::string& key, Generator generator) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    get_or_create(key).generator = std::move(generator);
+    evict_over_limit();
+    if (refresh_task_id_ == 0) {
+        refresh_task_id_ = RefreshScheduler::Schedule([this] { return run_refresh(); }, MAX_REFRESH_DELAY);
+    }
+}
+
+void TokenCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+}
+
+size_t TokenCache::Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+TokenCache::Stats TokenCache::GetStats() const {
+    return Stats{ hits_.load(), misses_.load(), refreshes_.load(), refresh_failures_.load(), evictions_.load() };
+}
+
+TokenCache::Entry& TokenCache::get_or_create(const std::string& key) {
+    auto [itr, inserted] = entries_.try_emplace(key);
+    if (inserted) {
+        lru_.push_front(key);
+        itr->second.lru_itr = lru_.begin();
+    } else {
+        touch(itr->second);
+    }
+    return itr->second;
+}
+
+void TokenCache::touch(Entry& entry) {
+    lru_.splice(lru_.begin(), lru_, entry.lru_itr);
+}
+
+void TokenCache::evict_over_limit() {
+    while (entries_.size() > max_size_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+        evictions_++;
+    }
+}
+
+void TokenCache::issue(Entry& entry, const std::string& token, std::chrono::seconds ttl, Clock::time_point now) {
+    entry.token = token;
+    entry.ttl = ttl;
+    entry.expiry = now + ttl;
+    entry.refresh_at = now + std::chrono::duration_cast<std::chrono::milliseconds>(ttl) * refresh_percent_ / 100;
+    entry.used = false;
+}
+
+std::chrono::milliseconds TokenCache::run_refresh() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Linear scan, refreshes are rare compared to the size bound of the cache
+        auto next = entries_.end();
+        for (auto itr = entries_.begin(); itr != entries_.end(); ++itr) {
+            const Entry& entry = itr->second;
+            if (entry.generator && entry.used && !entry.refreshing && !entry.token.empty() &&
+                (next == entries_.end() || entry.refresh_at < next->second.refresh_at)) {
+                next = itr;
+            }
+        }
+
+        if (next == entries_.end()) {
+            return MAX_REFRESH_DELAY;
+        }
+        if (Clock::time_point now = Clock::now(); now < next->second.refresh_at) {
+            return std::min(std::chrono::ceil<std::chrono::milliseconds>(next->second.refresh_at - now), MAX_REFRESH_DELAY);
+        }
+
+        std::string key = next->first;
+        Generator generator = next->second.generator;
+        next->second.refreshing = true;
+        lock.unlock();
+
+        std::string token;
+        bool success = generator(token) && !token.empty();
+
+        lock.lock();
+        auto itr = entries_.find(key);
+        if (itr == entries_.end()) {
+            // Evicted or cleared while refreshing
+            continue;
+        }
+
+        Entry& entry = itr->second;
+        entry.refreshing = false;
+        Clock::time_point now = Clock::now();
+        if (success) {
+            issue(entry, token, entry.ttl, now);
+            refreshes_++;
+            continue;
+        }
+
+        refresh_failures_++;
+        entry.refresh_at = now + REFRESH_RETRY_INTERVAL;
+        if (entry.refresh_at >= entry.expiry) {
+            // Give up, the next connection generates a token once this one expired
+            entry.used = false;
+        }
+        LOG(WARNING) << "Failed to refresh the cached token, " << (entry.used ? "retrying" : "letting it expire");
+    }
+}
@@ -0,0 +1,118 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOKEN_CACHE_H_
+#define TOKEN_CACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Thread safe, size bounded cache of authentication tokens with LRU eviction.
+ * Entries that have a generator are refreshed by a RefreshScheduler task once a fraction of their TTL has elapsed,
+ * as long as they were read since they were last issued. Entries nobody reads are left to expire.
+ */
+class TokenCache {
+public:
+    typedef std::function<bool(std::string& token)> Generator;
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t refreshes;
+        uint64_t refresh_failures;
+        uint64_t evictions;
+    };
+
+    static const size_t DEFAULT_MAX_SIZE = 1000;
+    static const uint32_t DEFAULT_REFRESH_PERCENT = 75;
+
+    TokenCache();
+    TokenCache(size_t max_size, uint32_t refresh_percent);
+    ~TokenCache();
+
+    /**
+     * Updates the size bound and the percentage of the TTL after which tokens are refreshed.
+     * Entries over the new bound are evicted right away, refresh times of cached entries are kept.
+     */
+    void Configure(size_t max_size, uint32_t refresh_percent);
+
+    /**
+     * Stops background refreshes, waiting for one in progress. The next SetGenerator starts them again.
+     */
+    void Stop();
+
+    /**
+     * Returns true and sets token if the key holds a token that has not expired.
+     */
+    bool Get(const std::string& key, std::string& token);
+    void Put(const std::string& key, const std::string& token, std::chrono::seconds ttl);
+
+    /**
+     * Registers how to generate a new token for the key, scheduling the refresh task if needed.
+     * A placeholder entry is created if the key has no token yet, it is filled by the following Put.
+     */
+    void SetGenerator(const std::string& key, Generator generator);
+    void Clear();
+    size_t Size();
+    Stats GetStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        std::string token;
+        std::chrono::seconds ttl{ 0 };
+        Clock::time_point expiry;
+        Clock::time_point refresh_at;
+        Generator generator;
+        // Set by readers, refreshes are skipped for tokens that were not read since they were issued
+        bool used = false;
+        bool refreshing = false;
+        std::list<std::string>::iterator lru_itr;
+    };
+
+    static constexpr std::chrono::seconds REFRESH_RETRY_INTERVAL = std::chrono::seconds(5);
+    // Bounds the wait of the refresh task when no token is due, in case the wake of a first read came while it was finishing
+    static constexpr std::chrono::milliseconds MAX_REFRESH_DELAY = std::chrono::minutes(1);
+
+    Entry& get_or_create(const std::string& key);
+    void touch(Entry& entry);
+    void evict_over_limit();
+    void issue(Entry& entry, const std::string& token, std::chrono::seconds ttl, Clock::time_point now);
+    std::chrono::milliseconds run_refresh();
+
+    std::unordered_map<std::string, Entry> entries_;
+    // Most recently used key first
+    std::list<std::string> lru_;
+    size_t max_size_;
+    uint32_t refresh_percent_;
+    std::mutex mutex_;
+    // Scheduled by the first generator, 0 until then
+    uint64_t refresh_task_id_ = 0;
+
+    std::atomic<uint64_t> hits_{ 0 };
+    std::atomic<uint64_t> misses_{ 0 };
+    std::atomic<uint64_t> refreshes_{ 0 };
+    std::atomic<uint64_t> refresh_failures_{ 0 };
+    std::atomic<uint64_t> evictions_{ 0 };
+};
+
+#endif // TOKEN_CACHE_H_
@@ -21,6 +21,8 @@
 #include "../util/cluster_topology_helper.h"
 #include "../util/connection_string_helper.h"
 #include "../util/connection_string_keys.h"
+#include "../util/refresh_scheduler.h"
+#include "node_probe_executor.h"
 #include "string_helper.h"
 
 ClusterTopologyMonitor::ClusterTopologyMonitor(
@@ -46,25 +48,25 @@ ClusterTopologyMonitor::ClusterTopologyMonitor(
         throw std::runtime_error(std::string("Cluster Topology Monitor unable to allocate HENV for ClusterId: ") + cluster_id);
     }
     conn_str_ = StringHelper::ToSQLSTR(conn_cstr);
+    conn_template_ = ConnectionStringTemplate(conn_str_, { { ENABLE_FAILOVER_KEY, BOOL_FALSE } }, false);
+
+    // Start from any topology already cached for this cluster
+    if (topology_map_) {
+        topology_snapshot_.Store(std::make_shared<const TopologySnapshot>(0, topology_map_->Get(cluster_id_)));
+    }
 }
 
 ClusterTopologyMonitor::~ClusterTopologyMonitor() {
     is_running_.store(false);
     node_threads_stop_.store(true);
 
-    // Notify node threads if they are stuck waiting
-    {
-        std::lock_guard lock(request_update_topology_mutex_);
-        request_update_topology_.store(true);
-    }
-    request_update_topology_cv_.notify_all();
-    node_monitoring_threads_.clear();
-
-    // Close main monitor
-    if (monitoring_thread_ && monitoring_thread_->joinable()) {
-        monitoring_thread_->join();
+    // Drops the main refresh right away if it is waiting for its next run, or waits for the refresh in progress
+    uint64_t refresh_task_id = refresh_task_id_.exchange(0);
+    if (refresh_task_id != 0) {
+        RefreshScheduler::Cancel(refresh_task_id);
+        LOG(INFO) << "Stop cluster topology monitoring for " << StringHelper::ToString(this->conn_str_);
     }
-    monitoring_thread_ = nullptr;
+    node_monitoring_tasks_.clear();
 
     // Cleanup Handles
     std::lock_guard hdbc_lock(hdbc_mutex_);
@@ -83,9 +85,9 @@ std::vector<HostInfo> ClusterTopologyMonitor::ForceRefresh(const bool verify_wri
     std::chrono::steady_clock::time_point ignore_topology = ignore_topology_request_end_ms_.load();
     if (ignore_topology != epoch && now > ignore_topology) {
         // Previous failover has just completed. We can use results of it without triggering a new topology update.
-        std::vector<HostInfo> hosts = topology_map_->Get(cluster_id_);
-        if (!hosts.empty()) {
-            return hosts;
+        std::shared_ptr<const TopologySnapshot> snapshot = topology_snapshot_.Load();
+        if (!snapshot->hosts.empty()) {
+            return snapshot->hosts;
         }
     }
 
@@ -112,73 +114,91 @@ std::vector<HostInfo> ClusterTopologyMonitor::ForceRefresh(SQLHDBC hdbc, const u
     return FetchTopologyUpdateCache(hdbc);
 }
 
+std::shared_ptr<const TopologySnapshot> ClusterTopologyMonitor::GetTopologySnapshot() {
+    return topology_snapshot_.Load();
+}
+
+uint64_t ClusterTopologyMonitor::Subscribe(const TopologyListener& listener) {
+    std::lock_guard lock(listeners_mutex_);
+    uint64_t subscription_id = next_subscription_id_++;
+    listeners_[subscription_id] = listener;
+    return subscription_id;
+}
+
+void ClusterTopologyMonitor::Unsubscribe(uint64_t subscription_id) {
+    std::lock_guard lock(listeners_mutex_);
+    listeners_.erase(subscription_id);
+}
+
 void ClusterTopologyMonitor::StartMonitor() {
     if (!is_running_.load()) {
         is_running_.store(true);
-        this->monitoring_thread_ = std::make_shared<std::thread>(&ClusterTopologyMonitor::Run, this);
+        LOG(INFO) << "Start cluster topology monitoring for " << StringHelper::ToString(this->conn_str_);
+        refresh_task_id_.store(RefreshScheduler::Schedule([this] { return Run(); }, std::chrono::milliseconds(0)));
     }
 }
 
-void ClusterTopologyMonitor::Run() {
-    std::string c = StringHelper::ToString(this->conn_str_);
+std::chrono::milliseconds ClusterTopologyMonitor::Run() {
+    if (!is_running_.load()) {
+        return RefreshScheduler::STOP;
+    }
 
     try {
-        LOG(INFO) << "Start cluster topology monitoring thread for " << c;
-        while (is_running_.load()) {
-            bool should_handle_topology_timing = true;
-            // Panic if main monitor is not connected to the writer instance
-            if (in_panic_mode()) {
-                should_handle_topology_timing = handle_panic_mode();
-            } else {
-                should_handle_topology_timing = handle_regular_mode();
-            }
-            if (should_handle_topology_timing) {
-                handle_ignore_topology_timing();
-            }
+        bool should_handle_topology_timing = true;
+        std::chrono::milliseconds delay(0);
+        // Panic if main monitor is not connected to the writer instance
+        if (in_panic_mode()) {
+            should_handle_topology_timing = handle_panic_mode(delay);
+        } else {
+            should_handle_topology_timing = handle_regular_mode(delay);
         }
-        LOG(INFO) << "Stop cluster topology monitoring thread for " << c;
+        if (should_handle_topology_timing) {
+            handle_ignore_topology_timing();
+        }
+        return delay;
     } catch (const std::exception& ex) {
         LOG(ERROR) << "Cluster Topology Main Monitor encountered error: " << ex.what();
     }
+    return RefreshScheduler::STOP;
 }
 
 std::vector<HostInfo> ClusterTopologyMonitor::WaitForTopologyUpdate(uint32_t timeout_ms) {
-    std::vector<HostInfo> curr_hosts = topology_map_->Get(cluster_id_);
-    std::vector<HostInfo> new_hosts = curr_hosts;
+    uint64_t start_generation;
+    bool already_requested;
     {
         std::lock_guard<std::mutex> lock(request_update_topology_mutex_);
-        request_update_topology_.store(true);
+        start_generation = topology_snapshot_.Load()->generation;
+        already_requested = request_update_topology_.exchange(true);
+    }
+    // A request still pending already woke the main refresh, which keeps to the high refresh rate until it is served
+    if (!already_requested) {
+        RefreshScheduler::Wake(refresh_task_id_.load());
     }
-    request_update_topology_cv_.notify_all();
 
     if (timeout_ms == 0) {
         LOG(INFO) << "A topology refresh was requested, but the given timeout for the request was 0ms. Returning cached hosts.";
-        return curr_hosts;
+        return topology_snapshot_.Load()->hosts;
     }
-    std::chrono::steady_clock::time_point curr_time =
-        std::chrono::steady_clock::time_point(std::chrono::high_resolution_clock::now().time_since_epoch());
-    std::chrono::steady_clock::time_point end = curr_time + std::chrono::milliseconds(timeout_ms);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
 
-    std::unique_lock<std::mutex> topology_lock(topology_updated_mutex_);
-    // TODO(karezche): refactor the code to compare references instead of values
-    // Current implementation does not support comparing curr_hosts and new_hosts by their references.
-    while (curr_time < end && curr_hosts == new_hosts) {
-        LOG(INFO) << "Host reference comparison has failed, curr_hosts: " << ClusterTopologyHelper::LogTopology(curr_hosts)
-                  << " new hosts: " << ClusterTopologyHelper::LogTopology(new_hosts);
-        topology_updated_.wait_for(topology_lock, std::chrono::milliseconds(TOPOLOGY_UPDATE_WAIT_MS));
-        new_hosts = topology_map_->Get(cluster_id_);
-        curr_time = std::chrono::steady_clock::time_point(std::chrono::high_resolution_clock::now().time_since_epoch());
+    bool updated;
+    {
+        std::unique_lock<std::mutex> topology_lock(topology_updated_mutex_);
+        updated = topology_updated_.wait_until(topology_lock, end, [this, start_generation] {
+            return topology_snapshot_.Load()->generation != start_generation;
+        });
     }
-    LOG(INFO) << "new hosts have been updated";
 
-    if (curr_time >= end) {
+    if (updated) {
+        LOG(INFO) << "new hosts have been updated";
+    } else {
         LOG(ERROR) << "Cluster Monitor topology did not update within the maximum time: " << std::to_string(timeout_ms) << "for cluster ID: " << cluster_id_;
     }
 
-    return new_hosts;
+    return topology_snapshot_.Load()->hosts;
 }
 
-void ClusterTopologyMonitor::DelayMainThread(bool use_high_refresh_rate) {
+std::chrono::milliseconds ClusterTopologyMonitor::GetRefreshDelay(bool use_high_refresh_rate) {
     std::chrono::steady_clock::time_point curr_time =
         std::chrono::steady_clock::time_point(std::chrono::high_resolution_clock::now().time_since_epoch());
     if ((high_refresh_end_time_ != std::chrono::steady_clock::time_point() &&
@@ -186,16 +206,11 @@ void ClusterTopologyMonitor::DelayMainThread(bool use_high_refresh_rate) {
         use_high_refresh_rate = true;
     }
 
-    std::chrono::steady_clock::time_point end = curr_time + (use_high_refresh_rate ?
+    // The scheduler runs the next refresh sooner if a new refresh is requested or a node probe publishes a new topology,
+    // and drops it if the monitor is stopped
+    return use_high_refresh_rate ?
         std::chrono::milliseconds(high_refresh_rate_ms_) :
-        std::chrono::milliseconds(refresh_rate_ms_));
-    std::unique_lock<std::mutex> request_lock(request_update_topology_mutex_);
-    do {
-        request_update_topology_cv_.wait_for(request_lock, std::chrono::milliseconds(TOPOLOGY_REQUEST_WAIT_MS));
-        curr_time = std::chrono::steady_clock::time_point(std::chrono::high_resolution_clock::now().time_since_epoch());
-    } while (!request_update_topology_.load() &&
-        curr_time < end && !is_running_.load()
-    );
+        std::chrono::milliseconds(refresh_rate_ms_);
 }
 
 std::vector<HostInfo> ClusterTopologyMonitor::FetchTopologyUpdateCache(const SQLHDBC hdbc) {
@@ -216,29 +231,44 @@ std::vector<HostInfo> ClusterTopologyMonitor::FetchTopologyUpdateCache(const SQL
 }
 
 void ClusterTopologyMonitor::UpdateTopologyCache(const std::vector<HostInfo>& hosts) {
-    std::unique_lock<std::mutex> request_lock(request_update_topology_mutex_);
-    std::unique_lock<std::mutex> update_lock(topology_updated_mutex_);
-
-    // Update topology and notify threads
-    topology_map_->Put(cluster_id_, hosts);
-    request_update_topology_.store(false);
-    topology_updated_.notify_all();
-    request_update_topology_cv_.notify_one();
-}
+    std::shared_ptr<const TopologySnapshot> previous;
+    std::shared_ptr<const TopologySnapshot> current;
+    {
+        std::unique_lock<std::mutex> request_lock(request_update_topology_mutex_);
+        std::unique_lock<std::mutex> update_lock(topology_updated_mutex_);
 
-SQLSTR ClusterTopologyMonitor::ConnForHost(const std::string& new_host) {
-    SQLSTR new_host_str = StringHelper::ToSQLSTR(new_host);
-    std::map<SQLSTR, SQLSTR> conn_map;
-    ConnectionStringHelper::ParseConnectionString(conn_str_, conn_map);
+        // Publish a new snapshot, update the shared cache and notify threads
+        previous = topology_snapshot_.Load();
+        current = std::make_shared<const TopologySnapshot>(previous->generation + 1, hosts);
+        topology_snapshot_.Store(current);
+        topology_map_->Put(cluster_id_, hosts);
+        request_update_topology_.store(false);
+        topology_updated_.notify_all();
+    }
+    // Published by a node probe or a caller's connection, the main refresh picks the new topology up right away.
+    // Has no effect when published by the main refresh itself, which is running
+    RefreshScheduler::Wake(refresh_task_id_.load());
 
-    if (conn_map.contains(SERVER_HOST_KEY)) {
-        conn_map[SERVER_HOST_KEY] = new_host_str;
+    // Notify listeners outside of the topology locks, so they may read the topology themselves.
+    // Listeners only hand the events off, subscriber work never runs on probe or refresh workers
+    std::vector<TopologyEvent> events = TopologyEvent::Diff(previous->hosts, current->hosts);
+    if (events.empty()) {
+        return;
+    }
+    std::vector<TopologyListener> listeners;
+    {
+        std::lock_guard lock(listeners_mutex_);
+        for (const auto& [subscription_id, listener] : listeners_) {
+            listeners.push_back(listener);
+        }
     }
-    if (conn_map.contains(ENABLE_FAILOVER_KEY)) {
-        conn_map[ENABLE_FAILOVER_KEY] = BOOL_FALSE;
+    for (const TopologyListener& listener : listeners) {
+        listener(current, events);
     }
+}
 
-    return ConnectionStringHelper::BuildConnectionString(conn_map);
+SQLSTR ClusterTopologyMonitor::ConnForHost(const std::string& new_host) {
+    return conn_template_.ForHost(StringHelper::ToSQLSTR(new_host));
 }
 
 bool ClusterTopologyMonitor::in_panic_mode() {
@@ -311,30 +341,31 @@ void ClusterTopologyMonitor::dbc_clean_up(std::shared_ptr<SQLHDBC>& dbc) {
     }
 }
 
-bool ClusterTopologyMonitor::handle_panic_mode() {
+bool ClusterTopologyMonitor::handle_panic_mode(std::chrono::milliseconds& delay) {
     bool should_handle_topology_timing = true;
-    if (node_monitoring_threads_.empty()) {
+    if (node_monitoring_tasks_.empty()) {
         init_node_monitors();
     } else {
         should_handle_topology_timing = get_possible_writer_conn();
     }
-    DelayMainThread(true);
+    delay = GetRefreshDelay(true);
     return should_handle_topology_timing;
 }
 
-bool ClusterTopologyMonitor::handle_regular_mode() {
-    node_monitoring_threads_.clear();
+bool ClusterTopologyMonitor::handle_regular_mode(std::chrono::milliseconds& delay) {
+    node_monitoring_tasks_.clear();
     std::vector<HostInfo> hosts;
     {
         std::lock_guard hdbc_lock(hdbc_mutex_);
         hosts = FetchTopologyUpdateCache(reinterpret_cast<SQLHDBC>(main_hdbc_ ? *main_hdbc_.get() : SQL_NULL_HDBC));
     }
 
-    // No hosts, switch to panic
+    // No hosts, switch to panic right away
     if (hosts.empty()) {
         std::lock_guard hdbc_lock(hdbc_mutex_);
         dbc_clean_up(main_hdbc_);
         is_writer_connection_.store(false);
+        delay = std::chrono::milliseconds(0);
         return false;
     }
 
@@ -348,7 +379,7 @@ bool ClusterTopologyMonitor::handle_regular_mode() {
     if (high_refresh_end_time_ == epoch) {
         ClusterTopologyHelper::LogTopology(hosts);
     }
-    DelayMainThread(false);
+    delay = GetRefreshDelay(false);
     return true;
 }
 
@@ -375,18 +406,21 @@ void ClusterTopologyMonitor::init_node_monitors() {
     node_threads_writer_host_info_ = nullptr;
     node_threads_latest_topology_ = nullptr;
 
-    std::vector<HostInfo> hosts = topology_map_->Get(cluster_id_);
+    std::vector<HostInfo> hosts = topology_snapshot_.Load()->hosts;
     if (hosts.empty()) {
         hosts = open_any_conn_get_hosts();
     }
 
     if (!hosts.empty() && !is_writer_connection_.load()) {
-        auto end = node_monitoring_threads_.end();
+        auto end = node_monitoring_tasks_.end();
         for (const HostInfo& hi : hosts) {
             std::string host_id = hi.GetHost();
-            if (node_monitoring_threads_.find(host_id) == end) {
-                node_monitoring_threads_[host_id] =
-                    std::make_shared<NodeMonitoringThread>(this, std::make_shared<HostInfo>(hi), main_writer_host_info_);
+            if (node_monitoring_tasks_.find(host_id) == end) {
+                auto task = std::make_shared<NodeMonitoringTask>(this, std::make_shared<HostInfo>(hi), main_writer_host_info_);
+                // Hosts that could not be admitted are retried on the next panic iteration
+                if (task->Start()) {
+                    node_monitoring_tasks_[host_id] = task;
+                }
             }
         }
     }
@@ -418,7 +452,7 @@ bool ClusterTopologyMonitor::get_possible_writer_conn() {
         ignore_topology_request_end_ms_.compare_exchange_strong(expected, new_time);
 
         node_threads_stop_.store(true);
-        node_monitoring_threads_.clear();
+        node_monitoring_tasks_.clear();
         return false;
     }
     std::vector<HostInfo> local_topology;
@@ -426,31 +460,46 @@ bool ClusterTopologyMonitor::get_possible_writer_conn() {
         std::lock_guard<std::mutex> topology_lock(node_threads_latest_topology_mutex_);
         local_topology = node_threads_latest_topology_ ? *node_threads_latest_topology_ : std::vector<HostInfo>();
     }
-    auto end = node_monitoring_threads_.end();
+    auto end = node_monitoring_tasks_.end();
     for (const HostInfo& hi : local_topology) {
         std::string host_id = hi.GetHost();
-        if (node_monitoring_threads_.find(host_id) == end) {
-            node_monitoring_threads_[host_id] =
-                std::make_shared<NodeMonitoringThread>(this, std::make_shared<HostInfo>(hi), main_writer_host_info_);
+        if (node_monitoring_tasks_.find(host_id) == end) {
+            auto task = std::make_shared<NodeMonitoringTask>(this, std::make_shared<HostInfo>(hi), main_writer_host_info_);
+            if (task->Start()) {
+                node_monitoring_tasks_[host_id] = task;
+            }
         }
     }
     return true;
 }
 
-ClusterTopologyMonitor::NodeMonitoringThread::NodeMonitoringThread(ClusterTopologyMonitor* monitor, const std::shared_ptr<HostInfo>& host_info, const std::shared_ptr<HostInfo>& writer_host_info) {
+ClusterTopologyMonitor::NodeMonitoringTask::NodeMonitoringTask(ClusterTopologyMonitor* monitor, const std::shared_ptr<HostInfo>& host_info, const std::shared_ptr<HostInfo>& writer_host_info) {
     this->main_monitor_ = monitor;
     this->host_info_ = host_info;
     this->writer_host_info_ = writer_host_info;
-    node_thread_ = std::make_shared<std::thread>(&NodeMonitoringThread::run, this);
 }
 
-ClusterTopologyMonitor::NodeMonitoringThread::~NodeMonitoringThread() {
-    if (node_thread_) {
-        if (node_thread_->joinable()) {
-            node_thread_->join();
-        }
+ClusterTopologyMonitor::NodeMonitoringTask::~NodeMonitoringTask() {
+    stop_.store(true);
+    uint64_t requeue_task_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(task_pending_mutex_);
+        requeue_task_id = requeue_task_id_;
+        requeue_task_id_ = 0;
+    }
+    if (requeue_task_id > 0 && NodeProbeExecutor::Cancel(requeue_task_id)) {
+        // Waiting for its next probe, which will not be queued anymore
+        finish();
+    }
+
+    // Wait for any queued or running probe to observe the stop and release this task
+    {
+        std::unique_lock<std::mutex> lock(task_pending_mutex_);
+        task_pending_cv_.wait(lock, [this] { return !task_pending_; });
+    }
+    if (admitted_) {
+        NodeProbeExecutor::Release();
     }
-    node_thread_ = nullptr;
 
     // Main thread will clean up if this Node was used as a reader connection
     if (!reader_update_topology_ && hdbc_) {
@@ -458,43 +507,77 @@ ClusterTopologyMonitor::NodeMonitoringThread::~NodeMonitoringThread() {
     }
 }
 
-void ClusterTopologyMonitor::NodeMonitoringThread::run() {
+bool ClusterTopologyMonitor::NodeMonitoringTask::Start() {
+    if (!NodeProbeExecutor::TryAcquire()) {
+        return false;
+    }
+    admitted_ = true;
+    conn_str_ = main_monitor_->ConnForHost(host_info_->GetHost());
+
+    std::lock_guard<std::mutex> lock(task_pending_mutex_);
+    task_pending_ = NodeProbeExecutor::Submit([this] { run(); });
+    return task_pending_;
+}
+
+void ClusterTopologyMonitor::NodeMonitoringTask::run() {
     std::string thread_host = host_info_->GetHost();
-    auto updated_conn_str = main_monitor_->ConnForHost(thread_host);
-    SQLTCHAR* conn_cstr = AS_SQLTCHAR(updated_conn_str.c_str());
+    bool should_stop = stop_.load() || main_monitor_->node_threads_stop_.load();
+
+    if (!should_stop) {
+        try {
+            probe();
+        } catch (const std::exception& ex) {
+            LOG(ERROR) << "Exception while node monitoring for: " << thread_host << ex.what();
+            should_stop = true;
+        }
+    }
 
-    try {
-        bool should_stop = main_monitor_->node_threads_stop_.load();
-        while (!should_stop) {
-            if (!main_monitor_->odbc_helper_->CheckConnection(hdbc_)) {
-                if (hdbc_ != SQL_NULL_HDBC) {
-                    // Not an initial connection.
-                    LOG(WARNING) << "Failover Monitor for: " << thread_host << " not connected. Trying to reconnect.";
-                }
-                handle_reconnect(conn_cstr);
-            } else {
-                // Get Writer ID
-                std::string writer_id = main_monitor_->query_helper_->GetWriterId(hdbc_);
-                if (!writer_id.empty()) {  // Connected to a Writer
-                    LOG(WARNING) << "Writer " << writer_id << " detected by node monitoring thread: " << thread_host;
-                    handle_writer_conn();
-                } else { // Connected to a Reader
-                    handle_reader_conn();
-                }
+    should_stop = should_stop || main_monitor_->node_threads_stop_.load();
+    if (!should_stop) {
+        // Wait out the interval on the executor's timer, so the probe worker moves on to other nodes
+        std::lock_guard<std::mutex> lock(task_pending_mutex_);
+        // Checked under the lock, a destructor that stopped this task earlier would not cancel the next probe
+        if (!stop_.load()) {
+            requeue_task_id_ = NodeProbeExecutor::SubmitAfter([this] { run(); }, std::chrono::milliseconds(THREAD_SLEEP_MS_));
+            if (requeue_task_id_ > 0) {
+                return;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(THREAD_SLEEP_MS_));
-            should_stop = main_monitor_->node_threads_stop_.load();
         }
-    } catch (const std::exception& ex) {
-        LOG(ERROR) << "Exception while node monitoring for: " << thread_host << ex.what();
     }
+    finish();
+}
 
+void ClusterTopologyMonitor::NodeMonitoringTask::finish() {
     // Close any open connections / handles
     main_monitor_->odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc_, SQL_NULL_HANDLE);
     hdbc_ = SQL_NULL_HDBC;
+
+    // Notify while holding the lock, the destructor may free this task as soon as it observes the flag
+    std::lock_guard<std::mutex> lock(task_pending_mutex_);
+    task_pending_ = false;
+    task_pending_cv_.notify_all();
+}
+
+void ClusterTopologyMonitor::NodeMonitoringTask::probe() {
+    if (!main_monitor_->odbc_helper_->CheckConnection(hdbc_)) {
+        if (hdbc_ != SQL_NULL_HDBC) {
+            // Not an initial connection.
+            LOG(WARNING) << "Failover Monitor for: " << host_info_->GetHost() << " not connected. Trying to reconnect.";
+        }
+        handle_reconnect(AS_SQLTCHAR(conn_str_.c_str()));
+    } else {
+        // Get Writer ID
+        std::string writer_id = main_monitor_->query_helper_->GetWriterId(hdbc_);
+        if (!writer_id.empty()) {  // Connected to a Writer
+            LOG(WARNING) << "Writer " << writer_id << " detected by node monitoring task: " << host_info_->GetHost();
+            handle_writer_conn();
+        } else { // Connected to a Reader
+            handle_reader_conn();
+        }
+    }
 }
 
-void ClusterTopologyMonitor::NodeMonitoringThread::handle_reconnect(SQLTCHAR* conn_cstr) {
+void ClusterTopologyMonitor::NodeMonitoringTask::handle_reconnect(SQLTCHAR* conn_cstr) {
     if (hdbc_ != SQL_NULL_HDBC) {
         // Disconnect if hdbc is not null
         main_monitor_->odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc_, SQL_NULL_HANDLE);
@@ -506,7 +589,7 @@ void ClusterTopologyMonitor::NodeMonitoringThread::handle_reconnect(SQLTCHAR* co
         nullptr, 0, nullptr, SQL_DRIVER_NOPROMPT);
 }
 
-void ClusterTopologyMonitor::NodeMonitoringThread::handle_writer_conn() {
+void ClusterTopologyMonitor::NodeMonitoringTask::handle_writer_conn() {
     std::lock_guard<std::mutex> hdbc_lock(main_monitor_->node_threads_writer_hdbc_mutex_);
     if (main_monitor_->node_threads_writer_hdbc_ != nullptr) {
         // Writer connection already set
@@ -529,7 +612,7 @@ void ClusterTopologyMonitor::NodeMonitoringThread::handle_writer_conn() {
     main_monitor_->node_threads_stop_.store(true);
 }
 
-void ClusterTopologyMonitor::NodeMonitoringThread::handle_reader_conn() {
+void ClusterTopologyMonitor::NodeMonitoringTask::handle_reader_conn() {
     if (main_monitor_->node_threads_writer_hdbc_) {
         // Writer already set, no need for reader to update topology
         return;
@@ -550,7 +633,7 @@ void ClusterTopologyMonitor::NodeMonitoringThread::handle_reader_conn() {
     }
 }
 
-void ClusterTopologyMonitor::NodeMonitoringThread::reader_thread_fetch_topology() {
+void ClusterTopologyMonitor::NodeMonitoringTask::reader_thread_fetch_topology() {
     auto* local_hdbc = reinterpret_cast<SQLHDBC>(*main_monitor_->node_threads_reader_hdbc_.get());
     // Check connection
     if (!main_monitor_->odbc_helper_->CheckConnection(local_hdbc)) {
@@ -32,8 +32,11 @@
 #include <sqltypes.h>
 
 #include "cluster_topology_query_helper.h"
+#include "topology_event.h"
+#include "topology_snapshot.h"
 
 #include "../host_info.h"
+#include "../util/connection_string_helper.h"
 #include "../util/logger_wrapper.h"
 #include "../util/odbc_helper.h"
 #include "../util/sliding_cache_map.h"
@@ -50,27 +53,37 @@ public:
     virtual void SetClusterId(const std::string& cluster_id);
     virtual std::vector<HostInfo> ForceRefresh(bool verify_writer, uint32_t timeout_ms);
     virtual std::vector<HostInfo> ForceRefresh(SQLHDBC hdbc, uint32_t timeout_ms);
+    virtual std::shared_ptr<const TopologySnapshot> GetTopologySnapshot();
+
+    /**
+     * Registers a listener for changes between published topologies.
+     *
+     * @return the subscription ID, used to unsubscribe
+     */
+    uint64_t Subscribe(const TopologyListener& listener);
+    void Unsubscribe(uint64_t subscription_id);
 
     virtual void StartMonitor();
 
 protected:
-    void Run();
+    // Refreshes the topology once, and returns the delay before the next refresh
+    std::chrono::milliseconds Run();
     std::vector<HostInfo> WaitForTopologyUpdate(uint32_t timeout_ms);
-    void DelayMainThread(bool use_high_refresh_rate);
+    std::chrono::milliseconds GetRefreshDelay(bool use_high_refresh_rate);
     std::vector<HostInfo> FetchTopologyUpdateCache(SQLHDBC hdbc);
     void UpdateTopologyCache(const std::vector<HostInfo>& hosts);
     SQLSTR ConnForHost(const std::string& new_host);
 
 private:
-    class NodeMonitoringThread;
+    class NodeMonitoringTask;
     std::shared_ptr<IOdbcHelper> odbc_helper_;
     std::shared_ptr<ClusterTopologyQueryHelper> query_helper_;
     bool in_panic_mode();
     std::vector<HostInfo> open_any_conn_get_hosts();
     static void dbc_clean_up(std::shared_ptr<SQLHDBC>& dbc);
 
-    bool handle_panic_mode();
-    bool handle_regular_mode();
+    bool handle_panic_mode(std::chrono::milliseconds& delay);
+    bool handle_regular_mode(std::chrono::milliseconds& delay);
     void handle_ignore_topology_timing();
     void init_node_monitors();
     bool get_possible_writer_conn();
@@ -78,6 +91,8 @@ private:
     // Topology Tracking
     std::string cluster_id_;
     SQLSTR conn_str_;
+    // Node monitors connect with failover disabled
+    ConnectionStringTemplate conn_template_;
 
     // SlidingCacheMap internally is thread safe
     std::shared_ptr<SlidingCacheMap<std::string, std::vector<HostInfo>>> topology_map_;
@@ -85,13 +100,17 @@ private:
     // Track Update Request
     std::atomic<bool> request_update_topology_;
     std::mutex request_update_topology_mutex_;
-    std::condition_variable request_update_topology_cv_;
-    const uint32_t TOPOLOGY_REQUEST_WAIT_MS = 50;
 
     // Track Topology Updated
+    // Snapshots are published while holding both the request and updated mutexes
     std::mutex topology_updated_mutex_;
     std::condition_variable topology_updated_;
-    const uint32_t TOPOLOGY_UPDATE_WAIT_MS = 1000;
+    AtomicTopologySnapshot topology_snapshot_;
+
+    // Topology Change Listeners
+    std::mutex listeners_mutex_;
+    std::map<uint64_t, TopologyListener> listeners_;
+    uint64_t next_subscription_id_ = 1;
 
     std::atomic<std::chrono::steady_clock::time_point> ignore_topology_request_end_ms_;
     uint32_t ignore_topology_request_ms_;
@@ -100,11 +119,11 @@ private:
     const std::chrono::seconds high_refresh_rate_after_panic_ = std::chrono::seconds(30);
     uint32_t refresh_rate_ms_;
 
-    // Main Thread
-    std::shared_ptr<std::thread> monitoring_thread_; 
+    // Main Refresh, run on the shared RefreshScheduler, 0 while not started
+    std::atomic<uint64_t> refresh_task_id_ = 0;
     std::atomic<bool> is_running_;
-    // Children / Node Threads
-    std::map<std::string, std::shared_ptr<NodeMonitoringThread>> node_monitoring_threads_;
+    // Children / Node Probes, executed on the shared NodeProbeExecutor
+    std::map<std::string, std::shared_ptr<NodeMonitoringTask>> node_monitoring_tasks_;
     std::atomic<bool> node_threads_stop_;
 
     // Children Thread Connections & Host Info
@@ -120,7 +139,7 @@ private:
 
     // TODO(yuenhcol), review if these can be done without mutex/atomics
     // There should be only at most 1 thread interacting with these
-    // Connection Information for main thread
+    // Connection Information for main refresh
     std::atomic<bool> is_writer_connection_;
     SQLHENV henv_;
     std::mutex hdbc_mutex_;
@@ -128,14 +147,19 @@ private:
     std::shared_ptr<HostInfo> main_writer_host_info_;
 };
 
-class ClusterTopologyMonitor::NodeMonitoringThread {
+class ClusterTopologyMonitor::NodeMonitoringTask {
 public:
-    NodeMonitoringThread(ClusterTopologyMonitor* monitor, const std::shared_ptr<HostInfo>& host_info,
+    NodeMonitoringTask(ClusterTopologyMonitor* monitor, const std::shared_ptr<HostInfo>& host_info,
         const std::shared_ptr<HostInfo>& writer_host_info);
-    ~NodeMonitoringThread();
+    ~NodeMonitoringTask();
+
+    // Admits this node into the shared probe executor. Returns false if no probe slot is available.
+    bool Start();
 
 private:
     void run();
+    void finish();
+    void probe();
     void handle_reconnect(SQLTCHAR* conn_cstr);
     void handle_writer_conn();
     void handle_reader_conn();
@@ -144,11 +168,20 @@ private:
     ClusterTopologyMonitor* main_monitor_;
     std::shared_ptr<HostInfo> host_info_;
     std::shared_ptr<HostInfo> writer_host_info_;
-    bool writer_changed_ = false;    
-    std::shared_ptr<std::thread> node_thread_;
+    bool writer_changed_ = false;
+    SQLSTR conn_str_;
     SQLHDBC hdbc_ = SQL_NULL_HDBC;
     bool reader_update_topology_ = false;
 
+    // Each node has at most one probe queued, running or waiting for its next run at a time
+    bool admitted_ = false;
+    bool task_pending_ = false;
+    std::atomic<bool> stop_ = false;
+    std::mutex task_pending_mutex_;
+    std::condition_variable task_pending_cv_;
+    // Waits out the interval between probes on the NodeProbeExecutor timer, 0 while not waiting
+    uint64_t requeue_task_id_ = 0;
+
     const uint32_t THREAD_SLEEP_MS_ = 100;
 };
 
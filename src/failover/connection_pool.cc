@@ -0,0 +1,363 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection_pool.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "../host_selector/round_robin_host_selector.h"
+#include "../util/connection_string_helper.h"
+#include "../util/connection_string_keys.h"
+#include "../util/refresh_scheduler.h"
+
+const uint32_t ConnectionPool::DEFAULT_IDLE_TTL_SEC = 600; // 600s = 10m
+const uint32_t ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST = 8;
+
+namespace {
+    // Expired connections are evicted at least this far apart, even with a shorter idle TTL
+    const std::chrono::milliseconds MIN_DRAIN_INTERVAL = std::chrono::seconds(1);
+}
+
+ConnectionPool::ConnectionPool(
+        const std::string& cluster_id,
+        const std::map<SQLSTR, SQLSTR>& conn_info,
+        const std::shared_ptr<ClusterTopologyMonitor>& topology_monitor,
+        const std::shared_ptr<HostSelector>& host_selector,
+        const std::shared_ptr<IOdbcHelper>& odbc_helper,
+        uint32_t idle_ttl_sec,
+        uint32_t max_idle_per_host):
+        cluster_id_{ cluster_id },
+        conn_info_{ conn_info },
+        topology_monitor_{ topology_monitor },
+        host_selector_{ host_selector },
+        odbc_helper_{ odbc_helper },
+        idle_ttl_{ idle_ttl_sec },
+        max_idle_per_host_{ max_idle_per_host } {
+    // Pooled connections must not register as failover users themselves,
+    // otherwise idle connections would keep the owning Failover Service alive
+    conn_info_.insert_or_assign(ENABLE_FAILOVER_KEY, BOOL_FALSE);
+    conn_template_ = ConnectionStringTemplate(ConnectionStringHelper::BuildConnectionString(conn_info_), {}, true);
+    drain_task_id_.store(RefreshScheduler::Schedule([this] { return run(); },
+        std::max<std::chrono::milliseconds>(idle_ttl_, MIN_DRAIN_INTERVAL)));
+}
+
+ConnectionPool::~ConnectionPool() {
+    // Waits for a drain in progress
+    RefreshScheduler::Cancel(drain_task_id_.exchange(0));
+
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    for (const auto& [key, connections] : idle_connections_) {
+        for (const IdleConnection& connection : connections) {
+            odbc_helper_->Cleanup(SQL_NULL_HANDLE, connection.hdbc, SQL_NULL_HANDLE);
+        }
+    }
+    idle_connections_.clear();
+    // Checked out connections belong to the caller
+    checked_out_.clear();
+}
+
+SQLHDBC ConnectionPool::Acquire(SQLHENV henv, bool writer) {
+    std::shared_ptr<const TopologySnapshot> topology = get_topology();
+    std::vector<SQLHDBC> removed;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        sync_topology(topology, removed);
+        evict_expired(std::chrono::steady_clock::now(), removed);
+    }
+    free_connections(removed);
+
+    // Validate idle connections outside of the lock, the check is a round trip to the server
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    PoolKey key;
+    while (take_idle(henv, writer, hdbc, key)) {
+        if (odbc_helper_->CheckConnection(hdbc)) {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            checked_out_[hdbc] = key;
+            return hdbc;
+        }
+        DLOG(INFO) << "[Connection Pool] dropping stale connection to: " << key.host;
+        odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+    }
+
+    hdbc = connect(henv, writer, topology, key);
+    if (SQL_NULL_HDBC != hdbc) {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        checked_out_[hdbc] = key;
+    }
+    return hdbc;
+}
+
+void ConnectionPool::Release(SQLHDBC hdbc) {
+    if (SQL_NULL_HDBC == hdbc) {
+        return;
+    }
+
+    std::shared_ptr<const TopologySnapshot> topology = get_topology();
+    std::vector<SQLHDBC> removed;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        sync_topology(topology, removed);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        evict_expired(now, removed);
+
+        bool pooled = false;
+        if (auto itr = checked_out_.find(hdbc); itr != checked_out_.end()) {
+            PoolKey key = itr->second;
+            checked_out_.erase(itr);
+            if (is_valid(key, topology)) {
+                std::deque<IdleConnection>& connections = idle_connections_[key];
+                if (connections.size() < max_idle_per_host_) {
+                    connections.push_back(IdleConnection{ hdbc, now + idle_ttl_ });
+                    pooled = true;
+                }
+            }
+            if (!pooled) {
+                DLOG(INFO) << "[Connection Pool] not pooling connection to: " << key.host;
+            }
+        } else {
+            LOG(WARNING) << "[Connection Pool] released connection was not acquired from the pool for: " << cluster_id_;
+        }
+        if (!pooled) {
+            removed.push_back(hdbc);
+        }
+    }
+    free_connections(removed);
+}
+
+void ConnectionPool::Drain(const std::string& host) {
+    std::vector<SQLHDBC> drained;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        for (auto itr = idle_connections_.begin(); itr != idle_connections_.end();) {
+            if (itr->first.host == host) {
+                for (const IdleConnection& connection : itr->second) {
+                    drained.push_back(connection.hdbc);
+                }
+                itr = idle_connections_.erase(itr);
+            } else {
+                itr++;
+            }
+        }
+    }
+    if (!drained.empty()) {
+        LOG(INFO) << "[Connection Pool] draining " << drained.size() << " idle connection(s) to: " << host;
+    }
+    free_connections(drained);
+}
+
+void ConnectionPool::OnTopologyChange(const std::shared_ptr<const TopologySnapshot>& topology) {
+    {
+        std::lock_guard<std::mutex> lock(pending_topology_mutex_);
+        // Listeners may see snapshots out of order, keep the newest
+        if (topology && (!pending_topology_ || topology->generation > pending_topology_->generation)) {
+            pending_topology_ = topology;
+        }
+    }
+    // Kept until the next drain starts, a wake has no effect while a drain is running
+    drain_requested_.store(true);
+    RefreshScheduler::Wake(drain_task_id_.load());
+}
+
+size_t ConnectionPool::IdleSize() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    size_t size = 0;
+    for (const auto& [key, connections] : idle_connections_) {
+        size += connections.size();
+    }
+    return size;
+}
+
+std::chrono::milliseconds ConnectionPool::run() {
+    drain_requested_.store(false);
+    std::shared_ptr<const TopologySnapshot> topology = get_topology();
+    std::vector<SQLHDBC> removed;
+    std::vector<PoolKey> drained;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        sync_topology(topology, removed, &drained);
+        evict_expired(std::chrono::steady_clock::now(), removed);
+    }
+    free_connections(removed);
+    replace_drained(drained, topology);
+    if (drain_requested_.load()) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::max<std::chrono::milliseconds>(idle_ttl_, MIN_DRAIN_INTERVAL);
+}
+
+void ConnectionPool::replace_drained(const std::vector<PoolKey>& drained, const std::shared_ptr<const TopologySnapshot>& topology) {
+    for (const PoolKey& drained_key : drained) {
+        // Only replaced with a connection in the same role
+        bool has_role = topology && std::any_of(topology->hosts.begin(), topology->hosts.end(), [&drained_key](const HostInfo& host) {
+            return host.IsHostWriter() == drained_key.is_writer && host.IsHostUp();
+        });
+        if (!has_role) {
+            continue;
+        }
+        PoolKey key;
+        SQLHDBC hdbc = connect(drained_key.henv, drained_key.is_writer, topology, key);
+        if (SQL_NULL_HDBC == hdbc) {
+            continue;
+        }
+
+        bool pooled = false;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            std::deque<IdleConnection>& connections = idle_connections_[key];
+            if (connections.size() < max_idle_per_host_) {
+                connections.push_back(IdleConnection{ hdbc, std::chrono::steady_clock::now() + idle_ttl_ });
+                pooled = true;
+            }
+        }
+        if (pooled) {
+            DLOG(INFO) << "[Connection Pool] replaced drained connection to: " << drained_key.host << " with: " << key.host;
+        } else {
+            odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+        }
+    }
+}
+
+void ConnectionPool::sync_topology(const std::shared_ptr<const TopologySnapshot>& topology, std::vector<SQLHDBC>& removed,
+    std::vector<PoolKey>* drained) {
+    // Never go back to an older topology
+    if (!topology || topology->generation <= topology_generation_) {
+        return;
+    }
+    topology_generation_ = topology->generation;
+
+    // Host removed, down, or its role changed since the connections were opened
+    for (auto itr = idle_connections_.begin(); itr != idle_connections_.end();) {
+        if (is_valid(itr->first, topology)) {
+            itr++;
+            continue;
+        }
+        LOG(INFO) << "[Connection Pool] draining idle connections to: " << itr->first.host;
+        for (const IdleConnection& connection : itr->second) {
+            removed.push_back(connection.hdbc);
+            if (drained) {
+                drained->push_back(itr->first);
+            }
+        }
+        itr = idle_connections_.erase(itr);
+    }
+}
+
+void ConnectionPool::evict_expired(std::chrono::steady_clock::time_point now, std::vector<SQLHDBC>& removed) {
+    for (auto itr = idle_connections_.begin(); itr != idle_connections_.end();) {
+        std::deque<IdleConnection>& connections = itr->second;
+        // Oldest connections are at the front
+        while (!connections.empty() && connections.front().expiry < now) {
+            removed.push_back(connections.front().hdbc);
+            connections.pop_front();
+        }
+        if (connections.empty()) {
+            itr = idle_connections_.erase(itr);
+        } else {
+            itr++;
+        }
+    }
+}
+
+void ConnectionPool::free_connections(const std::vector<SQLHDBC>& connections) {
+    for (SQLHDBC hdbc : connections) {
+        odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+    }
+}
+
+std::shared_ptr<const TopologySnapshot> ConnectionPool::get_topology() {
+    std::shared_ptr<const TopologySnapshot> topology = topology_monitor_->GetTopologySnapshot();
+    std::lock_guard<std::mutex> lock(pending_topology_mutex_);
+    if (pending_topology_ && (!topology || pending_topology_->generation > topology->generation)) {
+        topology = pending_topology_;
+    }
+    pending_topology_ = nullptr;
+    return topology;
+}
+
+bool ConnectionPool::take_idle(SQLHENV henv, bool writer, SQLHDBC& hdbc, PoolKey& key) {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    for (auto itr = idle_connections_.begin(); itr != idle_connections_.end(); itr++) {
+        std::deque<IdleConnection>& connections = itr->second;
+        if (itr->first.henv != henv || itr->first.is_writer != writer || connections.empty()) {
+            continue;
+        }
+        // Most recently used connection is the most likely to still be alive
+        hdbc = connections.back().hdbc;
+        key = itr->first;
+        connections.pop_back();
+        if (connections.empty()) {
+            idle_connections_.erase(itr);
+        }
+        return true;
+    }
+    return false;
+}
+
+SQLHDBC ConnectionPool::connect(SQLHENV henv, bool writer, const std::shared_ptr<const TopologySnapshot>& topology, PoolKey& key) {
+    std::string host_string;
+    bool is_writer = writer;
+    if (topology && !topology->hosts.empty()) {
+        // Reader selection considers every host, only fall back to the writer when there are no readers
+        std::vector<HostInfo> candidates;
+        std::copy_if(topology->hosts.begin(), topology->hosts.end(), std::back_inserter(candidates),
+            [writer](const HostInfo& host) { return writer || !host.IsHostWriter(); });
+        if (candidates.empty()) {
+            candidates = topology->hosts;
+        }
+        std::unordered_map<std::string, std::string> properties;
+        RoundRobinHostSelector::SetRoundRobinWeight(candidates, properties);
+        try {
+            HostInfo host = host_selector_->GetHost(candidates, writer, properties);
+            host_string = host.GetHost();
+            is_writer = host.IsHostWriter();
+        } catch (const std::exception& ex) {
+            LOG(INFO) << "[Connection Pool] no " << (writer ? "writer" : "reader") << " in topology for: " << cluster_id_;
+            return SQL_NULL_HDBC;
+        }
+    } else if (conn_info_.contains(SERVER_HOST_KEY)) {
+        // No topology yet, use the configured endpoint
+        host_string = StringHelper::ToString(conn_info_.at(SERVER_HOST_KEY));
+    } else {
+        return SQL_NULL_HDBC;
+    }
+
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    if (!odbc_helper_->AllocateHandle(SQL_HANDLE_DBC, henv, hdbc, "[Connection Pool] unable to allocate connection handle")) {
+        return SQL_NULL_HDBC;
+    }
+    SQLSTR conn_str = get_conn_str_for_host(host_string);
+    if (!odbc_helper_->ConnStrConnect(AS_SQLTCHAR(conn_str.c_str()), hdbc)) {
+        LOG(INFO) << "[Connection Pool] unable to connect to: " << host_string;
+        odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+        return SQL_NULL_HDBC;
+    }
+    key = PoolKey{ host_string, is_writer, henv };
+    return hdbc;
+}
+
+SQLSTR ConnectionPool::get_conn_str_for_host(const std::string& host) const {
+    return conn_template_.ForHost(StringHelper::ToSQLSTR(host));
+}
+
+bool ConnectionPool::is_valid(const PoolKey& key, const std::shared_ptr<const TopologySnapshot>& topology) {
+    if (!topology || topology->hosts.empty()) {
+        // Nothing known about the cluster yet
+        return true;
+    }
+    return std::any_of(topology->hosts.begin(), topology->hosts.end(), [&key](const HostInfo& host) {
+        return host.GetHost() == key.host && host.IsHostWriter() == key.is_writer && host.IsHostUp();
+    });
+}
@@ -0,0 +1,142 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ODBC APIs
+#ifdef WIN32
+    #include <windows.h>
+#endif
+#include <sql.h>
+#include <sqltypes.h>
+
+#include "../host_info.h"
+#include "../util/connection_string_helper.h"
+#include "../host_selector/host_selector.h"
+#include "../util/odbc_helper.h"
+#include "../util/string_helper.h"
+#include "cluster_topology_monitor.h"
+
+/**
+ * Idle connections to a cluster, kept per host, role and environment.
+ * Idle connections expire after the idle TTL unless they are reused, matching SlidingCacheMap,
+ * are only validated when handed out, and are drained once the topology no longer lists their host in that role.
+ * Expired and drained connections are freed by a task on the shared RefreshScheduler, so an idle pool releases them too.
+ * That task also replaces each drained connection with one of the same role and environment, so after a writer change
+ * callers find connections to the new writer instead of all reconnecting at once.
+ */
+class ConnectionPool {
+public:
+    static const uint32_t DEFAULT_IDLE_TTL_SEC;
+    static const uint32_t DEFAULT_MAX_IDLE_PER_HOST;
+
+    ConnectionPool(const std::string& cluster_id, const std::map<SQLSTR, SQLSTR>& conn_info,
+        const std::shared_ptr<ClusterTopologyMonitor>& topology_monitor, const std::shared_ptr<HostSelector>& host_selector,
+        const std::shared_ptr<IOdbcHelper>& odbc_helper, uint32_t idle_ttl_sec, uint32_t max_idle_per_host);
+    ~ConnectionPool();
+
+    /**
+     * Hands out an idle connection with the given role that was allocated on the given environment,
+     * or opens a new one on it.
+     *
+     * @return a connected HDBC, or SQL_NULL_HDBC if no connection could be established
+     */
+    SQLHDBC Acquire(SQLHENV henv, bool writer);
+
+    /**
+     * Returns a connection from Acquire to the pool.
+     * The connection is freed instead if it is unknown to the pool, its host is no longer valid for its role,
+     * or the pool for its host is full.
+     */
+    void Release(SQLHDBC hdbc);
+
+    /**
+     * Frees all idle connections to the given host.
+     */
+    void Drain(const std::string& host);
+
+    /**
+     * Records a newly published topology and wakes the pool's drain task, which frees the idle connections
+     * that are no longer valid for it and replaces them. The publishing thread never disconnects.
+     */
+    void OnTopologyChange(const std::shared_ptr<const TopologySnapshot>& topology);
+    size_t IdleSize();
+
+private:
+    struct PoolKey {
+        std::string host;
+        bool is_writer = false;
+        // Idle connections are only handed to callers on the environment they were allocated on
+        SQLHENV henv = SQL_NULL_HENV;
+
+        auto operator<=>(const PoolKey&) const = default;
+    };
+
+    struct IdleConnection {
+        SQLHDBC hdbc;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    // Applies the latest topology, evicts expired connections and replaces drained ones,
+    // returns the delay before the next run
+    std::chrono::milliseconds run();
+    void replace_drained(const std::vector<PoolKey>& drained, const std::shared_ptr<const TopologySnapshot>& topology);
+    // Both collect the removed connections, callers free them after releasing the pool lock.
+    // The drain task also collects one key per drained connection to replace it, callers of Acquire connect themselves
+    void sync_topology(const std::shared_ptr<const TopologySnapshot>& topology, std::vector<SQLHDBC>& removed,
+        std::vector<PoolKey>* drained = nullptr);
+    void evict_expired(std::chrono::steady_clock::time_point now, std::vector<SQLHDBC>& removed);
+    void free_connections(const std::vector<SQLHDBC>& connections);
+    std::shared_ptr<const TopologySnapshot> get_topology();
+    bool take_idle(SQLHENV henv, bool writer, SQLHDBC& hdbc, PoolKey& key);
+    SQLHDBC connect(SQLHENV henv, bool writer, const std::shared_ptr<const TopologySnapshot>& topology, PoolKey& key);
+    SQLSTR get_conn_str_for_host(const std::string& host) const;
+    static bool is_valid(const PoolKey& key, const std::shared_ptr<const TopologySnapshot>& topology);
+
+    std::string cluster_id_;
+    std::map<SQLSTR, SQLSTR> conn_info_;
+    ConnectionStringTemplate conn_template_;
+    std::shared_ptr<ClusterTopologyMonitor> topology_monitor_;
+    std::shared_ptr<HostSelector> host_selector_;
+    std::shared_ptr<IOdbcHelper> odbc_helper_;
+    std::chrono::seconds idle_ttl_;
+    uint32_t max_idle_per_host_;
+
+    std::mutex pool_mutex_;
+    std::map<PoolKey, std::deque<IdleConnection>> idle_connections_;
+    std::unordered_map<SQLHDBC, PoolKey> checked_out_;
+    uint64_t topology_generation_ = 0;
+
+    // Latest topology published to OnTopologyChange, not yet applied
+    std::mutex pending_topology_mutex_;
+    std::shared_ptr<const TopologySnapshot> pending_topology_;
+
+    // Drain task on the shared RefreshScheduler
+    std::atomic<uint64_t> drain_task_id_ = 0;
+    std::atomic<bool> drain_requested_ = false;
+};
+
+#endif // CONNECTION_POOL_H
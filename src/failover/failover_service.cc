@@ -16,6 +16,9 @@
 
 #include <sqlext.h>
 
+#include <system_error>
+#include <thread>
+
 #include <glog/logging.h>
 
 #include "../dialect/dialect_aurora_postgres.h"
@@ -26,7 +29,9 @@
 #include "../util/connection_string_helper.h"
 #include "../util/connection_string_keys.h"
 #include "../util/rds_utils.h"
+#include "../util/refresh_scheduler.h"
 #include "../util/string_helper.h"
+#include "node_probe_executor.h"
 
 std::unordered_map<std::string, std::shared_ptr<FailoverServiceTracker>> FailoverServiceTrackerHandler::global_failover_services;
 std::mutex FailoverServiceTrackerHandler::map_mutex;
@@ -41,6 +46,38 @@ const uint32_t FailoverService::DEFAULT_REFRESH_RATE_MS =
     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::seconds(30)).count();
 const uint32_t FailoverService::DEFAULT_FAILOVER_TIMEOUT_MS =
     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::seconds(30)).count();
+const uint32_t FailoverService::DEFAULT_READER_FANOUT = 1;
+const uint32_t FailoverService::DEFAULT_STANDBY_CONNECTIONS = 0;
+const uint32_t FailoverService::DEFAULT_POOL_IDLE_TTL_SEC = ConnectionPool::DEFAULT_IDLE_TTL_SEC;
+const uint32_t FailoverService::DEFAULT_POOL_MAX_IDLE = ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST;
+
+namespace {
+    // Shared between racing reader connection attempts, outlives the failover call while losing attempts still connect
+    struct ReaderRace {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t pending = 0;
+        bool finished = false;
+        int winner = -1;
+        SQLHDBC winner_hdbc = SQL_NULL_HDBC;
+        std::vector<bool> completed;
+        std::vector<bool> connected;
+        std::vector<bool> is_reader;
+    };
+}
+
+// Winning handles are handed to the caller and live on this environment, it is freed once the service has ended
+// and no attempt still connects on it
+struct FailoverService::RaceEnvironment {
+    RaceEnvironment(std::shared_ptr<IOdbcHelper> odbc_helper, SQLHENV henv)
+        : odbc_helper{ std::move(odbc_helper) }, henv{ henv } {}
+    ~RaceEnvironment() {
+        odbc_helper->Cleanup(henv, SQL_NULL_HDBC, SQL_NULL_HSTMT);
+    }
+
+    std::shared_ptr<IOdbcHelper> odbc_helper;
+    SQLHENV henv;
+};
 
 void FailoverServiceTrackerHandler::PutIfAbsent(const std::string& key, const std::shared_ptr<FailoverServiceTracker>& tracker) {
     std::lock_guard lock(map_mutex);
@@ -58,6 +95,8 @@ void FailoverServiceTrackerHandler::Increment(const std::string& cluster_id) {
  }
 
 void FailoverServiceTrackerHandler::Decrement(const std::string& cluster_id) {
+     // Freed after unlocking, closing its standby connections may call back into the driver
+     std::shared_ptr<FailoverService> ended_service;
      std::lock_guard lock(map_mutex);
      const std::shared_ptr<FailoverServiceTracker>& tracker = global_failover_services.at(cluster_id);
      if (tracker->reference_count > 0) {
@@ -65,7 +104,7 @@ void FailoverServiceTrackerHandler::Decrement(const std::string& cluster_id) {
          LOG(INFO) << "[Failover Service] removing reference for: " << cluster_id << ". Now at: " << tracker->reference_count;
          if (tracker->reference_count <= 0 && tracker->failover_inprogress.load() <= 0) {
              LOG(INFO) << "[Failover Service] ended for: " << cluster_id;
-             tracker->service.reset();
+             ended_service.swap(tracker->service);
          }
      }
  }
@@ -97,7 +136,8 @@ FailoverService::FailoverService(const std::string& host, const std::string& clu
                                  std::shared_ptr<std::map<SQLSTR, SQLSTR>> conn_info,
                                  std::shared_ptr<SlidingCacheMap<std::string, std::vector<HostInfo>>> topology_map,
                                  const std::shared_ptr<ClusterTopologyMonitor>& topology_monitor,
-                                 const std::shared_ptr<IOdbcHelper>& odbc_helper)
+                                 const std::shared_ptr<IOdbcHelper>& odbc_helper,
+                                 SQLHENV henv)
     : cluster_id_{ std::move(cluster_id) },
       dialect_{ std::move(dialect) },
       conn_info_{ std::move(conn_info) },
@@ -106,13 +146,56 @@ FailoverService::FailoverService(const std::string& host, const std::string& clu
       odbc_helper_{ std::move(odbc_helper) } {
     this->init_failover_mode(host);
     this->host_selector_ = get_reader_host_selector();
+    // Connections opened by a failover keep failover enabled
+    conn_template_ = ConnectionStringTemplate(ConnectionStringHelper::BuildConnectionString(*conn_info_),
+        { { ENABLE_FAILOVER_KEY, BOOL_TRUE } }, true);
     failover_timeout_ = parse_num(conn_info_->contains(FAILOVER_TIMEOUT_KEY) ?
         conn_info_->at(FAILOVER_TIMEOUT_KEY) : TEXT(""), DEFAULT_FAILOVER_TIMEOUT_MS);
+    reader_fanout_ = parse_num(conn_info_->contains(FAILOVER_READER_FANOUT_KEY) ?
+        conn_info_->at(FAILOVER_READER_FANOUT_KEY) : TEXT(""), DEFAULT_READER_FANOUT);
+    if (reader_fanout_ > 1) {
+        // Losing attempts are freed after the failover returns, so they must not use the caller's environment
+        SQLHENV race_henv = SQL_NULL_HENV;
+        if (!odbc_helper_->AllocateHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, race_henv, "[Failover Service] unable to allocate racing reader environment")) {
+            LOG(WARNING) << "[Failover Service] readers are connected one at a time for: " << cluster_id_;
+        } else if (!odbc_helper_->SetHenvToOdbc3(race_henv, "[Failover Service] unable to set racing reader environment to ODBC 3")) {
+            odbc_helper_->Cleanup(race_henv, SQL_NULL_HDBC, SQL_NULL_HSTMT);
+            LOG(WARNING) << "[Failover Service] readers are connected one at a time for: " << cluster_id_;
+        } else {
+            race_env_ = std::make_shared<RaceEnvironment>(odbc_helper_, race_henv);
+        }
+    }
     topology_monitor_->StartMonitor();
     curr_host_ = HostInfo(host, dialect_->GetDefaultPort(), UP, false, nullptr, 0);
+
+    uint32_t standby_connections = parse_num(conn_info_->contains(FAILOVER_STANDBY_CONNECTIONS_KEY) ?
+        conn_info_->at(FAILOVER_STANDBY_CONNECTIONS_KEY) : TEXT(""), DEFAULT_STANDBY_CONNECTIONS);
+    if (standby_connections > 0 && SQL_NULL_HENV != henv) {
+        uint32_t standby_refresh_rate = parse_num(conn_info_->contains(FAILOVER_STANDBY_REFRESH_RATE_KEY) ?
+            conn_info_->at(FAILOVER_STANDBY_REFRESH_RATE_KEY) : TEXT(""), StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+        standby_pool_ = std::make_shared<StandbyConnectionPool>(cluster_id_, *conn_info_, topology_monitor_, odbc_helper_,
+            henv, standby_connections, standby_refresh_rate);
+        standby_pool_->Start();
+        // Replace standby connections as soon as the topology changes, instead of at the next refresh
+        std::weak_ptr<StandbyConnectionPool> weak_standby_pool = standby_pool_;
+        standby_subscription_id_ = topology_monitor_->Subscribe(
+            [weak_standby_pool](const std::shared_ptr<const TopologySnapshot>&, const std::vector<TopologyEvent>&) {
+                if (std::shared_ptr<StandbyConnectionPool> standby_pool = weak_standby_pool.lock()) {
+                    standby_pool->RequestRefresh();
+                }
+            });
+    }
 }
 
 FailoverService::~FailoverService() {
+    if (connection_pool_subscription_id_ > 0) {
+        topology_monitor_->Unsubscribe(connection_pool_subscription_id_);
+    }
+    if (standby_subscription_id_ > 0) {
+        topology_monitor_->Unsubscribe(standby_subscription_id_);
+    }
+    connection_pool_ = nullptr;
+    standby_pool_ = nullptr;
     host_selector_ = nullptr;
     topology_monitor_ = nullptr;
     topology_map_ = nullptr;
@@ -160,13 +243,17 @@ std::shared_ptr<HostSelector> FailoverService::get_reader_host_selector() const
     }
 }
 
-FailoverStatus FailoverService::Failover(SQLHDBC hdbc, const char* sql_state) {
+FailoverStatus FailoverService::Failover(SQLHDBC& hdbc, const char* sql_state, SQLHENV henv) {
     if (!check_should_failover(sql_state)) {
         LOG(WARNING) << "[Failover Service] SQL State: " << sql_state << " not supported for Failover.";
         return FAILOVER_SKIPPED;
     }
 
-    conn_info_->insert_or_assign(ENABLE_FAILOVER_KEY, BOOL_TRUE);
+    // Standby connections belong to the environment the service was started with
+    if (standby_pool_ && standby_pool_->GetEnvironment() == henv && failover_to_standby(hdbc)) {
+        return FAILOVER_SUCCEED;
+    }
+
     bool failover_result = false;
     if (failover_mode_ == STRICT_WRITER) {
         failover_result = failover_writer(hdbc);
@@ -181,6 +268,36 @@ HostInfo FailoverService::GetCurrentHost() {
     return curr_host_;
 }
 
+SQLHDBC FailoverService::AcquireConnection(SQLHENV henv, bool writer) {
+    return get_connection_pool()->Acquire(henv, writer);
+}
+
+void FailoverService::ReleaseConnection(SQLHDBC hdbc) {
+    get_connection_pool()->Release(hdbc);
+}
+
+std::shared_ptr<ConnectionPool> FailoverService::get_connection_pool() {
+    std::lock_guard<std::mutex> lock(connection_pool_mutex_);
+    if (!connection_pool_) {
+        // Created on first use, so services that never pool connections do not pay for it
+        uint32_t idle_ttl = parse_num(conn_info_->contains(CONNECTION_POOL_IDLE_TTL_KEY) ?
+            conn_info_->at(CONNECTION_POOL_IDLE_TTL_KEY) : TEXT(""), DEFAULT_POOL_IDLE_TTL_SEC);
+        uint32_t max_idle = parse_num(conn_info_->contains(CONNECTION_POOL_MAX_IDLE_KEY) ?
+            conn_info_->at(CONNECTION_POOL_MAX_IDLE_KEY) : TEXT(""), DEFAULT_POOL_MAX_IDLE);
+        connection_pool_ = std::make_shared<ConnectionPool>(cluster_id_, *conn_info_, topology_monitor_,
+            host_selector_, odbc_helper_, idle_ttl, max_idle);
+        // Drain idle connections to removed or demoted hosts before they are handed out
+        std::weak_ptr<ConnectionPool> weak_connection_pool = connection_pool_;
+        connection_pool_subscription_id_ = topology_monitor_->Subscribe(
+            [weak_connection_pool](const std::shared_ptr<const TopologySnapshot>& topology, const std::vector<TopologyEvent>&) {
+                if (std::shared_ptr<ConnectionPool> connection_pool = weak_connection_pool.lock()) {
+                    connection_pool->OnTopologyChange(topology);
+                }
+            });
+    }
+    return connection_pool_;
+}
+
 bool FailoverService::check_should_failover(const char* sql_state) {
     // Check if the SQL State is related to a communication error
     const char* start = "08";
@@ -193,7 +310,7 @@ void FailoverService::remove_candidate(const std::string& host, std::vector<Host
                      candidates.end());
 }
 
-bool FailoverService::failover_reader(SQLHDBC hdbc) {
+bool FailoverService::failover_reader(SQLHDBC& hdbc) {
     auto get_current = [] {
         return std::chrono::steady_clock::time_point(std::chrono::high_resolution_clock::now().time_since_epoch());
     };
@@ -206,8 +323,8 @@ bool FailoverService::failover_reader(SQLHDBC hdbc) {
     topology_monitor_->ForceRefresh(false, 0);
 
     // The roles in this list might not be accurate, depending on whether the new topology has become available yet.
-    std::vector<HostInfo> hosts = topology_map_->Get(cluster_id_);
-    if (hosts.empty()) {
+    std::shared_ptr<const TopologySnapshot> topology = get_topology();
+    if (topology->hosts.empty()) {
         LOG(INFO) << "No topology available.";
         return false;
     }
@@ -215,7 +332,7 @@ bool FailoverService::failover_reader(SQLHDBC hdbc) {
     std::vector<HostInfo> reader_candidates;
     HostInfo original_writer;
 
-    for (const auto& host : hosts) {
+    for (const auto& host : topology->hosts) {
         if (host.IsHostWriter()) {
             original_writer = host;
         } else {
@@ -232,6 +349,13 @@ bool FailoverService::failover_reader(SQLHDBC hdbc) {
         std::vector<HostInfo> remaining_readers(reader_candidates);
         while (!remaining_readers.empty() && (curr_time = get_current()) < end) {
             LOG(INFO) << "Failover for ClusterId: " << cluster_id_ << ". Remaining Hosts: " << ClusterTopologyHelper::LogTopology(remaining_readers);
+            if (race_env_) {
+                if (connect_to_any_reader(hdbc, remaining_readers, reader_candidates, properties, end)) {
+                    return true;
+                }
+                continue;
+            }
+
             HostInfo host;
             try {
                 host = host_selector_->GetHost(remaining_readers, false, properties);
@@ -308,15 +432,14 @@ bool FailoverService::failover_reader(SQLHDBC hdbc) {
 }
 
 bool FailoverService::failover_writer(SQLHDBC hdbc) {
-    topology_monitor_->ForceRefresh(true, failover_timeout_);
+    std::shared_ptr<const TopologySnapshot> topology = get_verified_topology();
 
     // Try connecting to a writer
-    std::vector<HostInfo> hosts = topology_map_->Get(cluster_id_);
     std::unordered_map<std::string, std::string> properties;
-    RoundRobinHostSelector::SetRoundRobinWeight(hosts, properties);
+    RoundRobinHostSelector::SetRoundRobinWeight(topology->hosts, properties);
     HostInfo host;    
     try {
-        host = host_selector_->GetHost(hosts, true, properties);
+        host = host_selector_->GetHost(topology->hosts, true, properties);
     } catch (const std::exception& e) {
         LOG(INFO) << "[Failover Service] no hosts in topology for: " << cluster_id_;
         return false;
@@ -343,15 +466,206 @@ bool FailoverService::failover_writer(SQLHDBC hdbc) {
     return false;
 }
 
+bool FailoverService::failover_to_standby(SQLHDBC& hdbc) {
+    // Standby connections may predate the failover, only refresh topology without waiting on it
+    topology_monitor_->ForceRefresh(false, 0);
+
+    bool prefer_writer = failover_mode_ == STRICT_WRITER;
+    SQLHDBC standby_hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    while (standby_pool_->Take(prefer_writer, standby_hdbc, host, references)) {
+        if (odbc_helper_->CheckConnection(standby_hdbc)) {
+            bool is_reader = is_connected_to_reader(standby_hdbc);
+            if ((failover_mode_ == STRICT_WRITER && !is_reader) ||
+                (failover_mode_ == STRICT_READER && is_reader) ||
+                failover_mode_ == READER_OR_WRITER) {
+                LOG(INFO) << "[Failover Service] handing over standby connection to: " << host.GetHost();
+                // The connection now counts like any other, starting with the references the driver took for it
+                for (int i = 0; i < references && FailoverServiceTrackerHandler::Contains(cluster_id_); i++) {
+                    FailoverServiceTrackerHandler::Increment(cluster_id_);
+                }
+                odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+                hdbc = standby_hdbc;
+                curr_host_ = host;
+                return true;
+            }
+            LOG(INFO) << "[Failover Service] standby connection role does not match failover mode: " << host.GetHost();
+        }
+        StandbyReferenceScope scope(cluster_id_);
+        odbc_helper_->Cleanup(SQL_NULL_HANDLE, standby_hdbc, SQL_NULL_HANDLE);
+    }
+    LOG(INFO) << "[Failover Service] no usable standby connection for: " << cluster_id_;
+    return false;
+}
+
+std::shared_ptr<const TopologySnapshot> FailoverService::get_verified_topology() {
+    std::unique_lock<std::mutex> lock(writer_verification_mutex_);
+    if (writer_verification_in_flight_) {
+        // Join the verification already in progress instead of resetting the monitor connection again
+        uint64_t joined_verification = writer_verifications_completed_;
+        bool completed = writer_verification_cv_.wait_until(lock,
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(failover_timeout_), [this, joined_verification] {
+                return writer_verifications_completed_ != joined_verification;
+            });
+        if (completed && writer_verification_result_) {
+            LOG(INFO) << "[Failover Service] joined in-flight writer verification for: " << cluster_id_;
+            return writer_verification_result_;
+        }
+        lock.unlock();
+        LOG(INFO) << "[Failover Service] in-flight writer verification did not complete, using current topology for: " << cluster_id_;
+        return get_topology();
+    }
+    writer_verification_in_flight_ = true;
+    writer_verification_result_ = nullptr;
+    lock.unlock();
+
+    // Completes the verification even if the refresh throws, so later failovers never wait on it
+    struct VerificationGuard {
+        FailoverService* service;
+        std::shared_ptr<const TopologySnapshot> result;
+
+        ~VerificationGuard() {
+            std::lock_guard<std::mutex> lock(service->writer_verification_mutex_);
+            service->writer_verification_result_ = result;
+            service->writer_verification_in_flight_ = false;
+            service->writer_verifications_completed_++;
+            service->writer_verification_cv_.notify_all();
+        }
+    } guard{ this, nullptr };
+
+    topology_monitor_->ForceRefresh(true, failover_timeout_);
+    guard.result = get_topology();
+    return guard.result;
+}
+
+std::shared_ptr<const TopologySnapshot> FailoverService::get_topology() {
+    std::shared_ptr<const TopologySnapshot> snapshot = topology_monitor_->GetTopologySnapshot();
+    if (snapshot && !snapshot->hosts.empty()) {
+        return snapshot;
+    }
+    // Monitor has not published a topology yet, fall back to the shared topology cache
+    return std::make_shared<const TopologySnapshot>(0, topology_map_->Get(cluster_id_));
+}
+
+bool FailoverService::connect_to_any_reader(SQLHDBC& hdbc, std::vector<HostInfo>& remaining_readers,
+                                            std::vector<HostInfo>& reader_candidates,
+                                            std::unordered_map<std::string, std::string>& properties,
+                                            std::chrono::steady_clock::time_point end) {
+    // Take the top candidates from the host selector, in selection order
+    std::vector<HostInfo> racing_hosts;
+    std::vector<HostInfo> selectable(remaining_readers);
+    while (racing_hosts.size() < reader_fanout_ && !selectable.empty()) {
+        try {
+            HostInfo host = host_selector_->GetHost(selectable, false, properties);
+            remove_candidate(host.GetHost(), selectable);
+            racing_hosts.push_back(host);
+        } catch (const std::exception& e) {
+            break;
+        }
+    }
+    if (racing_hosts.empty()) {
+        LOG(INFO) << "[Failover Service] no hosts in topology for: " << cluster_id_;
+        remaining_readers.clear();
+        return false;
+    }
+    LOG(INFO) << "[Failover Service] Racing connections to: " << ClusterTopologyHelper::LogTopology(racing_hosts);
+
+    std::shared_ptr<ReaderRace> race = std::make_shared<ReaderRace>();
+    size_t race_size = racing_hosts.size();
+    race->completed.assign(race_size, false);
+    race->connected.assign(race_size, false);
+    race->is_reader.assign(race_size, false);
+
+    // Each attempt runs on its own thread, so a blocked connect never queues behind another, and only captures shared state
+    std::shared_ptr<RaceEnvironment> race_env = race_env_;
+    std::shared_ptr<IOdbcHelper> odbc_helper = odbc_helper_;
+    std::shared_ptr<Dialect> dialect = dialect_;
+    bool strict_reader = failover_mode_ == STRICT_READER;
+    for (size_t i = 0; i < race_size; i++) {
+        SQLSTR conn_str = get_conn_str_for_host(racing_hosts[i].GetHost());
+        std::lock_guard<std::mutex> lock(race->mutex);
+        race->pending++;
+        try {
+            std::thread([race, i, conn_str, race_env, odbc_helper, dialect, strict_reader] {
+                SQLHDBC attempt_hdbc = SQL_NULL_HDBC;
+                bool connected = odbc_helper->AllocateHandle(SQL_HANDLE_DBC, race_env->henv, attempt_hdbc,
+                        "[Failover Service] unable to allocate racing reader handle") &&
+                    odbc_helper->ConnStrConnect(AS_SQLTCHAR(conn_str.c_str()), attempt_hdbc) &&
+                    odbc_helper->CheckConnection(attempt_hdbc);
+                bool is_reader = connected && is_connected_to_reader(odbc_helper, dialect, attempt_hdbc);
+
+                bool won = false;
+                {
+                    std::lock_guard<std::mutex> lock(race->mutex);
+                    race->pending--;
+                    race->completed[i] = true;
+                    race->connected[i] = connected;
+                    race->is_reader[i] = is_reader;
+                    if (connected && (is_reader || !strict_reader) && !race->finished) {
+                        race->finished = true;
+                        race->winner = static_cast<int>(i);
+                        race->winner_hdbc = attempt_hdbc;
+                        won = true;
+                    }
+                    race->cv.notify_all();
+                }
+                if (!won && SQL_NULL_HDBC != attempt_hdbc) {
+                    // The failover does not wait for losing attempts, each frees its own handle
+                    odbc_helper->Cleanup(SQL_NULL_HANDLE, attempt_hdbc, SQL_NULL_HANDLE);
+                }
+            }).detach();
+        } catch (const std::system_error& ex) {
+            LOG(ERROR) << "[Failover Service] unable to start racing reader attempt: " << ex.what();
+            race->pending--;
+            race->completed[i] = true;
+        }
+    }
+
+    // Returns as soon as one reader is connected, attempts still connecting lose once they return
+    std::unique_lock<std::mutex> lock(race->mutex);
+    race->cv.wait_until(lock, end, [&race] { return race->winner >= 0 || race->pending == 0; });
+    race->finished = true;
+
+    for (size_t i = 0; i < race_size; i++) {
+        const std::string host_string = racing_hosts[i].GetHost();
+        remove_candidate(host_string, remaining_readers);
+        if (race->completed[i] && race->connected[i] && !race->is_reader[i] && static_cast<int>(i) != race->winner) {
+            // Candidate is actually a writer, do not retry it as a reader in later iterations
+            remove_candidate(host_string, reader_candidates);
+        }
+    }
+
+    if (race->winner < 0) {
+        LOG(INFO) << "[Failover Service] unable to connect to any of the racing readers for: " << cluster_id_;
+        return false;
+    }
+
+    const HostInfo& winner = racing_hosts[race->winner];
+    LOG(INFO) << "[Failover Service] connected to a new reader for: " << winner.GetHost();
+    odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+    hdbc = race->winner_hdbc;
+    curr_host_ = winner;
+    return true;
+}
+
 bool FailoverService::connect_to_host(SQLHDBC hdbc, const std::string& host_string) {
     LOG(INFO) << "Attempting to connect to host: " << host_string;
-    conn_info_->insert_or_assign(SERVER_HOST_KEY, StringHelper::ToSQLSTR(host_string));
-    SQLSTR conn_str = ConnectionStringHelper::BuildConnectionString(*conn_info_);
+    SQLSTR conn_str = get_conn_str_for_host(host_string);
 
     return odbc_helper_->ConnStrConnect(AS_SQLTCHAR(conn_str.c_str()), hdbc);
 }
 
+SQLSTR FailoverService::get_conn_str_for_host(const std::string& host_string) {
+    return conn_template_.ForHost(StringHelper::ToSQLSTR(host_string));
+}
+
 bool FailoverService::is_connected_to_reader(SQLHDBC hdbc) {
+    return is_connected_to_reader(odbc_helper_, dialect_, hdbc);
+}
+
+bool FailoverService::is_connected_to_reader(const std::shared_ptr<IOdbcHelper>& odbc_helper,
+                                             const std::shared_ptr<Dialect>& dialect, SQLHDBC hdbc) {
     if (SQL_NULL_HDBC == hdbc) {
         LOG(WARNING) << "[Failover Service] null HDBC passed to reader check.";
         return false;
@@ -360,11 +674,11 @@ bool FailoverService::is_connected_to_reader(SQLHDBC hdbc) {
     SQLHSTMT stmt = SQL_NULL_HANDLE;
     bool is_reader = false;
 
-    if (!odbc_helper_->AllocateHandle(SQL_HANDLE_STMT, hdbc, stmt, "[Failover Service] reader check failed to allocate handle")) {
+    if (!odbc_helper->AllocateHandle(SQL_HANDLE_STMT, hdbc, stmt, "[Failover Service] reader check failed to allocate handle")) {
         return false;
     }
 
-    if (!odbc_helper_->ExecuteQuery(stmt, AS_SQLTCHAR(dialect_->GetIsReaderQuery().c_str()),
+    if (!odbc_helper->ExecuteQuery(stmt, AS_SQLTCHAR(dialect->GetIsReaderQuery().c_str()),
                                   "[Failover Service] reader check failed to execute topology query")) {
         return false;
     }
@@ -376,7 +690,7 @@ bool FailoverService::is_connected_to_reader(SQLHDBC hdbc) {
         return false;
     }
 
-    if (!odbc_helper_->FetchResults(stmt, "[Failover Service] failed to fetch if is_reader from results")) {
+    if (!odbc_helper->FetchResults(stmt, "[Failover Service] failed to fetch if is_reader from results")) {
         return false;
     }
 
@@ -413,6 +727,10 @@ bool FailoverService::is_connected_to_writer(SQLHDBC hdbc) {
 }
 
 bool StartFailoverService(char* service_id_c_str, DatabaseDialect dialect, const SQLTCHAR* conn_cstr) {
+    return StartFailoverServiceWithEnv(service_id_c_str, dialect, conn_cstr, SQL_NULL_HENV);
+}
+
+bool StartFailoverServiceWithEnv(char* service_id_c_str, DatabaseDialect dialect, const SQLTCHAR* conn_cstr, SQLHENV henv) {
     std::string cluster_id(service_id_c_str);
     std::shared_ptr<Dialect> dialect_obj;
     switch (dialect) {
@@ -451,6 +769,11 @@ bool StartFailoverService(char* service_id_c_str, DatabaseDialect dialect, const
         strncpy(service_id_c_str, cluster_id.c_str(), MAX_CLUSTER_ID_LEN);
     }
 
+    // Standby connections opened or closed by the service's own pool do not count toward it
+    if (StandbyReferenceScope::Record(cluster_id, 1)) {
+        return true;
+    }
+
     std::shared_ptr<FailoverServiceTracker> tracker;
     try {
         uint32_t ignore_topology_request_ms = parse_num(conn_info[IGNORE_TOPOLOGY_REQUEST_KEY], FailoverService::DEFAULT_IGNORE_TOPOLOGY_REQUEST_MS);
@@ -458,6 +781,13 @@ bool StartFailoverService(char* service_id_c_str, DatabaseDialect dialect, const
 
         uint32_t refresh_rate_ms = parse_num(conn_info[REFRESH_RATE_KEY], FailoverService::DEFAULT_REFRESH_RATE_MS);
 
+        // Node probing is shared across all clusters in the process
+        NodeProbeExecutor::Configure(
+            parse_num(conn_info[NODE_PROBE_POOL_SIZE_KEY], NodeProbeExecutor::DEFAULT_POOL_SIZE),
+            parse_num(conn_info[NODE_PROBE_MAX_PROBES_KEY], NodeProbeExecutor::DEFAULT_MAX_PROBES));
+        // Topology and standby refreshes connect on the shared refresh workers, keep enough idle ones for the clusters in use
+        RefreshScheduler::Configure(parse_num(conn_info[REFRESH_POOL_SIZE_KEY], RefreshScheduler::DEFAULT_POOL_SIZE));
+
         if (!FailoverServiceTrackerHandler::Contains(cluster_id)) {
             tracker = std::make_shared<FailoverServiceTracker>();
             tracker->reference_count = 1;
@@ -469,7 +799,7 @@ bool StartFailoverService(char* service_id_c_str, DatabaseDialect dialect, const
                                                                  dialect_obj->GetTopologyQuery(), dialect_obj->GetWriterIdQuery(),
                                                                  dialect_obj->GetNodeIdQuery()),
                     ignore_topology_request_ms, high_refresh_rate_ms, refresh_rate_ms),
-                std::make_shared<OdbcHelperWrapper>());
+                std::make_shared<OdbcHelperWrapper>(), henv);
 
             // Check again to see if the other thread has set service tracker for cluster id
             // If still empty, put new tracker. Let tracker descope and free itself otherwise
@@ -486,6 +816,9 @@ bool StartFailoverService(char* service_id_c_str, DatabaseDialect dialect, const
 
 void StopFailoverService(const char* service_id_c_str) {
     std::string cluster_id(service_id_c_str);
+    if (StandbyReferenceScope::Record(cluster_id, -1)) {
+        return;
+    }
     if (!FailoverServiceTrackerHandler::Contains(cluster_id)) {
         LOG(INFO) << "[Failover Service] not found for: " << cluster_id;
         return;
@@ -510,7 +843,7 @@ FailoverResult FailoverConnection(const char* service_id_c_str, const char* sql_
     SQLHDBC local_hdbc = SQL_NULL_HDBC;
     // open a new connection
     SQLAllocHandle(SQL_HANDLE_DBC, henv, &local_hdbc);
-    FailoverStatus status = tracker->service->Failover(local_hdbc, sql_state);
+    FailoverStatus status = tracker->service->Failover(local_hdbc, sql_state, henv);
     tracker->failover_inprogress.fetch_sub(1);
     if (FAILOVER_SUCCEED != status) {
         OdbcHelper::Cleanup(SQL_NULL_HENV, local_hdbc, SQL_NULL_HSTMT);
@@ -518,3 +851,29 @@ FailoverResult FailoverConnection(const char* service_id_c_str, const char* sql_
     }
     return FailoverResult{ .status = status, .hdbc = local_hdbc };
 }
+
+SQLHDBC AcquirePooledConnection(const char* service_id_c_str, SQLHENV henv, bool writer) {
+    std::string cluster_id(service_id_c_str);
+    if (!FailoverServiceTrackerHandler::Contains(cluster_id)) {
+        LOG(INFO) << "[Failover Service] no tracker found for: " << cluster_id << ". Cannot acquire pooled connection.";
+        return SQL_NULL_HDBC;
+    }
+    std::shared_ptr<FailoverService> service = FailoverServiceTrackerHandler::Get(cluster_id)->service;
+    if (nullptr == service) {
+        LOG(INFO) << "[Failover Service] no active Failover Service: " << cluster_id << ". Cannot acquire pooled connection.";
+        return SQL_NULL_HDBC;
+    }
+    return service->AcquireConnection(henv, writer);
+}
+
+void ReleasePooledConnection(const char* service_id_c_str, SQLHDBC hdbc) {
+    std::string cluster_id(service_id_c_str);
+    std::shared_ptr<FailoverService> service = FailoverServiceTrackerHandler::Contains(cluster_id) ?
+        FailoverServiceTrackerHandler::Get(cluster_id)->service : nullptr;
+    if (nullptr == service) {
+        // Pool is gone with its service, nothing to return the connection to
+        OdbcHelper::Cleanup(SQL_NULL_HENV, hdbc, SQL_NULL_HSTMT);
+        return;
+    }
+    service->ReleaseConnection(hdbc);
+}
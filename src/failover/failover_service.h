@@ -18,15 +18,21 @@
 #ifdef __cplusplus
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "../dialect/dialect.h"
 #include "../host_selector/host_selector.h"
+#include "../util/connection_string_helper.h"
 #include "../util/odbc_helper.h"
 #include "../util/sliding_cache_map.h"
 #include "../util/string_helper.h"
 #include "cluster_topology_monitor.h"
+#include "connection_pool.h"
+#include "standby_connection_pool.h"
 
 
 #define BUFFER_SIZE 1024
@@ -106,6 +112,18 @@ typedef struct {
  */
 bool StartFailoverService(char* service_id_c_str, DatabaseDialect dialect, const SQLTCHAR* conn_cstr);
 
+/**
+ * Same as StartFailoverService, and keeps standby connections on the caller's SQL HENV when the service is started.
+ * 
+ * @param service_id_c_str an identifier used to track the reference count of the failover service
+ * @param dialect enum value for different database dialects for queries and default ports
+ * @param conn_cstr connection string to specifiy the settings
+ * @param henv the caller's SQL HENV. Standby connections are allocated on it and handed over only to failovers on the same HENV,
+ *             so it must stay allocated until the service is stopped. SQL_NULL_HENV disables standby connections.
+ * @return true if a service is either incremented or started
+ */
+bool StartFailoverServiceWithEnv(char* service_id_c_str, DatabaseDialect dialect, const SQLTCHAR* conn_cstr, SQLHENV henv);
+
 /**
  * Decrements the reference count a Failover Service for a given cluster/service ID.
  * If the reference count drops below 0 and is not currently undergoing failover,
@@ -124,9 +142,30 @@ void StopFailoverService(const char* service_id_c_str);
  * @param sql_state the SQL State of the connection
  * @param henv an already allocated SQL HENV
  * @return a FailoverResult object indicating whether the connection has been established, and if so the new connection.
+ *         When readers are raced, the new connection is allocated on an environment owned by the Failover Service.
  */
 FailoverResult FailoverConnection(const char* service_id_c_str, const char* sql_state, SQLHENV henv);
 
+/**
+ * Takes an idle connection from the Failover Service's connection pool, or opens a new one.
+ * Pooled connections are opened with cluster failover disabled, callers use FailoverConnection on communication errors.
+ * 
+ * @param service_id_c_str an identifier used to track the reference count of the failover service
+ * @param henv an already allocated SQL HENV. Only idle connections allocated on it are reused, new connections are opened on it
+ * @param writer whether a connection to the writer or to a reader is required
+ * @return a connected HDBC, or SQL_NULL_HDBC if no connection could be established
+ */
+SQLHDBC AcquirePooledConnection(const char* service_id_c_str, SQLHENV henv, bool writer);
+
+/**
+ * Returns a connection from AcquirePooledConnection to the Failover Service's connection pool.
+ * The connection must not have an open transaction. It is freed if it cannot be pooled.
+ * 
+ * @param service_id_c_str an identifier used to track the reference count of the failover service
+ * @param hdbc the connection to return
+ */
+void ReleasePooledConnection(const char* service_id_c_str, SQLHDBC hdbc);
+
 #ifdef __cplusplus
 }
 
@@ -136,40 +175,79 @@ public:
     static const uint32_t DEFAULT_HIGH_REFRESH_RATE_MS;
     static const uint32_t DEFAULT_REFRESH_RATE_MS;
     static const uint32_t DEFAULT_FAILOVER_TIMEOUT_MS;
+    static const uint32_t DEFAULT_READER_FANOUT;
+    static const uint32_t DEFAULT_STANDBY_CONNECTIONS;
+    static const uint32_t DEFAULT_POOL_IDLE_TTL_SEC;
+    static const uint32_t DEFAULT_POOL_MAX_IDLE;
 
     FailoverService(const std::string& host, const std::string& cluster_id, std::shared_ptr<Dialect> dialect,
         std::shared_ptr<std::map<SQLSTR, SQLSTR>> conn_info,
         std::shared_ptr<SlidingCacheMap<std::string, std::vector<HostInfo>>> topology_map,
         const std::shared_ptr<ClusterTopologyMonitor>& topology_monitor,
-        const std::shared_ptr<IOdbcHelper>& odbc_helper);
+        const std::shared_ptr<IOdbcHelper>& odbc_helper, SQLHENV henv = SQL_NULL_HENV);
     ~FailoverService();
 
-    FailoverStatus Failover(SQLHDBC hdbc, const char* sql_state);
+    /**
+     * Attempts to re-establish the connection after a communication error.
+     * When reader fan-out is enabled, reader candidates are connected in parallel on new handles of the service's
+     * own environment. The winning handle then replaces, and frees, the given HDBC.
+     */
+    FailoverStatus Failover(SQLHDBC& hdbc, const char* sql_state, SQLHENV henv = SQL_NULL_HENV);
     HostInfo GetCurrentHost();
+    SQLHDBC AcquireConnection(SQLHENV henv, bool writer);
+    void ReleaseConnection(SQLHDBC hdbc);
 
 private:
     static const int MAX_STATE_LENGTH = 32;
     static const int MAX_MSG_LENGTH = 1024;
     static bool check_should_failover(const char* sql_state);
     static void remove_candidate(const std::string& host, std::vector<HostInfo>& candidates);
-    bool failover_reader(SQLHDBC hdbc);
+    static bool is_connected_to_reader(const std::shared_ptr<IOdbcHelper>& odbc_helper,
+        const std::shared_ptr<Dialect>& dialect, SQLHDBC hdbc);
+    bool failover_reader(SQLHDBC& hdbc);
     bool failover_writer(SQLHDBC hdbc);
+    bool failover_to_standby(SQLHDBC& hdbc);
+    bool connect_to_any_reader(SQLHDBC& hdbc, std::vector<HostInfo>& remaining_readers,
+        std::vector<HostInfo>& reader_candidates, std::unordered_map<std::string, std::string>& properties,
+        std::chrono::steady_clock::time_point end);
     bool connect_to_host(SQLHDBC hdbc, const std::string& host_string);
+    SQLSTR get_conn_str_for_host(const std::string& host_string);
     bool is_connected_to_reader(SQLHDBC hdbc);
     bool is_connected_to_writer(SQLHDBC hdbc);
     void init_failover_mode(const std::string& host);
+    std::shared_ptr<const TopologySnapshot> get_topology();
+    std::shared_ptr<const TopologySnapshot> get_verified_topology();
     std::shared_ptr<HostSelector> get_reader_host_selector() const;
+    std::shared_ptr<ConnectionPool> get_connection_pool();
 
     HostInfo curr_host_;
     std::string cluster_id_;
     std::shared_ptr<Dialect> dialect_;
     std::shared_ptr<std::map<SQLSTR, SQLSTR>> conn_info_;
+    ConnectionStringTemplate conn_template_;
     std::shared_ptr<HostSelector> host_selector_;
     std::shared_ptr<SlidingCacheMap<std::string, std::vector<HostInfo>>> topology_map_;
     std::shared_ptr<ClusterTopologyMonitor> topology_monitor_;
     std::shared_ptr<IOdbcHelper> odbc_helper_;
+    std::shared_ptr<StandbyConnectionPool> standby_pool_;
+    std::shared_ptr<ConnectionPool> connection_pool_;
+    std::mutex connection_pool_mutex_;
+    uint64_t standby_subscription_id_ = 0;
+    uint64_t connection_pool_subscription_id_ = 0;
     FailoverMode failover_mode_ = UNKNOWN_FAILOVER_MODE;
     uint32_t failover_timeout_;
+    uint32_t reader_fanout_;
+
+    // Environment racing reader attempts connect on, shared with the attempts still in flight
+    struct RaceEnvironment;
+    std::shared_ptr<RaceEnvironment> race_env_;
+
+    // Writer verification shared by concurrent failovers, only the first caller resets the monitor connection
+    std::mutex writer_verification_mutex_;
+    std::condition_variable writer_verification_cv_;
+    bool writer_verification_in_flight_ = false;
+    uint64_t writer_verifications_completed_ = 0;
+    std::shared_ptr<const TopologySnapshot> writer_verification_result_;
 };
 
 typedef struct FailoverServiceTracker {
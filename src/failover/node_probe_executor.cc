@@ -0,0 +1,162 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "node_probe_executor.h"
+
+#include <ctpl_stl.h>
+
+#include <glog/logging.h>
+
+#include <system_error>
+#include <thread>
+
+const uint32_t NodeProbeExecutor::DEFAULT_POOL_SIZE = 8;
+const uint32_t NodeProbeExecutor::DEFAULT_MAX_PROBES = 256;
+
+std::mutex NodeProbeExecutor::pool_mutex;
+std::shared_ptr<ctpl::thread_pool> NodeProbeExecutor::pool;
+uint32_t NodeProbeExecutor::pool_size = NodeProbeExecutor::DEFAULT_POOL_SIZE;
+std::atomic<uint32_t> NodeProbeExecutor::max_probes = NodeProbeExecutor::DEFAULT_MAX_PROBES;
+std::atomic<uint32_t> NodeProbeExecutor::active_probes = 0;
+
+void NodeProbeExecutor::Configure(uint32_t new_pool_size, uint32_t new_max_probes) {
+    std::lock_guard lock(pool_mutex);
+    if (new_pool_size > pool_size) {
+        LOG(INFO) << "[Node Probe Executor] growing worker pool from " << pool_size << " to " << new_pool_size;
+        pool_size = new_pool_size;
+        if (pool) {
+            pool->resize(static_cast<int>(pool_size));
+        }
+    }
+    uint32_t curr_max_probes = max_probes.load();
+    while (new_max_probes > curr_max_probes && !max_probes.compare_exchange_weak(curr_max_probes, new_max_probes)) {
+        // Retry with the latest limit
+    }
+}
+
+bool NodeProbeExecutor::TryAcquire() {
+    uint32_t curr = active_probes.load();
+    do {
+        if (curr >= max_probes.load()) {
+            LOG(WARNING) << "[Node Probe Executor] probe limit of " << max_probes.load() << " reached, deferring node probe";
+            return false;
+        }
+    } while (!active_probes.compare_exchange_weak(curr, curr + 1));
+    return true;
+}
+
+void NodeProbeExecutor::Release() {
+    uint32_t curr = active_probes.load();
+    while (curr > 0 && !active_probes.compare_exchange_weak(curr, curr - 1)) {
+        // Retry with the latest count
+    }
+}
+
+bool NodeProbeExecutor::Submit(const std::function<void()>& task) {
+    std::shared_ptr<ctpl::thread_pool> workers = get_pool();
+    try {
+        workers->push([task](int) { task(); });
+    } catch (const std::exception& ex) {
+        LOG(ERROR) << "[Node Probe Executor] unable to queue node probe: " << ex.what();
+        return false;
+    }
+    return true;
+}
+
+uint64_t NodeProbeExecutor::SubmitAfter(const std::function<void()>& task, std::chrono::milliseconds delay) {
+    DelayedTasks& d = delayed_tasks();
+    std::lock_guard lock(d.mutex);
+    if (!d.timer_started) {
+        try {
+            // Lives as long as the process
+            std::thread(&NodeProbeExecutor::run_timer).detach();
+        } catch (const std::system_error& ex) {
+            LOG(ERROR) << "[Node Probe Executor] unable to start the probe timer: " << ex.what();
+            return 0;
+        }
+        d.timer_started = true;
+    }
+
+    uint64_t task_id = d.next_task_id++;
+    d.tasks[task_id] = task;
+    d.timers.emplace(Clock::now() + delay, task_id);
+    d.cv.notify_one();
+    return task_id;
+}
+
+bool NodeProbeExecutor::Cancel(uint64_t task_id) {
+    DelayedTasks& d = delayed_tasks();
+    std::lock_guard lock(d.mutex);
+    if (0 == d.tasks.erase(task_id)) {
+        return false;
+    }
+    std::erase_if(d.timers, [task_id](const std::pair<Clock::time_point, uint64_t>& timer) {
+        return timer.second == task_id;
+    });
+    return true;
+}
+
+uint32_t NodeProbeExecutor::GetPoolSize() {
+    std::lock_guard lock(pool_mutex);
+    return pool_size;
+}
+
+uint32_t NodeProbeExecutor::GetMaxProbes() {
+    return max_probes.load();
+}
+
+uint32_t NodeProbeExecutor::GetActiveProbes() {
+    return active_probes.load();
+}
+
+std::shared_ptr<ctpl::thread_pool> NodeProbeExecutor::get_pool() {
+    std::lock_guard lock(pool_mutex);
+    if (!pool) {
+        // Lazily created so processes that never enter panic mode do not pay for idle workers
+        pool = std::make_shared<ctpl::thread_pool>(static_cast<int>(pool_size));
+    }
+    return pool;
+}
+
+NodeProbeExecutor::DelayedTasks& NodeProbeExecutor::delayed_tasks() {
+    // Never destroyed, the timer thread is never joined
+    static DelayedTasks* d = new DelayedTasks();
+    return *d;
+}
+
+void NodeProbeExecutor::run_timer() {
+    DelayedTasks& d = delayed_tasks();
+    std::unique_lock lock(d.mutex);
+    while (true) {
+        if (d.timers.empty()) {
+            d.cv.wait(lock);
+            continue;
+        }
+        auto [due, task_id] = *d.timers.begin();
+        if (Clock::now() < due) {
+            d.cv.wait_until(lock, due);
+            continue;
+        }
+        d.timers.erase(d.timers.begin());
+        std::function<void()> task = std::move(d.tasks[task_id]);
+        d.tasks.erase(task_id);
+        lock.unlock();
+
+        if (!Submit(task)) {
+            // Tasks rely on running once they are due, run it here rather than drop it
+            task();
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,105 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NODE_PROBE_EXECUTOR_H
+#define NODE_PROBE_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace ctpl {
+    class thread_pool;
+}
+
+/**
+ * Process-wide worker pool shared by every ClusterTopologyMonitor for node probing.
+ *
+ * Rather than one OS thread per host per cluster, node monitors are admitted as probe tasks
+ * and executed on a fixed number of worker threads. Both the number of workers and the number
+ * of admitted probes are bounded, regardless of how many clusters enter panic mode at once.
+ */
+class NodeProbeExecutor {
+public:
+    static const uint32_t DEFAULT_POOL_SIZE;
+    static const uint32_t DEFAULT_MAX_PROBES;
+
+    /**
+     * Grows the worker pool and probe limit to at least the given sizes.
+     * The pool never shrinks, as other clusters may still depend on the capacity they requested.
+     */
+    static void Configure(uint32_t pool_size, uint32_t max_probes);
+
+    /**
+     * Reserves a probe slot. Returns false if the process-wide probe limit has been reached.
+     * Every successful call must be paired with a call to Release.
+     */
+    static bool TryAcquire();
+    static void Release();
+
+    /**
+     * Queues a task on the shared worker pool. Returns false if the task could not be queued.
+     */
+    static bool Submit(const std::function<void()>& task);
+
+    /**
+     * Queues a task on the shared worker pool once the delay has passed. The delay is kept by the executor's
+     * own timer thread, so a node waiting for its next probe does not hold a worker.
+     *
+     * @return the ID used to cancel the task, 0 if it could not be scheduled
+     */
+    static uint64_t SubmitAfter(const std::function<void()>& task, std::chrono::milliseconds delay);
+
+    /**
+     * Removes a task scheduled with SubmitAfter. Returns false if it was already queued on the workers.
+     */
+    static bool Cancel(uint64_t task_id);
+
+    static uint32_t GetPoolSize();
+    static uint32_t GetMaxProbes();
+    static uint32_t GetActiveProbes();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct DelayedTasks {
+        std::mutex mutex;
+        // Wakes the timer thread when a task is due earlier than the one it waits for
+        std::condition_variable cv;
+        std::map<uint64_t, std::function<void()>> tasks;
+        // Task IDs by due time
+        std::set<std::pair<Clock::time_point, uint64_t>> timers;
+        bool timer_started = false;
+        uint64_t next_task_id = 1;
+    };
+
+    static std::shared_ptr<ctpl::thread_pool> get_pool();
+    static DelayedTasks& delayed_tasks();
+    static void run_timer();
+
+    static std::mutex pool_mutex;
+    static std::shared_ptr<ctpl::thread_pool> pool;
+    static uint32_t pool_size;
+    static std::atomic<uint32_t> max_probes;
+    static std::atomic<uint32_t> active_probes;
+};
+
+#endif // NODE_PROBE_EXECUTOR_H
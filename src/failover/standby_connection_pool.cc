@@ -0,0 +1,279 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "standby_connection_pool.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "../util/connection_string_helper.h"
+#include "../util/connection_string_keys.h"
+#include "../util/refresh_scheduler.h"
+
+thread_local StandbyReferenceScope* StandbyReferenceScope::current_ = nullptr;
+
+StandbyReferenceScope::StandbyReferenceScope(const std::string& cluster_id)
+    : cluster_id_{ cluster_id }, previous_{ current_ } {
+    current_ = this;
+}
+
+StandbyReferenceScope::~StandbyReferenceScope() {
+    current_ = previous_;
+}
+
+bool StandbyReferenceScope::Record(const std::string& cluster_id, int references) {
+    if (!current_ || current_->cluster_id_ != cluster_id) {
+        return false;
+    }
+    current_->references_ += references;
+    return true;
+}
+
+int StandbyReferenceScope::GetReferences() const {
+    return references_;
+}
+
+const uint32_t StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::seconds(5)).count();
+
+StandbyConnectionPool::StandbyConnectionPool(
+        const std::string& cluster_id,
+        const std::map<SQLSTR, SQLSTR>& conn_info,
+        const std::shared_ptr<ClusterTopologyMonitor>& topology_monitor,
+        const std::shared_ptr<IOdbcHelper>& odbc_helper,
+        SQLHENV henv,
+        uint32_t max_connections,
+        uint32_t refresh_rate_ms):
+        cluster_id_{ cluster_id },
+        conn_info_{ conn_info },
+        topology_monitor_{ topology_monitor },
+        odbc_helper_{ odbc_helper },
+        henv_{ henv },
+        max_connections_{ max_connections },
+        refresh_rate_ms_{ refresh_rate_ms } {
+    // Standby connections are handed over as failed over sessions, so they keep failover enabled
+    conn_template_ = ConnectionStringTemplate(ConnectionStringHelper::BuildConnectionString(conn_info_),
+        { { ENABLE_FAILOVER_KEY, BOOL_TRUE } }, true);
+}
+
+StandbyConnectionPool::~StandbyConnectionPool() {
+    Stop();
+
+    std::vector<StandbyConnection> connections;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections.swap(connections_);
+    }
+    for (const StandbyConnection& connection : connections) {
+        close(connection.hdbc);
+    }
+}
+
+void StandbyConnectionPool::Start() {
+    if (0 == refresh_task_id_.load()) {
+        LOG(INFO) << "[Standby Pool] started for: " << cluster_id_;
+        refresh_task_id_.store(RefreshScheduler::Schedule([this] { return run(); }, std::chrono::milliseconds(0)));
+    }
+}
+
+void StandbyConnectionPool::Stop() {
+    uint64_t refresh_task_id = refresh_task_id_.exchange(0);
+    if (refresh_task_id > 0) {
+        // Waits for a refresh in progress
+        RefreshScheduler::Cancel(refresh_task_id);
+        LOG(INFO) << "[Standby Pool] stopped for: " << cluster_id_;
+    }
+}
+
+void StandbyConnectionPool::RequestRefresh() {
+    // Kept until the next refresh starts, a wake has no effect while a refresh is running
+    refresh_requested_.store(true);
+    RefreshScheduler::Wake(refresh_task_id_.load());
+}
+
+void StandbyConnectionPool::Refresh(const std::vector<HostInfo>& hosts) {
+    std::vector<HostInfo> targets = select_targets(hosts);
+
+    // Unwanted connections leave the pool right away, the others stay available to Take while they are probed
+    std::vector<SQLHDBC> dropped;
+    std::vector<std::string> kept_hosts;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        std::vector<StandbyConnection> kept;
+        for (const StandbyConnection& connection : connections_) {
+            bool wanted = std::any_of(targets.begin(), targets.end(), [&connection](const HostInfo& target) {
+                return target.GetHost() == connection.host.GetHost() && target.IsHostWriter() == connection.host.IsHostWriter();
+            });
+            bool duplicate = std::find(kept_hosts.begin(), kept_hosts.end(), connection.host.GetHost()) != kept_hosts.end();
+            if (wanted && !duplicate) {
+                kept.push_back(connection);
+                kept_hosts.push_back(connection.host.GetHost());
+            } else {
+                DLOG(INFO) << "[Standby Pool] dropping standby connection to: " << connection.host.GetHost();
+                dropped.push_back(connection.hdbc);
+            }
+        }
+        connections_.swap(kept);
+    }
+    for (SQLHDBC hdbc : dropped) {
+        close(hdbc);
+    }
+
+    // Probe outside of the lock, so failover is never blocked behind a dead host
+    for (const std::string& host : kept_hosts) {
+        probe(host);
+    }
+
+    if (SQL_NULL_HENV == henv_) {
+        return;
+    }
+    for (const HostInfo& target : targets) {
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            bool connected = std::any_of(connections_.begin(), connections_.end(), [&target](const StandbyConnection& connection) {
+                return connection.host.GetHost() == target.GetHost();
+            });
+            if (connected) {
+                continue;
+            }
+        }
+
+        SQLHDBC hdbc = SQL_NULL_HDBC;
+        if (!odbc_helper_->AllocateHandle(SQL_HANDLE_DBC, henv_, hdbc, "[Standby Pool] unable to allocate connection handle")) {
+            continue;
+        }
+        SQLSTR conn_str = get_conn_str_for_host(target.GetHost());
+        StandbyReferenceScope scope(cluster_id_);
+        if (!odbc_helper_->ConnStrConnect(AS_SQLTCHAR(conn_str.c_str()), hdbc)) {
+            odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+            continue;
+        }
+        DLOG(INFO) << "[Standby Pool] opened standby connection to: " << target.GetHost();
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.push_back(StandbyConnection{ target, hdbc, false, scope.GetReferences() });
+    }
+}
+
+bool StandbyConnectionPool::Take(bool prefer_writer, SQLHDBC& hdbc, HostInfo& host, int& references) {
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        // A connection that is being probed is not handed over until its probe completes
+        auto itr = std::find_if(connections_.begin(), connections_.end(), [prefer_writer](const StandbyConnection& connection) {
+            return !connection.probing && connection.host.IsHostWriter() == prefer_writer;
+        });
+        if (itr == connections_.end()) {
+            itr = std::find_if(connections_.begin(), connections_.end(), [](const StandbyConnection& connection) {
+                return !connection.probing;
+            });
+        }
+        if (itr == connections_.end()) {
+            return false;
+        }
+        hdbc = itr->hdbc;
+        host = itr->host;
+        references = itr->references;
+        connections_.erase(itr);
+    }
+
+    // Replace the connection that was handed over
+    RequestRefresh();
+    return true;
+}
+
+size_t StandbyConnectionPool::Size() {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    return connections_.size();
+}
+
+SQLHENV StandbyConnectionPool::GetEnvironment() const {
+    return henv_;
+}
+
+std::chrono::milliseconds StandbyConnectionPool::run() {
+    refresh_requested_.store(false);
+    std::shared_ptr<const TopologySnapshot> topology = topology_monitor_->GetTopologySnapshot();
+    if (topology) {
+        Refresh(topology->hosts);
+    }
+    return refresh_requested_.load() ? std::chrono::milliseconds(0) : std::chrono::milliseconds(refresh_rate_ms_);
+}
+
+void StandbyConnectionPool::probe(const std::string& host) {
+    auto find = [this, &host](bool probing) {
+        return std::find_if(connections_.begin(), connections_.end(), [&host, probing](const StandbyConnection& connection) {
+            return connection.host.GetHost() == host && connection.probing == probing;
+        });
+    };
+
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        auto itr = find(false);
+        if (itr == connections_.end()) {
+            // Handed over while earlier connections were probed
+            return;
+        }
+        itr->probing = true;
+        hdbc = itr->hdbc;
+    }
+
+    bool alive = odbc_helper_->CheckConnection(hdbc);
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        auto itr = find(true);
+        if (alive) {
+            itr->probing = false;
+            return;
+        }
+        connections_.erase(itr);
+    }
+    DLOG(INFO) << "[Standby Pool] dropping standby connection to: " << host;
+    close(hdbc);
+}
+
+void StandbyConnectionPool::close(SQLHDBC hdbc) {
+    // The references the driver took for the connection were never counted, neither is their release
+    StandbyReferenceScope scope(cluster_id_);
+    odbc_helper_->Cleanup(SQL_NULL_HANDLE, hdbc, SQL_NULL_HANDLE);
+}
+
+std::vector<HostInfo> StandbyConnectionPool::select_targets(const std::vector<HostInfo>& hosts) const {
+    std::vector<HostInfo> targets;
+    std::vector<HostInfo> readers;
+    for (const HostInfo& host : hosts) {
+        if (!host.IsHostUp()) {
+            continue;
+        }
+        if (host.IsHostWriter()) {
+            targets.push_back(host);
+        } else {
+            readers.push_back(host);
+        }
+    }
+
+    // Writer first, then the highest weighted readers
+    std::stable_sort(readers.begin(), readers.end(), [](const HostInfo& a, const HostInfo& b) {
+        return a.GetWeight() > b.GetWeight();
+    });
+    targets.insert(targets.end(), readers.begin(), readers.end());
+    if (targets.size() > max_connections_) {
+        targets.resize(max_connections_);
+    }
+    return targets;
+}
+
+SQLSTR StandbyConnectionPool::get_conn_str_for_host(const std::string& host) const {
+    return conn_template_.ForHost(StringHelper::ToSQLSTR(host));
+}
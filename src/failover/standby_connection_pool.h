@@ -0,0 +1,136 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef STANDBY_CONNECTION_POOL_H
+#define STANDBY_CONNECTION_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ODBC APIs
+#ifdef WIN32
+    #include <windows.h>
+#endif
+#include <sql.h>
+#include <sqltypes.h>
+
+#include "../host_info.h"
+#include "../util/connection_string_helper.h"
+#include "../util/odbc_helper.h"
+#include "../util/string_helper.h"
+#include "cluster_topology_monitor.h"
+
+/**
+ * Collects the Failover Service references the driver takes or releases on the current thread while the pool
+ * opens or closes a standby connection, so connections waiting in the pool never count toward the service.
+ * The references taken for a connection are only counted once it is handed over.
+ */
+class StandbyReferenceScope {
+public:
+    explicit StandbyReferenceScope(const std::string& cluster_id);
+    ~StandbyReferenceScope();
+
+    /**
+     * Records a reference taken (1) or released (-1) for the cluster in the scope active on this thread.
+     * Returns false if there is no such scope, the reference is then counted as usual.
+     */
+    static bool Record(const std::string& cluster_id, int references);
+    int GetReferences() const;
+
+private:
+    std::string cluster_id_;
+    int references_ = 0;
+    StandbyReferenceScope* previous_;
+    static thread_local StandbyReferenceScope* current_;
+};
+
+/**
+ * Keeps a small number of already established connections to the current writer and the
+ * highest weighted readers of a cluster, so failover can hand over a connection
+ * after a single role check instead of opening a new one.
+ * Refreshes run on the shared RefreshScheduler.
+ */
+class StandbyConnectionPool {
+public:
+    static const uint32_t DEFAULT_REFRESH_RATE_MS;
+
+    StandbyConnectionPool(const std::string& cluster_id, const std::map<SQLSTR, SQLSTR>& conn_info,
+        const std::shared_ptr<ClusterTopologyMonitor>& topology_monitor, const std::shared_ptr<IOdbcHelper>& odbc_helper,
+        SQLHENV henv, uint32_t max_connections, uint32_t refresh_rate_ms);
+    ~StandbyConnectionPool();
+
+    void Start();
+    void Stop();
+
+    /**
+     * Refreshes before the next scheduled refresh.
+     */
+    void RequestRefresh();
+
+    /**
+     * Drops standby connections that are no longer wanted or no longer alive, then connects
+     * to any wanted host without a standby connection.
+     */
+    void Refresh(const std::vector<HostInfo>& hosts);
+
+    /**
+     * Removes a standby connection from the pool, preferring one with the given role.
+     * Ownership of the returned HDBC moves to the caller, along with the service references
+     * the driver took while the pool connected it.
+     */
+    bool Take(bool prefer_writer, SQLHDBC& hdbc, HostInfo& host, int& references);
+    size_t Size();
+
+    /**
+     * Environment the standby connections are allocated on.
+     */
+    SQLHENV GetEnvironment() const;
+
+private:
+    struct StandbyConnection {
+        HostInfo host;
+        SQLHDBC hdbc;
+        bool probing;
+        int references;
+    };
+
+    std::chrono::milliseconds run();
+    void probe(const std::string& host);
+    void close(SQLHDBC hdbc);
+    std::vector<HostInfo> select_targets(const std::vector<HostInfo>& hosts) const;
+    SQLSTR get_conn_str_for_host(const std::string& host) const;
+
+    std::string cluster_id_;
+    std::map<SQLSTR, SQLSTR> conn_info_;
+    ConnectionStringTemplate conn_template_;
+    std::shared_ptr<ClusterTopologyMonitor> topology_monitor_;
+    std::shared_ptr<IOdbcHelper> odbc_helper_;
+    SQLHENV henv_;
+    uint32_t max_connections_;
+    uint32_t refresh_rate_ms_;
+
+    std::vector<StandbyConnection> connections_;
+    std::mutex connections_mutex_;
+
+    // Refresh task on the shared RefreshScheduler, 0 while not started
+    std::atomic<uint64_t> refresh_task_id_ = 0;
+    std::atomic<bool> refresh_requested_ = false;
+};
+
+#endif // STANDBY_CONNECTION_POOL_H
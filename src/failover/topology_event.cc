@@ -0,0 +1,50 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "topology_event.h"
+
+#include <algorithm>
+
+std::vector<TopologyEvent> TopologyEvent::Diff(const std::vector<HostInfo>& previous, const std::vector<HostInfo>& current) {
+    std::vector<TopologyEvent> events;
+    auto find_host = [](const std::vector<HostInfo>& hosts, const std::string& host) {
+        return std::find_if(hosts.begin(), hosts.end(), [&host](const HostInfo& h) { return h.GetHost() == host; });
+    };
+    auto find_writer = [](const std::vector<HostInfo>& hosts) {
+        return std::find_if(hosts.begin(), hosts.end(), [](const HostInfo& h) { return h.IsHostWriter(); });
+    };
+
+    auto previous_writer = find_writer(previous);
+    auto current_writer = find_writer(current);
+    if (previous_writer != previous.end() && current_writer != current.end() &&
+        previous_writer->GetHost() != current_writer->GetHost()) {
+        events.push_back(TopologyEvent{ WRITER_CHANGED, *current_writer });
+    }
+
+    for (const HostInfo& host : current) {
+        auto itr = find_host(previous, host.GetHost());
+        if (itr == previous.end()) {
+            events.push_back(TopologyEvent{ HOST_ADDED, host });
+        } else if (itr->GetWeight() != host.GetWeight()) {
+            events.push_back(TopologyEvent{ WEIGHT_CHANGED, host });
+        }
+    }
+
+    for (const HostInfo& host : previous) {
+        if (find_host(current, host.GetHost()) == current.end()) {
+            events.push_back(TopologyEvent{ HOST_REMOVED, host });
+        }
+    }
+    return events;
+}
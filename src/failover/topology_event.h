@@ -0,0 +1,45 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOPOLOGY_EVENT_H
+#define TOPOLOGY_EVENT_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../host_info.h"
+#include "topology_snapshot.h"
+
+enum TOPOLOGY_EVENT_TYPE { WRITER_CHANGED, HOST_ADDED, HOST_REMOVED, WEIGHT_CHANGED };
+
+/**
+ * A single change between two consecutive topology snapshots.
+ * For WRITER_CHANGED the host is the new writer, for HOST_REMOVED it is the host as it was last seen.
+ */
+struct TopologyEvent {
+    TOPOLOGY_EVENT_TYPE type;
+    HostInfo host;
+
+    static std::vector<TopologyEvent> Diff(const std::vector<HostInfo>& previous, const std::vector<HostInfo>& current);
+};
+
+/**
+ * Called with the newly published snapshot and its changes from the previous snapshot.
+ * Listeners run on the shared probe or refresh worker that published the topology. They must only hand the
+ * events off to the subscriber, for example by setting a flag that the subscriber's own thread acts on.
+ */
+typedef std::function<void(const std::shared_ptr<const TopologySnapshot>&, const std::vector<TopologyEvent>&)> TopologyListener;
+
+#endif // TOPOLOGY_EVENT_H
@@ -0,0 +1,70 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOPOLOGY_SNAPSHOT_H
+#define TOPOLOGY_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../host_info.h"
+
+/**
+ * Immutable view of a cluster topology.
+ * A new snapshot is published for every topology update, so holders never observe a partial update
+ * and two snapshots can be compared by generation (or pointer) instead of by value.
+ */
+struct TopologySnapshot {
+    TopologySnapshot(uint64_t generation, std::vector<HostInfo> hosts)
+        : generation{ generation }, hosts{ std::move(hosts) } {}
+
+    const uint64_t generation;
+    const std::vector<HostInfo> hosts;
+};
+
+/**
+ * Holder for the latest published TopologySnapshot.
+ * Readers load the current snapshot atomically without copying the hosts.
+ */
+class AtomicTopologySnapshot {
+public:
+    AtomicTopologySnapshot() : snapshot_{ std::make_shared<const TopologySnapshot>(0, std::vector<HostInfo>()) } {}
+
+    std::shared_ptr<const TopologySnapshot> Load() const {
+#ifdef __cpp_lib_atomic_shared_ptr
+        return snapshot_.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+#endif
+    }
+
+    void Store(std::shared_ptr<const TopologySnapshot> snapshot) {
+#ifdef __cpp_lib_atomic_shared_ptr
+        snapshot_.store(std::move(snapshot), std::memory_order_release);
+#else
+        std::atomic_store_explicit(&snapshot_, std::move(snapshot), std::memory_order_release);
+#endif
+    }
+
+private:
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::atomic<std::shared_ptr<const TopologySnapshot>> snapshot_;
+#else
+    std::shared_ptr<const TopologySnapshot> snapshot_;
+#endif
+};
+
+#endif // TOPOLOGY_SNAPSHOT_H
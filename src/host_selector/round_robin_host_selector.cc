@@ -22,7 +22,7 @@
 std::mutex RoundRobinHostSelector::cache_mutex;
 SlidingCacheMap<std::string, std::shared_ptr<round_robin_property::RoundRobinClusterInfo>> RoundRobinHostSelector::round_robin_cache;
 
-void RoundRobinHostSelector::SetRoundRobinWeight(std::vector<HostInfo> hosts,
+void RoundRobinHostSelector::SetRoundRobinWeight(const std::vector<HostInfo>& hosts,
     std::unordered_map<std::string, std::string>& properties) {
 
     std::string host_weight_str;
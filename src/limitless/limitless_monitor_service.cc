@@ -18,9 +18,11 @@
 #include <windows.h>
 #endif
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <random>
 
 #include <glog/logging.h>
 
@@ -29,13 +31,14 @@
 #include "../util/logger_wrapper.h"
 #include "../util/odbc_helper.h"
 #include "../util/rds_utils.h"
+#include "../util/refresh_scheduler.h"
 #include "../util/string_helper.h"
+#include "../util/string_to_number_converter.h"
 #include "limitless_query_helper.h"
 
-static LimitlessMonitorService limitless_monitor_service(std::make_shared<OdbcHelperWrapper>());
+static LimitlessMonitorService limitless_monitor_service;
 
-LimitlessMonitorService::LimitlessMonitorService(std::shared_ptr<IOdbcHelper> odbc_wrapper) {
-    this->odbc_wrapper = std::move(odbc_wrapper);
+LimitlessMonitorService::LimitlessMonitorService() {
     this->services_mutex = std::make_shared<std::mutex>();
 }
 
@@ -55,9 +58,7 @@ bool LimitlessMonitorService::NewService(
     int host_port,
     std::shared_ptr<LimitlessRouterMonitor> limitless_router_monitor
 ) {
-    std::lock_guard<std::mutex> services_guard(*(this->services_mutex));
-
-    // parse the connection string to extract useful limitless information
+    // parse the connection string to extract useful limitless information, without holding up other services
     std::map<SQLSTR, SQLSTR> connection_string_map;
     SQLSTR conn_str = StringHelper::ToSQLSTR(connection_string_c_str);
     ConnectionStringHelper::ParseConnectionString(conn_str, connection_string_map);
@@ -75,11 +76,6 @@ bool LimitlessMonitorService::NewService(
         }
     }
 
-    if (this->services.contains(service_id)) {
-        LOG(ERROR) << "Attempted to recreate existing monitor with service ID " << service_id;
-        return false;
-    }
-
     bool block_and_query_immediately = true;
 
     auto it = connection_string_map.find(LIMITLESS_MODE_KEY);
@@ -90,6 +86,18 @@ bool LimitlessMonitorService::NewService(
         }
     }
 
+    LimitlessRouterSelection router_selection = LimitlessRouterSelection::ROUND_ROBIN;
+
+    it = connection_string_map.find(LIMITLESS_ROUTER_SELECTION_KEY);
+    if (it != connection_string_map.end()) {
+        SQLSTR value = it->second;
+        if (value == LIMITLESS_ROUTER_SELECTION_VALUE_POWER_OF_TWO) {
+            router_selection = LimitlessRouterSelection::POWER_OF_TWO;
+        } else if (value == LIMITLESS_ROUTER_SELECTION_VALUE_LEAST_OUTSTANDING) {
+            router_selection = LimitlessRouterSelection::LEAST_OUTSTANDING;
+        }
+    }
+
     unsigned int limitless_monitor_interval_ms = DEFAULT_LIMITLESS_MONITOR_INTERVAL_MS; // incase the field is unset
 
     it = connection_string_map.find(LIMITLESS_MONITOR_INTERVAL_MS_KEY);
@@ -98,18 +106,40 @@ bool LimitlessMonitorService::NewService(
         limitless_monitor_interval_ms = std::stoi(value);
     }
 
-    // ensure that the owning scope of the shared pointer is inside the map
-    this->services[service_id] = std::make_shared<LimitlessMonitor>();
+    // router polls connect on the shared refresh workers, keep enough idle ones for the shard groups in use
+    it = connection_string_map.find(REFRESH_POOL_SIZE_KEY);
+    if (it != connection_string_map.end()) {
+        // unlike std::stoi, does not throw on a malformed value, which would escape through the C API
+        int refresh_pool_size = StringToNumberConverter::toInt(StringHelper::ToString(it->second).c_str());
+        if (refresh_pool_size > 0) {
+            RefreshScheduler::Configure(refresh_pool_size);
+        }
+    }
 
-    std::shared_ptr<LimitlessMonitor> service = this->services[service_id];
+    std::shared_ptr<LimitlessMonitor> service = std::make_shared<LimitlessMonitor>();
     service->reference_counter = 1;
     service->limitless_routers = std::make_shared<std::vector<HostInfo>>();
     service->limitless_routers_mutex = std::make_shared<std::mutex>();
-    service->limitless_router_monitor = std::move(limitless_router_monitor);
-    // limitless_router_monitor is now nullptr
+    service->router_selection = router_selection;
+    std::promise<void> initialized;
+    service->initialized = initialized.get_future().share();
+
+    {
+        std::lock_guard<std::mutex> services_guard(*(this->services_mutex));
+        if (this->services.contains(service_id)) {
+            LOG(ERROR) << "Attempted to recreate existing monitor with service ID " << service_id;
+            return false;
+        }
+
+        service->limitless_router_monitor = std::move(limitless_router_monitor);
+        // limitless_router_monitor is now nullptr
+        this->services[service_id] = service;
+    }
 
     // start monitoring; this will block until the first set of limitless routers
-    // is retrieved or an error occurs if block_and_query_immediately is true
+    // is retrieved or an error occurs if block_and_query_immediately is true.
+    // the services mutex is not held, callers of other services carry on while
+    // callers of this one wait in GetHostInfo until it is initialized
     service->limitless_router_monitor->Open(
         block_and_query_immediately,
         connection_string_c_str,
@@ -118,6 +148,7 @@ bool LimitlessMonitorService::NewService(
         service->limitless_routers,
         service->limitless_routers_mutex
     );
+    initialized.set_value();
     LOG(INFO) << "Started monitoring with service ID " << service_id;
 
     return true;
@@ -135,13 +166,15 @@ void LimitlessMonitorService::IncrementReferenceCounter(const std::string& servi
 }
 
 void LimitlessMonitorService::DecrementReferenceCounter(const std::string& service_id) {
+    // declared before the guard, so the last reference is dropped and the monitor closed after the services mutex is released
+    std::shared_ptr<LimitlessMonitor> service;
     std::lock_guard<std::mutex> services_guard(*(this->services_mutex));
     if (!this->services.contains(service_id)) {
         LOG(ERROR) << "Attempted to decrement reference counter for non-existent monitor with service ID " << service_id;
         return;
     }
 
-    std::shared_ptr<LimitlessMonitor> service = this->services[service_id];
+    service = this->services[service_id];
 
     if (service->reference_counter > 0) {
         service->reference_counter--;
@@ -150,7 +183,6 @@ void LimitlessMonitorService::DecrementReferenceCounter(const std::string& servi
     }
 
     if (service->reference_counter == 0) {
-        service = nullptr;
         services.erase(service_id);
         LOG(INFO) << "Stopped monitoring with service ID " << service_id;
     }
@@ -158,7 +190,7 @@ void LimitlessMonitorService::DecrementReferenceCounter(const std::string& servi
 
 std::shared_ptr<HostInfo> LimitlessMonitorService::GetHostInfo(const std::string& service_id) {
     std::vector<HostInfo> hosts;
-    SQLSTR connection_string;
+    std::shared_ptr<LimitlessMonitor> service;
 
     {
         std::lock_guard<std::mutex> services_guard(*(this->services_mutex));
@@ -167,56 +199,146 @@ std::shared_ptr<HostInfo> LimitlessMonitorService::GetHostInfo(const std::string
             return nullptr;
         }
 
-        std::shared_ptr<LimitlessMonitor> service = this->services[service_id];
+        service = this->services[service_id];
+    }
+
+    // wait until the service's monitor is opened, with the first set of limitless routers in immediate mode
+    service->initialized.wait();
+
+    {
         std::lock_guard<std::mutex> limitless_routers_guard(*(service->limitless_routers_mutex));
 
         if (service->limitless_routers == nullptr || service->limitless_routers->empty())
             return nullptr;
 
-        // copy hosts
-        hosts = *(service->limitless_routers);
-        connection_string = service->limitless_router_monitor->GetConnectionString();
+        if (service->router_selection != LimitlessRouterSelection::ROUND_ROBIN) {
+            return select_least_outstanding(*service, service->router_selection == LimitlessRouterSelection::POWER_OF_TWO);
+        }
+
+        // copy hosts, with weights round robin can hand out in a row
+        hosts.reserve(service->limitless_routers->size());
+        for (const HostInfo& router : *(service->limitless_routers)) {
+            hosts.emplace_back(router.GetHost(), router.GetPort(), router.GetHostState(), router.IsHostWriter(), nullptr,
+                LimitlessQueryHelper::GetRoundRobinWeight(router.GetWeight()));
+        }
     }
 
     std::unordered_map<std::string, std::string> properties;
 
     try {
+        // routers callers failed to connect to are down until the monitor reaches them again, and are skipped
         RoundRobinHostSelector::SetRoundRobinWeight(hosts, properties);
-        HostInfo host = this->round_robin.GetHost(hosts, true, properties);
-        if (this->odbc_wrapper->TestConnectionToServer(connection_string, host.GetHost())) {
-            // the round robin host successfully connected
-            return std::make_shared<HostInfo>(host);
-        }
+        return std::make_shared<HostInfo>(this->round_robin.GetHost(hosts, true, properties));
     } catch (std::runtime_error& error) {
-        LOG(INFO) << "Got runtime error while getting round robin host for limitless (trying for highest weight host next): " << error.what();
-        // proceed and attempt to connect to highest weight host
+        LOG(INFO) << "Got runtime error while getting round robin host for limitless (no router is up): " << error.what();
+    }
+
+    return nullptr;
+}
+
+void LimitlessMonitorService::ReportRouterFailure(const std::string& service_id, const std::string& host) {
+    std::shared_ptr<LimitlessMonitor> service;
+    {
+        std::lock_guard<std::mutex> services_guard(*(this->services_mutex));
+        if (!this->services.contains(service_id)) {
+            LOG(ERROR) << "Attempted to report a router failure for non-existent monitor with service ID " << service_id;
+            return;
+        }
+        service = this->services[service_id];
+    }
+
+    {
+        // the failed connection is not released afterwards
+        std::lock_guard<std::mutex> limitless_routers_guard(*(service->limitless_routers_mutex));
+        release_outstanding(*service, host);
+    }
+
+    service->initialized.wait();
+    if (service->limitless_router_monitor != nullptr) {
+        service->limitless_router_monitor->MarkRouterDown(host);
     }
+}
 
-    // five retries going by order of least loaded (highest weight)
-    for (int i = 0; i < DEFAULT_LIMITLESS_CONNECT_RETRY_ATTEMPTS; i++) {
-        try {
-            HostInfo host = this->highest_weight.GetHost(hosts, true, properties);
-
-            if (this->odbc_wrapper->TestConnectionToServer(connection_string, host.GetHost())) {
-                // the highest weight host successfully connected
-                return std::make_shared<HostInfo>(host);
-            } else {
-                // update this host in hosts list to have down state so it's not selected again
-                for (HostInfo& host_in_list : hosts) {
-                    if (host_in_list.GetHost() == host.GetHost()) {
-                        host_in_list.SetHostState(DOWN);
-                    }
-                }
+void LimitlessMonitorService::ReleaseHost(const std::string& service_id, const std::string& host) {
+    std::shared_ptr<LimitlessMonitor> service;
+    {
+        std::lock_guard<std::mutex> services_guard(*(this->services_mutex));
+        if (!this->services.contains(service_id)) {
+            LOG(ERROR) << "Attempted to release a router for non-existent monitor with service ID " << service_id;
+            return;
+        }
+        service = this->services[service_id];
+    }
+
+    std::lock_guard<std::mutex> limitless_routers_guard(*(service->limitless_routers_mutex));
+    release_outstanding(*service, host);
+}
+
+void LimitlessMonitorService::release_outstanding(LimitlessMonitor& service, const std::string& host) {
+    auto itr = service.outstanding_connections.find(host);
+    if (itr == service.outstanding_connections.end()) {
+        return; // handed out before a restart of the service, or by round robin
+    }
+    if (--(itr->second) == 0) {
+        service.outstanding_connections.erase(itr);
+    }
+}
+
+std::shared_ptr<HostInfo> LimitlessMonitorService::select_least_outstanding(LimitlessMonitor& service, bool sample_two) {
+    const std::vector<HostInfo>& hosts = *(service.limitless_routers);
+    thread_local std::mt19937 gen(std::random_device{}());
+
+    std::vector<size_t> up_hosts;
+    up_hosts.reserve(hosts.size());
+    for (size_t i = 0; i < hosts.size(); i++) {
+        if (hosts[i].IsHostUp()) {
+            up_hosts.push_back(i);
+        }
+    }
+    if (up_hosts.empty()) {
+        LOG(INFO) << "No limitless router is up";
+        return nullptr;
+    }
+
+    auto outstanding = [&service](const HostInfo& host) -> uint64_t {
+        auto itr = service.outstanding_connections.find(host.GetHost());
+        return itr == service.outstanding_connections.end() ? 0 : itr->second;
+    };
+    // compares (outstanding + 1) / weight, the load a new connection would see relative to the router's polled capacity
+    auto compare = [&outstanding](const HostInfo& a, const HostInfo& b) {
+        uint64_t a_cost = (outstanding(a) + 1) * std::max<uint64_t>(b.GetWeight(), 1);
+        uint64_t b_cost = (outstanding(b) + 1) * std::max<uint64_t>(a.GetWeight(), 1);
+        return a_cost < b_cost ? -1 : (a_cost > b_cost ? 1 : 0);
+    };
+
+    size_t chosen;
+    if (sample_two && up_hosts.size() > 2) {
+        // two distinct routers, independent choices keep processes that poll the same load from piling onto one router
+        std::uniform_int_distribution<size_t> first_dis(0, up_hosts.size() - 1);
+        std::uniform_int_distribution<size_t> second_dis(0, up_hosts.size() - 2);
+        size_t first = first_dis(gen);
+        size_t second = second_dis(gen);
+        if (second >= first) {
+            second++;
+        }
+        chosen = compare(hosts[up_hosts[second]], hosts[up_hosts[first]]) < 0 ? up_hosts[second] : up_hosts[first];
+    } else {
+        // least loaded, ties broken uniformly at random
+        chosen = up_hosts[0];
+        size_t ties = 1;
+        for (size_t i = 1; i < up_hosts.size(); i++) {
+            int comparison = compare(hosts[up_hosts[i]], hosts[chosen]);
+            if (comparison < 0) {
+                chosen = up_hosts[i];
+                ties = 1;
+            } else if (comparison == 0 && std::uniform_int_distribution<size_t>(0, ties++)(gen) == 0) {
+                chosen = up_hosts[i];
             }
-        } catch (std::runtime_error &error) {
-            // no more hosts
-            LOG(INFO) << "Got runtime error while getting highest weight host for limitless (no host found): " << error.what();
-            break;
         }
     }
 
-    // no host was successfully connected to
-    return nullptr;
+    service.outstanding_connections[hosts[chosen].GetHost()]++;
+    return std::make_shared<HostInfo>(hosts[chosen]);
 }
 
 bool CheckLimitlessCluster(const SQLTCHAR *connection_string_c_str, const char *custom_errmsg_c_str, char *final_errmsg_c_str, size_t final_errmsg_size) {
@@ -285,6 +407,14 @@ bool GetLimitlessInstance(const SQLTCHAR *connection_string_c_str, int host_port
     return true;
 }
 
+void ReportLimitlessRouterFailure(const char *service_id_c_str, const char *router_c_str) {
+    limitless_monitor_service.ReportRouterFailure(service_id_c_str, router_c_str);
+}
+
+void ReleaseLimitlessInstance(const char *service_id_c_str, const char *router_c_str) {
+    limitless_monitor_service.ReleaseHost(service_id_c_str, router_c_str);
+}
+
 void StopLimitlessMonitorService(const char *service_id_c_str) {
     std::string service_id(service_id_c_str);
     limitless_monitor_service.DecrementReferenceCounter(service_id);
@@ -17,15 +17,25 @@
 
 #ifdef __cplusplus
 #include <cstdio>
+#include <future>
 #include <map>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
-#include "../util/odbc_helper.h"
-#include "highest_weight_host_selector.h"
+#include "../util/connection_string_helper.h"
 #include "limitless_router_monitor.h"
 #include "round_robin_host_selector.h"
 
+enum class LimitlessRouterSelection {
+    // Weighted round robin over the polled router weights
+    ROUND_ROBIN,
+    // The less loaded of two random routers, by outstanding connections per unit of polled weight
+    POWER_OF_TWO,
+    // The least loaded router, by outstanding connections per unit of polled weight
+    LEAST_OUTSTANDING
+};
+
 typedef struct LimitlessMonitor {
     ~LimitlessMonitor() {
         this->limitless_router_monitor = nullptr;
@@ -37,11 +47,16 @@ typedef struct LimitlessMonitor {
     std::shared_ptr<std::vector<HostInfo>> limitless_routers;
     std::shared_ptr<std::mutex> limitless_routers_mutex;
     std::shared_ptr<LimitlessRouterMonitor> limitless_router_monitor;
+    // Ready once the monitor is opened, the services map only holds services whose initialization has started
+    std::shared_future<void> initialized;
+    LimitlessRouterSelection router_selection = LimitlessRouterSelection::ROUND_ROBIN;
+    // Routers handed out and not released yet by this process, guarded by limitless_routers_mutex
+    std::unordered_map<std::string, uint64_t> outstanding_connections;
 } LimitlessMonitor;
 
 class LimitlessMonitorService {
 public:
-    explicit LimitlessMonitorService(std::shared_ptr<IOdbcHelper> odbc_wrapper);
+    LimitlessMonitorService();
 
     ~LimitlessMonitorService();
 
@@ -53,23 +68,35 @@ public:
 
     void DecrementReferenceCounter(const std::string& service_id);
 
+    // Picks a router that is up from the monitor's last poll, without connecting to it
+    // The router is passed back exactly once, to ReportRouterFailure or ReleaseHost,
+    // otherwise least outstanding selections steer away from it for as long as the service lives
     std::shared_ptr<HostInfo> GetHostInfo(const std::string& service_id);
+
+    // Passes a failed connection to a router on to the service's monitor, which stops handing it out until it is reachable again
+    // The connection is no longer counted, it is not released afterwards
+    void ReportRouterFailure(const std::string& service_id, const std::string& host);
+
+    // Counts a connection to a router handed out by GetHostInfo as closed
+    void ReleaseHost(const std::string& service_id, const std::string& host);
 private:
-    std::shared_ptr<IOdbcHelper> odbc_wrapper;
+    // Caller holds the service's limitless_routers_mutex
+    static std::shared_ptr<HostInfo> select_least_outstanding(LimitlessMonitor& service, bool sample_two);
+
+    // Caller holds the service's limitless_routers_mutex
+    static void release_outstanding(LimitlessMonitor& service, const std::string& host);
 
     std::map<std::string, std::shared_ptr<LimitlessMonitor>> services;
 
     std::shared_ptr<std::mutex> services_mutex;
 
     RoundRobinHostSelector round_robin;
-    HighestWeightHostSelector highest_weight;
 };
 
 extern "C" {
 #endif
 
 #define DEFAULT_LIMITLESS_MONITOR_INTERVAL_MS       7500
-#define DEFAULT_LIMITLESS_CONNECT_RETRY_ATTEMPTS    5
 
 typedef struct {
     char *server;
@@ -102,6 +129,27 @@ bool CheckLimitlessCluster(const SQLTCHAR *connection_string_c_str, const char *
  */
 bool GetLimitlessInstance(const SQLTCHAR *connection_string_c_str, int host_port, char *service_id_c_str, size_t service_id_size, const LimitlessInstance *db_instance);
 
+/**
+ * Reports that connecting to a transaction router returned by GetLimitlessInstance failed.
+ * The router is no longer returned until the polling thread connects to it successfully.
+ * Every router returned by GetLimitlessInstance is passed back exactly once, either here if connecting to it failed,
+ * or to ReleaseLimitlessInstance once the connection is closed, never to both
+ *
+ * @param service_id_c_str the identifier of the service the router was returned for
+ * @param router_c_str the server of the LimitlessInstance that could not be connected to
+ */
+void ReportLimitlessRouterFailure(const char *service_id_c_str, const char *router_c_str);
+
+/**
+ * Reports that a connection to a transaction router returned by GetLimitlessInstance was closed.
+ * The power_of_two and least_outstanding router selections steer new connections away from routers with more open connections.
+ * Not called for routers already passed to ReportLimitlessRouterFailure
+ *
+ * @param service_id_c_str the identifier of the service the router was returned for
+ * @param router_c_str the server of the LimitlessInstance the connection was made to
+ */
+void ReleaseLimitlessInstance(const char *service_id_c_str, const char *router_c_str);
+
 /**
  * Decrements the reference count of a given service ID.
  * Once it reaches 0, the polling thread will be joined and cleaned up
@@ -0,0 +1,78 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "limitless_poll_interval.h"
+
+#include <algorithm>
+#include <cmath>
+
+LimitlessPollInterval::LimitlessPollInterval(
+    std::chrono::milliseconds interval,
+    std::chrono::milliseconds max_interval,
+    double jitter
+) : min_interval{ std::max(interval / SPEED_UP_FACTOR, std::chrono::milliseconds(1)) },
+    interval{ std::max(interval, std::chrono::milliseconds(1)) },
+    max_interval{ std::max(max_interval, this->interval) },
+    current{ this->interval },
+    jitter{ std::clamp(jitter, 0.0, 1.0) } {}
+
+std::chrono::milliseconds LimitlessPollInterval::Update(const std::vector<std::pair<std::string, double>>& router_loads, bool routers_down) {
+    if (!this->polled) {
+        this->current = this->interval;
+    } else if (this->changed(router_loads)) {
+        // more routers are likely on their way, or the load is still moving
+        this->current = this->min_interval;
+    } else {
+        this->current = std::min(this->current * BACK_OFF_FACTOR, this->max_interval);
+    }
+
+    if (routers_down) {
+        this->current = std::min(this->current, this->interval);
+    }
+
+    this->last_router_loads.clear();
+    this->last_router_loads.insert(router_loads.begin(), router_loads.end());
+    this->polled = true;
+
+    return this->jittered();
+}
+
+std::chrono::milliseconds LimitlessPollInterval::Reset() {
+    this->current = this->interval;
+    return this->jittered();
+}
+
+bool LimitlessPollInterval::changed(const std::vector<std::pair<std::string, double>>& router_loads) const {
+    if (router_loads.size() != this->last_router_loads.size()) {
+        return true;
+    }
+
+    for (const auto& [router_endpoint, load] : router_loads) {
+        auto itr = this->last_router_loads.find(router_endpoint);
+        if (itr == this->last_router_loads.end()) {
+            return true;
+        }
+        // a router without a load says nothing about how the load moved
+        if (!std::isnan(load) && !std::isnan(itr->second) && std::abs(load - itr->second) > LOAD_CHANGE_THRESHOLD) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::chrono::milliseconds LimitlessPollInterval::jittered() {
+    std::uniform_real_distribution<double> dis(1.0 - this->jitter, 1.0 + this->jitter);
+    auto delay = std::chrono::milliseconds(std::llround(static_cast<double>(this->current.count()) * dis(this->gen)));
+    return std::max(delay, std::chrono::milliseconds(1));
+}
@@ -0,0 +1,83 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIMITLESSPOLLINTERVAL_H_
+#define LIMITLESSPOLLINTERVAL_H_
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Delay between two polls of the limitless routers.
+ * Polls follow each other quickly while routers are added, removed or their load shifts,
+ * and back off up to a ceiling while nothing changes. Each delay is jittered, so processes
+ * that started together do not keep querying the router endpoints in lockstep.
+ */
+class LimitlessPollInterval {
+public:
+    // a change of any router's load by more than this between two polls is worth polling again soon
+    static constexpr double LOAD_CHANGE_THRESHOLD = 0.1;
+    // the shortest delay, after a change, is the configured interval divided by this
+    static constexpr unsigned int SPEED_UP_FACTOR = 4;
+    // while nothing changes, the delay grows by this factor each poll
+    static constexpr unsigned int BACK_OFF_FACTOR = 2;
+    // each delay is drawn uniformly within this fraction around the unjittered delay
+    static constexpr double DEFAULT_JITTER = 0.2;
+
+    LimitlessPollInterval() = default;
+
+    LimitlessPollInterval(
+        std::chrono::milliseconds interval,
+        std::chrono::milliseconds max_interval,
+        double jitter = DEFAULT_JITTER
+    );
+
+    /**
+     * Records the routers of a successful poll, and returns the delay before the next one.
+     * The delay is capped at the configured interval while routers are down, so they are tested again as usual.
+     */
+    std::chrono::milliseconds Update(const std::vector<std::pair<std::string, double>>& router_loads, bool routers_down);
+
+    /**
+     * Goes back to the configured interval, on start or after a failed poll, and returns the delay before the next poll.
+     */
+    std::chrono::milliseconds Reset();
+
+    // unjittered delay before the next poll
+    std::chrono::milliseconds GetInterval() const {
+        return this->current;
+    }
+
+private:
+    std::chrono::milliseconds min_interval{};
+    std::chrono::milliseconds interval{};
+    std::chrono::milliseconds max_interval{};
+    std::chrono::milliseconds current{};
+    double jitter = DEFAULT_JITTER;
+
+    // raw loads of the last successful poll
+    std::unordered_map<std::string, double> last_router_loads;
+    bool polled = false;
+
+    std::mt19937 gen{ std::random_device{}() };
+
+    bool changed(const std::vector<std::pair<std::string, double>>& router_loads) const;
+    std::chrono::milliseconds jittered();
+};
+
+#endif // LIMITLESSPOLLINTERVAL_H_
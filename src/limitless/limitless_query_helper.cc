@@ -17,14 +17,15 @@
 #include <sql.h>
 #include <sqlext.h>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <string>
 
 #include <glog/logging.h>
 
 #include "../util/logger_wrapper.h"
 #include "../util/odbc_helper.h"
-#include "../util/string_to_number_converter.h"
 
 SQLTCHAR* LimitlessQueryHelper::check_limitless_cluster_query = AS_SQLTCHAR(TEXT(\
     "SELECT EXISTS ("\
@@ -70,67 +71,104 @@ bool LimitlessQueryHelper::CheckLimitlessCluster(SQLHDBC conn) {
     return false;
 }
 
-std::vector<HostInfo> LimitlessQueryHelper::QueryForLimitlessRouters(SQLHDBC conn, int host_port_to_map) {
+std::vector<std::pair<std::string, double>> LimitlessQueryHelper::QueryForLimitlessRouterLoads(SQLHDBC conn) {
     HSTMT hstmt = SQL_NULL_HSTMT;
     SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
     if (!OdbcHelper::CheckResult(rc, "LimitlessQueryHelper: SQLAllocHandle failed", hstmt, SQL_HANDLE_STMT)) {
-        return std::vector<HostInfo>();
+        return std::vector<std::pair<std::string, double>>();
     }
 
     // Generally accepted URL endpoint max length + 1 for null terminator
     SQLCHAR router_endpoint_value[ROUTER_ENDPOINT_LENGTH] = {0};
     SQLLEN ind_router_endpoint_value = 0;
 
-    SQLCHAR load_value[LOAD_LENGTH] = {0};
+    // bound natively, so small load differences are not cut off by a character buffer
+    SQLDOUBLE load_value = 0;
     SQLLEN ind_load_value = 0;
 
     rc = SQLBindCol(hstmt, 1, SQL_C_CHAR, &router_endpoint_value, sizeof(router_endpoint_value), &ind_router_endpoint_value);
-    SQLRETURN rc2 = SQLBindCol(hstmt, 2, SQL_C_CHAR, &load_value, sizeof(load_value), &ind_load_value);
+    SQLRETURN rc2 = SQLBindCol(hstmt, 2, SQL_C_DOUBLE, &load_value, sizeof(load_value), &ind_load_value);
     if (!OdbcHelper::CheckResult(rc, "LimitlessQueryHelper: SQLBindCol for router endpoint failed", hstmt, SQL_HANDLE_STMT) ||
         !OdbcHelper::CheckResult(rc2, "LimitlessQueryHelper: SQLBindCol for load value failed", hstmt, SQL_HANDLE_STMT)) {
         OdbcHelper::Cleanup(SQL_NULL_HENV, SQL_NULL_HDBC, hstmt);
-        return std::vector<HostInfo>();
+        return std::vector<std::pair<std::string, double>>();
     }
 
     rc = SQLExecDirect(hstmt, limitless_router_endpoint_query, SQL_NTS);
     if (!OdbcHelper::CheckResult(rc, "LimitlessQueryHelper: SQLExecDirect failed", hstmt, SQL_HANDLE_STMT)) {
         OdbcHelper::Cleanup(SQL_NULL_HENV, SQL_NULL_HDBC, hstmt);
-        return std::vector<HostInfo>();
+        return std::vector<std::pair<std::string, double>>();
     }
 
     SQLLEN row_count = 0;
     rc = SQLRowCount(hstmt, &row_count);
     if (!OdbcHelper::CheckResult(rc, "LimitlessQueryHelper: SQLRowCount failed", hstmt, SQL_HANDLE_STMT)) {
         OdbcHelper::Cleanup(SQL_NULL_HENV, SQL_NULL_HDBC, hstmt);
-        return std::vector<HostInfo>();
+        return std::vector<std::pair<std::string, double>>();
     }
-    std::vector<HostInfo> limitless_routers;
+    std::vector<std::pair<std::string, double>> router_loads;
 
     while (SQL_SUCCEEDED(rc = SQLFetch(hstmt))) {
-        limitless_routers.push_back(create_host(load_value, router_endpoint_value, host_port_to_map));
+        double load = ind_load_value == SQL_NULL_DATA ? std::numeric_limits<double>::quiet_NaN() : load_value;
+        router_loads.emplace_back(reinterpret_cast<const char *>(router_endpoint_value), load);
     }
 
     OdbcHelper::Cleanup(SQL_NULL_HENV, SQL_NULL_HDBC, hstmt);
 
-    return limitless_routers;
+    return router_loads;
 }
 
-HostInfo LimitlessQueryHelper::create_host(const SQLCHAR* load, const SQLCHAR* router_endpoint, const int host_port_to_map) {
-    int64_t weight = std::round(WEIGHT_SCALING - (StringToNumberConverter::toDouble(reinterpret_cast<const char *>(load)) * WEIGHT_SCALING));
-
-    if (weight < MIN_WEIGHT || weight > MAX_WEIGHT) {
-        weight = MIN_WEIGHT;
-        LOG(WARNING) << "Invalid router load of " << load << " for " << router_endpoint;
+std::vector<HostInfo> LimitlessQueryHelper::SmoothRouterLoads(
+    const std::vector<std::pair<std::string, double>>& router_loads,
+    const double smoothing,
+    std::unordered_map<std::string, double>& smoothed_loads,
+    const int host_port_to_map
+) {
+    std::unordered_map<std::string, double> new_smoothed_loads;
+    std::vector<HostInfo> limitless_routers;
+    limitless_routers.reserve(router_loads.size());
+
+    for (const auto& [router_endpoint, load] : router_loads) {
+        auto itr = smoothed_loads.find(router_endpoint);
+        bool has_history = itr != smoothed_loads.end();
+
+        double smoothed_load;
+        if (std::isnan(load)) {
+            // keep the router's last known load, a router never seen with a load is assumed busy
+            LOG(WARNING) << "No router load for " << router_endpoint;
+            smoothed_load = has_history ? itr->second : 1.0;
+        } else {
+            if (load < 0.0 || load > 1.0) {
+                LOG(WARNING) << "Router load of " << load << " for " << router_endpoint << " is out of range";
+            }
+            double sample = std::clamp(load, 0.0, 1.0);
+            // a new router starts at its first sample rather than being pulled towards an arbitrary initial value
+            smoothed_load = has_history ? itr->second + smoothing * (sample - itr->second) : sample;
+        }
+
+        new_smoothed_loads[router_endpoint] = smoothed_load;
+        limitless_routers.push_back(create_host(router_endpoint, smoothed_load, host_port_to_map));
     }
 
-    std::string router_endpoint_str(reinterpret_cast<const char *>(router_endpoint));
+    // forget routers that were removed from the shard group
+    smoothed_loads = std::move(new_smoothed_loads);
+    return limitless_routers;
+}
+
+uint64_t LimitlessQueryHelper::GetRoundRobinWeight(const uint64_t weight) {
+    uint64_t round_robin_weight = (weight * ROUND_ROBIN_WEIGHT_SCALING + WEIGHT_SCALING / 2) / WEIGHT_SCALING;
+    return std::clamp<uint64_t>(round_robin_weight, 1, ROUND_ROBIN_WEIGHT_SCALING);
+}
+
+HostInfo LimitlessQueryHelper::create_host(const std::string& router_endpoint, const double load, const int host_port_to_map) {
+    auto weight = static_cast<uint64_t>(std::llround((1.0 - load) * WEIGHT_SCALING));
 
     return HostInfo(
-            router_endpoint_str,
+            router_endpoint,
             host_port_to_map,
             UP,
             true,
             nullptr,
-            weight
+            std::clamp(weight, MIN_WEIGHT, MAX_WEIGHT)
         );
 }
@@ -21,6 +21,9 @@
 
 #include <sqltypes.h>
 
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../host_info.h"
@@ -28,18 +31,40 @@
 class LimitlessQueryHelper {
 public:
     static const int ROUTER_ENDPOINT_LENGTH = 2049;
-    static const int LOAD_LENGTH = 5;
-    static const int WEIGHT_SCALING = 10;
-    static const int MAX_WEIGHT = 10;
-    static const int MIN_WEIGHT = 1;
+    // router weights are the spare capacity (1 - load) in parts per million
+    static constexpr uint64_t WEIGHT_SCALING = 1000000;
+    static constexpr uint64_t MAX_WEIGHT = WEIGHT_SCALING;
+    static constexpr uint64_t MIN_WEIGHT = 1;
+    // round robin hands out a router as many times in a row as its weight, so it gets coarser weights
+    static constexpr uint64_t ROUND_ROBIN_WEIGHT_SCALING = 10;
     static SQLTCHAR *check_limitless_cluster_query;
     static SQLTCHAR *limitless_router_endpoint_query;
 
     static bool CheckLimitlessCluster(SQLHDBC conn);
-    static std::vector<HostInfo> QueryForLimitlessRouters(SQLHDBC conn, int host_port_to_map);
+
+    /**
+     * Queries the router endpoints and their raw load, NaN for a router without a load.
+     * Returns an empty vector on an error.
+     */
+    static std::vector<std::pair<std::string, double>> QueryForLimitlessRouterLoads(SQLHDBC conn);
+
+    /**
+     * Folds the polled loads into the exponentially weighted moving average of each router's load,
+     * and returns the routers weighted by their smoothed load.
+     * A smoothing of 1 uses the latest load only, lower values damp noisy samples over more polls.
+     * Routers that are no longer listed are dropped from smoothed_loads.
+     */
+    static std::vector<HostInfo> SmoothRouterLoads(
+        const std::vector<std::pair<std::string, double>>& router_loads,
+        double smoothing,
+        std::unordered_map<std::string, double>& smoothed_loads,
+        int host_port_to_map
+    );
+
+    static uint64_t GetRoundRobinWeight(uint64_t weight);
 
 private:
-    static HostInfo create_host(const SQLCHAR* load, const SQLCHAR* router_endpoint, int host_port_to_map);
+    static HostInfo create_host(const std::string& router_endpoint, double load, int host_port_to_map);
 };
 
 #endif // LIMITLESSQUERYHELPER_H_
@@ -20,12 +20,20 @@
 
 #include <sqlext.h>
 
+#include <algorithm>
 #include <chrono>
+#include <future>
+#include <map>
 #include <regex>
+#include <unordered_set>
+
+#include <glog/logging.h>
 
 #include "../util/connection_string_keys.h"
 #include "../util/logger_wrapper.h"
 #include "../util/odbc_helper.h"
+#include "../util/refresh_scheduler.h"
+#include "../util/string_to_number_converter.h"
 #include "limitless_query_helper.h"
 
 LimitlessRouterMonitor::LimitlessRouterMonitor() = default;
@@ -47,49 +55,96 @@ void LimitlessRouterMonitor::Open(
     this->interval_ms = interval_ms;
     this->limitless_routers = limitless_routers;
     this->limitless_routers_mutex = limitless_routers_mutex;
-
-    SQLHENV henv = SQL_NULL_HANDLE;
-    SQLHDBC conn = SQL_NULL_HANDLE;
+    this->host_port = host_port;
 
     this->connection_string = StringHelper::ToSQLSTR(connection_string_c_str);
 
+    std::map<SQLSTR, SQLSTR> connection_string_map;
+    ConnectionStringHelper::ParseConnectionString(this->connection_string, connection_string_map);
+    auto it = connection_string_map.find(LIMITLESS_LOAD_SMOOTHING_KEY);
+    if (it != connection_string_map.end()) {
+        double load_smoothing = StringToNumberConverter::toDouble(StringHelper::ToString(it->second).c_str());
+        if (load_smoothing > 0.0 && load_smoothing <= 1.0) {
+            this->load_smoothing = load_smoothing;
+        } else {
+            LOG(WARNING) << "Limitless load smoothing must be greater than 0 and at most 1, using the default of " << DEFAULT_LIMITLESS_LOAD_SMOOTHING;
+        }
+    }
+
+    unsigned int max_interval_ms = interval_ms * DEFAULT_LIMITLESS_MONITOR_MAX_INTERVAL_FACTOR;
+    it = connection_string_map.find(LIMITLESS_MONITOR_MAX_INTERVAL_MS_KEY);
+    if (it != connection_string_map.end()) {
+        max_interval_ms = std::max<int64_t>(StringToNumberConverter::toLong(StringHelper::ToString(it->second).c_str()), interval_ms);
+    }
+    this->poll_interval = LimitlessPollInterval(std::chrono::milliseconds(interval_ms), std::chrono::milliseconds(max_interval_ms));
+
     // disable limitless for the monitor
     RDSREGEX limitless_enabled_pattern(LIMITLESS_ENABLED_KEY TEXT("=") BOOL_TRUE);
     SQLSTR limitless_disabled = LIMITLESS_ENABLED_KEY TEXT("=") BOOL_FALSE;
     this->connection_string = std::regex_replace(this->connection_string, limitless_enabled_pattern, limitless_disabled);
+    this->router_connection_template = std::make_shared<const ConnectionStringTemplate>(
+        this->connection_string, ConnectionStringOverrides{ { LIMITLESS_ENABLED_KEY, BOOL_FALSE } }, true);
 
-    SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_ENV, nullptr, &henv);
-    if (!OdbcHelper::CheckResult(rc, "LimitlessRouterMonitor: SQLAllocHandle failed", henv, SQL_HANDLE_ENV)) {
-        return; // fatal error; don't open thread
+    SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_ENV, nullptr, &this->henv);
+    if (!OdbcHelper::CheckResult(rc, "LimitlessRouterMonitor: SQLAllocHandle failed", this->henv, SQL_HANDLE_ENV)) {
+        return; // fatal error; don't schedule polls
     }
 
-    SQLSetEnvAttr(henv, SQL_ATTR_ODBC_VERSION, reinterpret_cast<SQLPOINTER>(SQL_OV_ODBC3), 0);
+    SQLSetEnvAttr(this->henv, SQL_ATTR_ODBC_VERSION, reinterpret_cast<SQLPOINTER>(SQL_OV_ODBC3), 0);
 
     if (block_and_query_immediately) {
-        rc = SQLAllocHandle(SQL_HANDLE_DBC, henv, &conn);
-        if (!OdbcHelper::CheckResult(rc, "LimitlessRouterMonitor: SQLAllocHandle failed", conn, SQL_HANDLE_DBC)) {
-            OdbcHelper::Cleanup(henv, conn, SQL_NULL_HSTMT);
-            return; // fatal error; don't open thread
+        rc = SQLAllocHandle(SQL_HANDLE_DBC, this->henv, &this->conn);
+        if (!OdbcHelper::CheckResult(rc, "LimitlessRouterMonitor: SQLAllocHandle failed", this->conn, SQL_HANDLE_DBC)) {
+            OdbcHelper::Cleanup(this->henv, this->conn, SQL_NULL_HSTMT);
+            this->henv = SQL_NULL_HANDLE;
+            this->conn = SQL_NULL_HANDLE;
+            return; // fatal error; don't schedule polls
         }
 
-        rc = SQLDriverConnect(conn, nullptr, AS_SQLTCHAR(this->connection_string.c_str()), SQL_NTS, nullptr, 0, nullptr, SQL_DRIVER_NOPROMPT);
+        rc = SQLDriverConnect(this->conn, nullptr, AS_SQLTCHAR(this->connection_string.c_str()), SQL_NTS, nullptr, 0, nullptr, SQL_DRIVER_NOPROMPT);
         if (SQL_SUCCEEDED(rc)) {
             // initial connection was successful, immediately populate caller's limitless routers
-            *limitless_routers = LimitlessQueryHelper::QueryForLimitlessRouters(conn, host_port);
+            std::vector<std::pair<std::string, double>> router_loads = LimitlessQueryHelper::QueryForLimitlessRouterLoads(this->conn);
+            this->poll_interval.Update(router_loads, false);
+            *limitless_routers = LimitlessQueryHelper::SmoothRouterLoads(router_loads, this->load_smoothing, this->smoothed_loads, host_port);
         } else {
             // not successful, ensure limitless routers is empty 
             limitless_routers->clear();
         }
     }
 
-    // start monitoring thread; if block_and_query_immediately is false, then conn is SQL_NULL_HANDLE, and the thread will connect after the monitor interval has passed
-    this->monitor_thread = std::make_shared<std::thread>(&LimitlessRouterMonitor::Run, this, henv, conn, reinterpret_cast<SQLTCHAR *>(this->connection_string.data()), SQL_NTS, host_port);
+    // schedule polling; if block_and_query_immediately is false, then conn is SQL_NULL_HANDLE, and the first poll will connect after the monitor interval has passed
+    this->poll_task_id = RefreshScheduler::Schedule([this] { return this->Run(); }, this->poll_interval.Reset());
 }
 
 bool LimitlessRouterMonitor::IsStopped() {
     return this->stopped;
 }
 
+void LimitlessRouterMonitor::MarkRouterDown(const std::string& host) {
+    if (this->limitless_routers_mutex == nullptr) {
+        return; // never opened
+    }
+
+    bool newly_down = false;
+    {
+        std::lock_guard<std::mutex> guard(*(this->limitless_routers_mutex));
+        newly_down = !this->down_routers.contains(host);
+        this->down_routers[host] = std::chrono::steady_clock::now();
+        for (HostInfo& router : *(this->limitless_routers)) {
+            if (router.GetHost() == host) {
+                router.SetHostState(DOWN);
+            }
+        }
+    }
+    LOG(INFO) << "Limitless router " << host << " marked down";
+
+    // the next poll may be backed off well past the monitor interval, retest the router now instead
+    if (newly_down) {
+        RefreshScheduler::Wake(this->poll_task_id);
+    }
+}
+
 void LimitlessRouterMonitor::Close() {
     if (this->stopped) {
         return;
@@ -97,45 +152,111 @@ void LimitlessRouterMonitor::Close() {
 
     this->stopped = true;
 
-    if (this->monitor_thread != nullptr) {
-        this->monitor_thread->join();
-        this->monitor_thread = nullptr;
+    // a poll that is waiting is dropped right away, one in progress is waited for
+    if (this->poll_task_id != 0) {
+        RefreshScheduler::Cancel(this->poll_task_id);
+        this->poll_task_id = 0;
     }
+
+    OdbcHelper::Cleanup(this->henv, this->conn, SQL_NULL_HSTMT);
+    this->henv = SQL_NULL_HANDLE;
+    this->conn = SQL_NULL_HANDLE;
 }
 
-void LimitlessRouterMonitor::Run(SQLHENV henv, SQLHDBC conn, SQLTCHAR *connection_string, SQLSMALLINT connection_string_len, int host_port) {
-    SQLSMALLINT out_connection_string_len; // unused
+std::chrono::milliseconds LimitlessRouterMonitor::Run() {
+    if (this->stopped) {
+        return RefreshScheduler::STOP;
+    }
 
-    while (!this->stopped) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(this->interval_ms));
+    if (this->conn == SQL_NULL_HANDLE || !OdbcHelper::CheckConnection(this->conn)) {
+        // OdbcHelper::CheckConnection failed on a pre-existing handle, so free it
+        OdbcHelper::Cleanup(SQL_NULL_HENV, this->conn, SQL_NULL_HSTMT);
+        this->conn = SQL_NULL_HANDLE;
 
-        if (conn == SQL_NULL_HANDLE || !OdbcHelper::CheckConnection(conn)) {
-            // OdbcHelper::CheckConnection failed on a pre-existing handle, so free it
-            OdbcHelper::Cleanup(SQL_NULL_HENV, conn, SQL_NULL_HSTMT);
+        SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_DBC, this->henv, &this->conn);
+        if (!OdbcHelper::CheckResult(rc, "LimitlessRouterMonitor: SQLAllocHandle failed", this->conn, SQL_HANDLE_DBC)) {
+            this->conn = SQL_NULL_HANDLE;
+            return RefreshScheduler::STOP; // this is a fatal error; stop monitoring
+        }
 
-            SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_DBC, henv, &conn);
-            if (!OdbcHelper::CheckResult(rc, "LimitlessRouterMonitor: SQLAllocHandle failed", conn, SQL_HANDLE_DBC)) {
-                break; // this is a fatal error; stop monitoring
-            }
+        SQLSMALLINT out_connection_string_len; // unused
+        rc = SQLDriverConnect(this->conn, nullptr, AS_SQLTCHAR(this->connection_string.c_str()), SQL_NTS, nullptr, 0, &out_connection_string_len, SQL_DRIVER_NOPROMPT);
+        if (!SQL_SUCCEEDED(rc)) {
+            OdbcHelper::Cleanup(SQL_NULL_HENV, this->conn, SQL_NULL_HSTMT);
+            this->conn = SQL_NULL_HANDLE;
 
-            rc = SQLDriverConnect(conn, nullptr, connection_string, connection_string_len, nullptr, 0, &out_connection_string_len, SQL_DRIVER_NOPROMPT);
-            if (!SQL_SUCCEEDED(rc)) {
-                OdbcHelper::Cleanup(SQL_NULL_HENV, conn, SQL_NULL_HSTMT);
+            // wait the configured interval and then try to reconnect
+            this->retest_known_routers();
+            return this->poll_interval.Reset();
+        } // else, connection was successful, proceed below
+    }
 
-                // wait the full interval and then try to reconnect
-                continue;
-            } // else, connection was successful, proceed below
-        }
+    std::vector<std::pair<std::string, double>> router_loads = LimitlessQueryHelper::QueryForLimitlessRouterLoads(this->conn);
+
+    // LimitlessQueryHelper::QueryForLimitlessRouterLoads will return an empty vector on an error
+    // if it was a connection error, then the next poll will catch it and attempt to reconnect
+    if (router_loads.empty()) {
+        this->retest_known_routers();
+        return this->poll_interval.Reset();
+    }
+
+    std::vector<HostInfo> new_limitless_routers = LimitlessQueryHelper::SmoothRouterLoads(router_loads, this->load_smoothing, this->smoothed_loads, this->host_port);
+    bool routers_down = this->update_router_health(new_limitless_routers);
+    // poll sooner while the routers change, and less often while they do not
+    return this->poll_interval.Update(router_loads, routers_down);
+}
 
-        std::vector<HostInfo> new_limitless_routers = LimitlessQueryHelper::QueryForLimitlessRouters(conn, host_port);
+bool LimitlessRouterMonitor::TestRouter(const std::string& host) {
+    return OdbcHelper::TestConnectionToServer(*(this->router_connection_template), host);
+}
 
-        // LimitlessQueryHelper::QueryForLimitlessRouters will return an empty vector on an error
-        // if it was a connection error, then the next loop will catch it and attempt to reconnect
-        if (!new_limitless_routers.empty()) {
-            std::lock_guard<std::mutex> guard(*(this->limitless_routers_mutex));
-            *(this->limitless_routers) = new_limitless_routers;
+bool LimitlessRouterMonitor::update_router_health(std::vector<HostInfo>& new_limitless_routers) {
+    // test every router off the caller's path, callers keep picking from the routers that are up meanwhile
+    // each test waits for a connection, so they run at once; deferred to this thread if no thread can be started
+    auto probe_start = std::chrono::steady_clock::now();
+    std::vector<std::future<bool>> probes;
+    for (const HostInfo& router : new_limitless_routers) {
+        probes.push_back(std::async(std::launch::async | std::launch::deferred, [this, host = router.GetHost()] {
+            return this->TestRouter(host);
+        }));
+    }
+    std::unordered_set<std::string> unreachable;
+    for (size_t i = 0; i < probes.size(); i++) {
+        if (!probes[i].get()) {
+            unreachable.insert(new_limitless_routers[i].GetHost());
         }
     }
 
-    OdbcHelper::Cleanup(henv, conn, SQL_NULL_HSTMT);
+    std::lock_guard<std::mutex> guard(*(this->limitless_routers_mutex));
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> still_down;
+    for (HostInfo& router : new_limitless_routers) {
+        const std::string& host = router.GetHost();
+        auto itr = this->down_routers.find(host);
+        bool was_down = itr != this->down_routers.end();
+        if (unreachable.contains(host)) {
+            if (!was_down) {
+                LOG(INFO) << "Limitless router " << host << " is unreachable";
+            }
+            still_down[host] = was_down ? itr->second : probe_start;
+        } else if (was_down && itr->second >= probe_start) {
+            // reported again while it was tested
+            still_down.insert(*itr);
+        } else if (was_down) {
+            LOG(INFO) << "Limitless router " << host << " is reachable again";
+        }
+        router.SetHostState(still_down.contains(host) ? DOWN : UP);
+    }
+    // forget routers that were removed from the shard group
+    this->down_routers = std::move(still_down);
+    *(this->limitless_routers) = new_limitless_routers;
+    return !this->down_routers.empty();
+}
+
+void LimitlessRouterMonitor::retest_known_routers() {
+    std::vector<HostInfo> known_routers;
+    {
+        std::lock_guard<std::mutex> guard(*(this->limitless_routers_mutex));
+        known_routers = *(this->limitless_routers);
+    }
+    this->update_router_health(known_routers);
 }
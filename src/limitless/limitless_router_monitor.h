@@ -20,15 +20,25 @@
 #endif
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
-#include <thread>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <sql.h>
 
 #include "../host_info.h"
+#include "limitless_poll_interval.h"
+#include "../util/connection_string_helper.h"
 #include "../util/string_helper.h"
 
+// weight of the latest load sample in the moving average of a router's load
+#define DEFAULT_LIMITLESS_LOAD_SMOOTHING 0.5
+// polls back off up to this multiple of the monitor interval while the routers do not change
+#define DEFAULT_LIMITLESS_MONITOR_MAX_INTERVAL_FACTOR 4
+
 class LimitlessRouterMonitor {
 public:
     LimitlessRouterMonitor();
@@ -48,6 +58,13 @@ public:
 
     virtual bool IsStopped();
 
+    /**
+     * Marks a router a caller failed to connect to as down, so it is no longer selected.
+     * Each poll also tests the connection to every router, marks those it cannot reach down, and marks them up again
+     * once it succeeds. When a poll fails, the routers from the last poll are tested instead.
+     */
+    void MarkRouterDown(const std::string& host);
+
     SQLSTR GetConnectionString() {
         return this->connection_string;
     }
@@ -58,13 +75,43 @@ protected:
 
     unsigned int interval_ms;
 
+    // delay between polls, only used by the poll task once it is scheduled
+    LimitlessPollInterval poll_interval;
+
+    double load_smoothing = DEFAULT_LIMITLESS_LOAD_SMOOTHING;
+
+    // moving average of each router's load, only used by the poll task once it is scheduled
+    std::unordered_map<std::string, double> smoothed_loads;
+
     std::shared_ptr<std::vector<HostInfo>> limitless_routers;
 
     std::shared_ptr<std::mutex> limitless_routers_mutex;
 
-    std::shared_ptr<std::thread> monitor_thread = nullptr;
+    // polls run on the shared RefreshScheduler, 0 while none is scheduled
+    std::atomic<uint64_t> poll_task_id = 0;
+
+    // handles of the monitor connection, only used by the poll task once it is scheduled
+    SQLHENV henv = SQL_NULL_HANDLE;
+    SQLHDBC conn = SQL_NULL_HANDLE;
+    int host_port = 0;
+
+    // Routers reported down and when they were last reported, guarded by limitless_routers_mutex
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> down_routers;
+
+    // Connection string to test routers with, limitless disabled
+    std::shared_ptr<const ConnectionStringTemplate> router_connection_template;
+
+    // tests the connection to a single router, limitless disabled
+    virtual bool TestRouter(const std::string& host);
+
+    // tests every router in parallel, publishes them with their health, and returns whether routers are down
+    bool update_router_health(std::vector<HostInfo>& new_limitless_routers);
+
+    // the routers could not be polled, test the ones from the last poll so callers stop picking unreachable ones
+    void retest_known_routers();
 
-    void Run(SQLHENV henv, SQLHDBC conn, SQLTCHAR *connection_string, SQLSMALLINT connection_string_len, int host_port);
+    // polls the routers once, and returns the delay before the next poll
+    std::chrono::milliseconds Run();
 };
 
 #endif // LIMITLESSROUTERMONITOR_H_
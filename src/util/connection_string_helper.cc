@@ -14,23 +14,66 @@
 
 #include "connection_string_helper.h"
 
-#include <regex>
+#include <algorithm>
 #include <sstream>
 
-void ConnectionStringHelper::ParseConnectionString(const SQLSTR &connection_string, std::map<SQLSTR, SQLSTR> &dest_map) {
-    RDSREGEX pattern(TEXT("([^;=]+)=([^;]+)"));
-    RDSSTRMATCH match;
-    SQLSTR conn_str = connection_string;
+#include "connection_string_keys.h"
+
+bool ConnectionStringHelper::NextAttribute(RDSSTRVIEW connection_string, size_t &pos, ConnectionStringAttribute &attribute) {
+    const size_t size = connection_string.size();
+    while (pos < size) {
+        size_t key_start = pos;
+        size_t key_end = connection_string.find_first_of(TEXT(";="), key_start);
+        if (key_end == RDSSTRVIEW::npos || connection_string[key_end] == TEXT(';')) {
+            pos = key_end == RDSSTRVIEW::npos ? size : key_end + 1;
+            continue;
+        }
+
+        size_t value_start = key_end + 1;
+        size_t value_end = value_start;
+        if (value_end < size && connection_string[value_end] == TEXT('{')) {
+            // Skip to the closing brace, "}}" is an escaped brace
+            for (value_end++; value_end < size; value_end++) {
+                if (connection_string[value_end] == TEXT('}')) {
+                    if (value_end + 1 < size && connection_string[value_end + 1] == TEXT('}')) {
+                        value_end++;
+                        continue;
+                    }
+                    value_end++;
+                    break;
+                }
+            }
+        }
+        value_end = std::min(connection_string.find(TEXT(';'), value_end), size);
+        pos = value_end < size ? value_end + 1 : size;
+
+        if (key_end > key_start) {
+            attribute.key = connection_string.substr(key_start, key_end - key_start);
+            attribute.value = connection_string.substr(value_start, value_end - value_start);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ConnectionStringHelper::KeyEquals(RDSSTRVIEW key1, RDSSTRVIEW key2) {
+    return std::equal(key1.begin(), key1.end(), key2.begin(), key2.end(), [](RDSCHAR c1, RDSCHAR c2) {
+        return StringHelper::ToUpper(c1) == StringHelper::ToUpper(c2);
+    });
+}
 
-    while (std::regex_search(conn_str, match, pattern)) {
-        SQLSTR key = match[1].str();
+void ConnectionStringHelper::ParseConnectionString(const SQLSTR &connection_string, std::map<SQLSTR, SQLSTR> &dest_map) {
+    size_t pos = 0;
+    ConnectionStringAttribute attribute;
+    while (NextAttribute(connection_string, pos, attribute)) {
+        if (attribute.value.empty()) {
+            continue;
+        }
+        SQLSTR key(attribute.key);
         std::transform(key.begin(), key.end(), key.begin(), [](RDSCHAR c) {
             return StringHelper::ToUpper(c);
         });
-        SQLSTR val = match[2].str();
-        dest_map[key] = val;
-
-        conn_str = match.suffix().str();
+        dest_map.insert_or_assign(std::move(key), SQLSTR(attribute.value));
     }
 }
 
@@ -44,3 +87,105 @@ SQLSTR ConnectionStringHelper::BuildConnectionString(std::map<SQLSTR, SQLSTR> &i
     }
     return conn_stream.str();
 }
+
+ConnectionStringIndex::ConnectionStringIndex(RDSSTRVIEW connection_string) : connection_string_(connection_string) {
+    size_t pos = 0;
+    ConnectionStringAttribute attribute;
+    while (ConnectionStringHelper::NextAttribute(connection_string_, pos, attribute)) {
+        attributes_.push_back(attribute);
+    }
+}
+
+bool ConnectionStringIndex::Contains(RDSSTRVIEW key) const {
+    return std::any_of(attributes_.begin(), attributes_.end(), [key](const ConnectionStringAttribute& attribute) {
+        return ConnectionStringHelper::KeyEquals(attribute.key, key);
+    });
+}
+
+RDSSTRVIEW ConnectionStringIndex::Get(RDSSTRVIEW key) const {
+    for (auto itr = attributes_.rbegin(); itr != attributes_.rend(); ++itr) {
+        if (ConnectionStringHelper::KeyEquals(itr->key, key)) {
+            return itr->value;
+        }
+    }
+    return RDSSTRVIEW();
+}
+
+SQLSTR ConnectionStringIndex::With(ConnectionStringOverrides overrides, bool append_missing) const {
+    size_t capacity = connection_string_.size();
+    for (const auto& [key, value] : overrides) {
+        capacity += key.size() + value.size() + 2;
+    }
+    SQLSTR result;
+    result.reserve(capacity);
+
+    // Copy everything between the values that are replaced
+    size_t copied = 0;
+    for (const ConnectionStringAttribute& attribute : attributes_) {
+        for (const auto& [key, value] : overrides) {
+            if (ConnectionStringHelper::KeyEquals(attribute.key, key)) {
+                size_t value_start = attribute.value.data() - connection_string_.data();
+                result.append(connection_string_.substr(copied, value_start - copied));
+                result.append(value);
+                copied = value_start + attribute.value.size();
+                break;
+            }
+        }
+    }
+    result.append(connection_string_.substr(copied));
+
+    if (append_missing) {
+        for (const auto& [key, value] : overrides) {
+            if (Contains(key)) {
+                continue;
+            }
+            if (!result.empty() && result.back() != TEXT(';')) {
+                result.push_back(TEXT(';'));
+            }
+            result.append(key);
+            result.push_back(TEXT('='));
+            result.append(value);
+        }
+    }
+    return result;
+}
+
+ConnectionStringTemplate::ConnectionStringTemplate(RDSSTRVIEW connection_string, ConnectionStringOverrides overrides, bool append_missing) {
+    SQLSTR conn_str = ConnectionStringIndex(connection_string).With(overrides, append_missing);
+    ConnectionStringIndex index(conn_str);
+
+    const ConnectionStringAttribute* server = nullptr;
+    for (const ConnectionStringAttribute& attribute : index.GetAttributes()) {
+        if (ConnectionStringHelper::KeyEquals(attribute.key, SERVER_HOST_KEY)) {
+            server = &attribute;
+        }
+    }
+
+    if (server) {
+        size_t value_start = server->value.data() - conn_str.data();
+        prefix_ = conn_str.substr(0, value_start);
+        suffix_ = conn_str.substr(value_start + server->value.size());
+        has_server_slot_ = true;
+    } else {
+        prefix_ = conn_str;
+        if (append_missing) {
+            if (!prefix_.empty() && prefix_.back() != TEXT(';')) {
+                prefix_.push_back(TEXT(';'));
+            }
+            prefix_.append(SERVER_HOST_KEY);
+            prefix_.push_back(TEXT('='));
+            has_server_slot_ = true;
+        }
+    }
+}
+
+SQLSTR ConnectionStringTemplate::ForHost(RDSSTRVIEW host) const {
+    SQLSTR result;
+    result.reserve(prefix_.size() + host.size() + suffix_.size());
+    result.append(prefix_);
+    if (has_server_slot_) {
+        result.append(host);
+    }
+    result.append(suffix_);
+    return result;
+}
@@ -15,16 +15,43 @@
 #ifndef CONNECTION_STRING_HELPER_H_
 #define CONNECTION_STRING_HELPER_H_
 
+#include <initializer_list>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "string_helper.h"
 
+// Attribute values to set, by key
+typedef std::initializer_list<std::pair<RDSSTRVIEW, RDSSTRVIEW>> ConnectionStringOverrides;
+
+/**
+ * One KEY=VALUE attribute of a connection string, as views into the string it was read from.
+ * Brace quoted values keep their braces, so they can be copied back as they are.
+ */
+struct ConnectionStringAttribute {
+    RDSSTRVIEW key;
+    RDSSTRVIEW value;
+};
+
 class ConnectionStringHelper {
 public:
+    /**
+     * Reads the next attribute at or after pos and moves pos past it, without copying anything.
+     * Values may be enclosed in braces to contain ';', with "}}" standing for a '}'.
+     * Segments without a key or a '=' are skipped. Returns false at the end of the connection string.
+     */
+    static bool NextAttribute(RDSSTRVIEW connection_string, size_t &pos, ConnectionStringAttribute &attribute);
+
+    /**
+     * Compares attribute keys, ignoring case
+     */
+    static bool KeyEquals(RDSSTRVIEW key1, RDSSTRVIEW key2);
+
     /**
      * Parses the input connection string into the destination map as key-value pairs.
-     * Returns -1 on error and the number of items in dest_map on success.
+     * Keys are upper cased, attributes with an empty value are skipped.
      */
     static void ParseConnectionString(const SQLSTR &connection_string, std::map<SQLSTR, SQLSTR> &dest_map);
 
@@ -34,4 +61,56 @@ public:
     static SQLSTR BuildConnectionString(std::map<SQLSTR, SQLSTR> &input_map);
 };
 
+/**
+ * Flat index of the attributes of a connection string, to look up or override a few keys without
+ * building a map. Holds views into the connection string, which has to outlive the index.
+ */
+class ConnectionStringIndex {
+public:
+    explicit ConnectionStringIndex(RDSSTRVIEW connection_string);
+
+    bool Contains(RDSSTRVIEW key) const;
+
+    /**
+     * Value of the last attribute with the key, like ParseConnectionString keeps, empty if there is none
+     */
+    RDSSTRVIEW Get(RDSSTRVIEW key) const;
+
+    /**
+     * Copy of the connection string with the values of the given keys replaced, everything else is kept as is.
+     * Keys the connection string does not have are appended if append_missing is set, and ignored otherwise.
+     */
+    SQLSTR With(ConnectionStringOverrides overrides, bool append_missing) const;
+
+    const std::vector<ConnectionStringAttribute>& GetAttributes() const {
+        return attributes_;
+    }
+
+private:
+    RDSSTRVIEW connection_string_;
+    std::vector<ConnectionStringAttribute> attributes_;
+};
+
+/**
+ * Connection string split around the value of its SERVER attribute, so the connection string for another host
+ * is only a concatenation. Built once per service instead of parsing the connection string for every host.
+ */
+class ConnectionStringTemplate {
+public:
+    ConnectionStringTemplate() = default;
+
+    /**
+     * Applies the overrides once, like ConnectionStringIndex::With. The SERVER slot is the last SERVER attribute,
+     * without one the slot is appended if append_missing is set, and ForHost ignores the host otherwise.
+     */
+    ConnectionStringTemplate(RDSSTRVIEW connection_string, ConnectionStringOverrides overrides, bool append_missing);
+
+    SQLSTR ForHost(RDSSTRVIEW host) const;
+
+private:
+    SQLSTR prefix_;
+    SQLSTR suffix_;
+    bool has_server_slot_ = false;
+};
+
 #endif
@@ -19,6 +19,7 @@
 
 // Generic
 #define SERVER_HOST_KEY TEXT("SERVER")
+#define REFRESH_POOL_SIZE_KEY TEXT("REFRESHPOOLSIZE")
 
 #define BOOL_FALSE TEXT("0")
 #define BOOL_TRUE TEXT("1")
@@ -29,6 +30,12 @@
 #define LIMITLESS_MODE_VALUE_LAZY TEXT("lazy")
 #define LIMITLESS_MODE_VALUE_IMMEDIATE TEXT("immediate")
 #define LIMITLESS_MONITOR_INTERVAL_MS_KEY TEXT("LIMITLESSMONITORINTERVALMS")
+#define LIMITLESS_MONITOR_MAX_INTERVAL_MS_KEY TEXT("LIMITLESSMONITORMAXINTERVALMS")
+#define LIMITLESS_LOAD_SMOOTHING_KEY TEXT("LIMITLESSLOADSMOOTHING")
+#define LIMITLESS_ROUTER_SELECTION_KEY TEXT("LIMITLESSROUTERSELECTION")
+#define LIMITLESS_ROUTER_SELECTION_VALUE_ROUND_ROBIN TEXT("round_robin")
+#define LIMITLESS_ROUTER_SELECTION_VALUE_POWER_OF_TWO TEXT("power_of_two")
+#define LIMITLESS_ROUTER_SELECTION_VALUE_LEAST_OUTSTANDING TEXT("least_outstanding")
 
 // Failover
 #define ENABLE_FAILOVER_KEY TEXT("ENABLECLUSTERFAILOVER")
@@ -42,6 +49,13 @@
 #define HIGH_REFRESH_RATE_KEY TEXT("TOPOLOGYHIGHREFRESHRATE")
 #define REFRESH_RATE_KEY TEXT("TOPOLOGYREFRESHRATE")
 #define FAILOVER_TIMEOUT_KEY TEXT("FAILOVERTIMEOUT")
+#define FAILOVER_READER_FANOUT_KEY TEXT("FAILOVERREADERFANOUT")
+#define FAILOVER_STANDBY_CONNECTIONS_KEY TEXT("FAILOVERSTANDBYCONNECTIONS")
+#define FAILOVER_STANDBY_REFRESH_RATE_KEY TEXT("FAILOVERSTANDBYREFRESHRATE")
+#define CONNECTION_POOL_IDLE_TTL_KEY TEXT("CONNECTIONPOOLIDLETTL")
+#define CONNECTION_POOL_MAX_IDLE_KEY TEXT("CONNECTIONPOOLMAXIDLE")
 #define CLUSTER_ID_KEY TEXT("CLUSTERID")
+#define NODE_PROBE_POOL_SIZE_KEY TEXT("NODEPROBEPOOLSIZE")
+#define NODE_PROBE_MAX_PROBES_KEY TEXT("NODEPROBEMAXPROBES")
 
 #endif // CONNECTION_STRING_KEYS_H
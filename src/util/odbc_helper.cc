@@ -195,16 +195,12 @@ std::string OdbcHelper::MergeDiagRecs(SQLHANDLE handle, int32_t handle_type, con
     return StringHelper::MergeStrings(errmsg, custom_errmsg);
 }
 
-bool OdbcHelper::TestConnectionToServer(const SQLSTR &in_conn_str, const std::string &server) {
+bool OdbcHelper::TestConnectionToServer(const ConnectionStringTemplate &conn_template, const std::string &server) {
     SQLHENV henv = nullptr;
     SQLHDBC conn = nullptr;
 
-    // build new connection string, overwriting server to provided server, and disabling limitless to prevent infinite loop
-    std::map<SQLSTR, SQLSTR> connstr_map;
-    ConnectionStringHelper::ParseConnectionString(in_conn_str, connstr_map);
-    connstr_map[SERVER_HOST_KEY] = StringHelper::ToSQLSTR(server);
-    connstr_map[LIMITLESS_ENABLED_KEY] = BOOL_FALSE;
-    SQLSTR connstr = ConnectionStringHelper::BuildConnectionString(connstr_map);
+    // the template already disables limitless to prevent an infinite loop
+    SQLSTR connstr = conn_template.ForHost(StringHelper::ToSQLSTR(server));
 
     // allocate environment and connection handles
     if (!OdbcHelper::AllocateHandle(SQL_HANDLE_ENV, nullptr, henv, "Couldn't allocate environment handle in LimitlessRouterMonitor::TestConnectionToHost") ||
@@ -12,46 +12,287 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#ifdef WIN32
-#include <windows.h>
-#endif
-
-#include <cstring>
 
 #include "rds_utils.h"
-#include "string_helper.h"
+
+#include <algorithm>
+#include <array>
 
 namespace {
-    const std::regex AURORA_DNS_PATTERN(
-        R"#((.+)\.(proxy-|cluster-|cluster-ro-|cluster-custom-|shardgrp-)?([a-zA-Z0-9]+\.([a-zA-Z0-9\-]+)\.rds\.amazonaws\.com))#",
-        std::regex_constants::icase);
-    const std::regex AURORA_PROXY_DNS_PATTERN(R"#((.+)\.(proxy-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#", std::regex_constants::icase);
-    const std::regex AURORA_CLUSTER_PATTERN(R"#((.+)\.(cluster-|cluster-ro-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
-                                            std::regex_constants::icase);
-    const std::regex AURORA_WRITER_CLUSTER_PATTERN(R"#((.+)\.(cluster-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
-                                                   std::regex_constants::icase);
-    const std::regex AURORA_READER_CLUSTER_PATTERN(R"#((.+)\.(cluster-ro-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
-                                                   std::regex_constants::icase);
-    const std::regex AURORA_CUSTOM_CLUSTER_PATTERN(R"#((.+)\.(cluster-custom-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
-                                                   std::regex_constants::icase);
-    const std::regex AURORA_CHINA_DNS_PATTERN(
-        R"#((.+)\.(proxy-|cluster-|cluster-ro-|cluster-custom-|shardgrp-)?([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#",
-        std::regex_constants::icase);
-    const std::regex AURORA_CHINA_PROXY_DNS_PATTERN(
-        R"#((.+)\.(proxy-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
-    const std::regex AURORA_CHINA_CLUSTER_PATTERN(
-        R"#((.+)\.(cluster-|cluster-ro-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#",
-        std::regex_constants::icase);
-    const std::regex AURORA_CHINA_WRITER_CLUSTER_PATTERN(
-        R"#((.+)\.(cluster-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
-    const std::regex AURORA_CHINA_READER_CLUSTER_PATTERN(
-        R"#((.+)\.(cluster-ro-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
-    const std::regex AURORA_CHINA_CUSTOM_CLUSTER_PATTERN(
-        R"#((.+)\.(cluster-custom-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
-    const std::regex IPV4_PATTERN(
-        R"#(^(([1-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])\.){1}(([0-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])\.){2}([0-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])$)#");
-    const std::regex IPV6_PATTERN(R"#(^[0-9a-fA-F]{1,4}(:[0-9a-fA-F]{1,4}){7}$)#");
-    const std::regex IPV6_COMPRESSED_PATTERN(R"#(^(([0-9A-Fa-f]{1,4}(:[0-9A-Fa-f]{1,4}){0,5})?)::(([0-9A-Fa-f]{1,4}(:[0-9A-Fa-f]{1,4}){0,5})?)$)#");
+    constexpr std::string_view RDS_DOMAIN_SUFFIX = ".rds.amazonaws.com";
+    constexpr std::string_view CHINA_DOMAIN_SUFFIX = ".amazonaws.com.cn";
+    constexpr std::string_view RDS_LABEL = "rds";
+
+    constexpr std::string_view PROXY_PREFIX = "proxy-";
+    constexpr std::string_view CLUSTER_PREFIX = "cluster-";
+    constexpr std::string_view CLUSTER_RO_PREFIX = "cluster-ro-";
+    constexpr std::string_view CLUSTER_CUSTOM_PREFIX = "cluster-custom-";
+    constexpr std::string_view SHARDGRP_PREFIX = "shardgrp-";
+
+    constexpr std::array<std::pair<std::string_view, RdsPrefixType>, 5> PREFIX_TYPES = {{
+        { PROXY_PREFIX, RdsPrefixType::PROXY },
+        { CLUSTER_PREFIX, RdsPrefixType::CLUSTER },
+        { CLUSTER_RO_PREFIX, RdsPrefixType::CLUSTER_RO },
+        { CLUSTER_CUSTOM_PREFIX, RdsPrefixType::CLUSTER_CUSTOM },
+        { SHARDGRP_PREFIX, RdsPrefixType::SHARDGRP }
+    }};
+
+    bool is_alnum(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    }
+
+    bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    bool is_hex(char c) {
+        return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    // Compares against a lower case literal, ignoring the case of str
+    bool equals_ignore_case(std::string_view str, std::string_view lower) {
+        if (str.size() != lower.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < str.size(); i++) {
+            char c = str[i];
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+            if (c != lower[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool starts_with_ignore_case(std::string_view str, std::string_view lower) {
+        return str.size() >= lower.size() && equals_ignore_case(str.substr(0, lower.size()), lower);
+    }
+
+    // End of a non empty label of letters, digits and dashes starting at pos, that is followed by a dot
+    size_t find_region_label_end(std::string_view host, size_t pos) {
+        size_t end = pos;
+        while (end < host.size() && (is_alnum(host[end]) || host[end] == '-')) {
+            end++;
+        }
+        return (end > pos && end < host.size() && host[end] == '.') ? end : std::string_view::npos;
+    }
+
+    RdsPrefixType get_prefix_type(std::string_view prefix) {
+        for (const auto& [prefix_str, type] : PREFIX_TYPES) {
+            if (equals_ignore_case(prefix, prefix_str)) {
+                return type;
+            }
+        }
+        return RdsPrefixType::NONE;
+    }
+
+    // The generic endpoint allows at most one prefix
+    bool is_endpoint_prefix(std::string_view prefix) {
+        return prefix.empty() || get_prefix_type(prefix) != RdsPrefixType::NONE;
+    }
+
+    // The endpoint type checks allow any repetition of their prefixes
+    bool is_repeated_prefix(std::string_view prefix, std::initializer_list<std::string_view> allowed) {
+        for (std::string_view allowed_prefix : allowed) {
+            if (starts_with_ignore_case(prefix, allowed_prefix) &&
+                (prefix.size() == allowed_prefix.size() || is_repeated_prefix(prefix.substr(allowed_prefix.size()), allowed))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool is_proxy_prefix(std::string_view prefix) {
+        return is_repeated_prefix(prefix, { PROXY_PREFIX });
+    }
+
+    bool is_cluster_prefix(std::string_view prefix) {
+        return is_repeated_prefix(prefix, { CLUSTER_PREFIX, CLUSTER_RO_PREFIX });
+    }
+
+    bool is_writer_cluster_prefix(std::string_view prefix) {
+        return is_repeated_prefix(prefix, { CLUSTER_PREFIX });
+    }
+
+    bool is_reader_cluster_prefix(std::string_view prefix) {
+        return is_repeated_prefix(prefix, { CLUSTER_RO_PREFIX });
+    }
+
+    bool is_custom_cluster_prefix(std::string_view prefix) {
+        return is_repeated_prefix(prefix, { CLUSTER_CUSTOM_PREFIX });
+    }
+
+    /**
+     * Domain of an endpoint, "<prefix><label>.<region>.rds.amazonaws.com" or in China
+     * "<prefix><label>.rds.<region>.amazonaws.com.cn" and "<prefix><label>.<region>.rds.amazonaws.com.cn".
+     */
+    struct Domain {
+        std::string_view prefix;
+        // Everything from the label to the end of the DNS suffix
+        std::string_view domain;
+        // Includes the "rds" label in China
+        std::string_view region;
+    };
+
+    // Matches a domain starting at pos, anything after its DNS suffix is left to the caller
+    bool match_domain(std::string_view host, size_t pos, bool china, Domain& domain) {
+        size_t label_end = host.find('.', pos);
+        if (label_end == std::string_view::npos) {
+            return false;
+        }
+
+        // Prefixes all end with a dash, the label is whatever follows the last one
+        std::string_view first_label = host.substr(pos, label_end - pos);
+        size_t label_start = first_label.rfind('-');
+        label_start = label_start == std::string_view::npos ? 0 : label_start + 1;
+        if (label_start == first_label.size() || !std::all_of(first_label.begin() + label_start, first_label.end(), is_alnum)) {
+            return false;
+        }
+
+        size_t region_start = label_end + 1;
+        size_t region_end = find_region_label_end(host, region_start);
+        if (region_end == std::string_view::npos) {
+            return false;
+        }
+        std::string_view suffix = RDS_DOMAIN_SUFFIX;
+        if (china) {
+            size_t second_region_end = find_region_label_end(host, region_end + 1);
+            if (second_region_end == std::string_view::npos ||
+                (!equals_ignore_case(host.substr(region_start, region_end - region_start), RDS_LABEL) &&
+                 !equals_ignore_case(host.substr(region_end + 1, second_region_end - region_end - 1), RDS_LABEL))) {
+                return false;
+            }
+            region_end = second_region_end;
+            suffix = CHINA_DOMAIN_SUFFIX;
+        }
+        if (!starts_with_ignore_case(host.substr(region_end), suffix)) {
+            return false;
+        }
+
+        domain.prefix = first_label.substr(0, label_start);
+        domain.domain = host.substr(pos + label_start, region_end + suffix.size() - pos - label_start);
+        domain.region = host.substr(region_start, region_end - region_start);
+        return true;
+    }
+
+    // The whole host has to be "<id>.<domain>", with an id that does not span lines
+    bool match_host(std::string_view host, bool china, Domain& domain) {
+        // The domain has four dots, five in China, the id ends at the dot in front of them
+        size_t dot = host.size();
+        for (int i = 0; i < (china ? 6 : 5); i++) {
+            if (dot == 0 || (dot = host.rfind('.', dot - 1)) == std::string_view::npos) {
+                return false;
+            }
+        }
+        return dot > 0 && host.substr(0, dot).find_first_of("\r\n") == std::string_view::npos &&
+               match_domain(host, dot + 1, china, domain) &&
+               domain.domain.data() + domain.domain.size() == host.data() + host.size();
+    }
+
+    struct Search {
+        bool china = false;
+        bool (*is_prefix)(std::string_view) = nullptr;
+        bool found = false;
+        std::string_view id = {};
+        Domain domain = {};
+    };
+
+    /**
+     * Finds the first "<id>.<domain>" in the host, where the id is as long as possible and does not span lines.
+     * All searches are done in the same pass, from the last dot of each line to the first.
+     */
+    template <size_t N>
+    void search_host(std::string_view host, std::array<Search, N>& searches) {
+        size_t pending = N;
+        size_t line_start = 0;
+        while (pending > 0 && line_start < host.size()) {
+            size_t line_end = std::min(host.find_first_of("\r\n", line_start), host.size());
+            std::string_view line = host.substr(line_start, line_end - line_start);
+            for (size_t dot = line.rfind('.'); pending > 0 && dot != std::string_view::npos && dot > 0; dot = line.rfind('.', dot - 1)) {
+                std::array<Domain, 2> domains;
+                std::array<bool, 2> matched = { match_domain(line, dot + 1, false, domains[0]), match_domain(line, dot + 1, true, domains[1]) };
+                for (Search& search : searches) {
+                    if (!search.found && matched[search.china] && search.is_prefix(domains[search.china].prefix)) {
+                        search.found = true;
+                        search.id = line.substr(0, dot);
+                        search.domain = domains[search.china];
+                        pending--;
+                    }
+                }
+            }
+            line_start = line_end + 1;
+        }
+    }
+
+    // Groups of one to four hex digits separated by single colons
+    bool is_hex_groups(std::string_view str, size_t min_groups, size_t max_groups) {
+        size_t groups = 0;
+        size_t pos = 0;
+        while (true) {
+            size_t end = std::min(str.find(':', pos), str.size());
+            if (end == pos || end - pos > 4 || !std::all_of(str.begin() + pos, str.begin() + end, is_hex)) {
+                return false;
+            }
+            groups++;
+            if (end == str.size()) {
+                break;
+            }
+            pos = end + 1;
+        }
+        return groups >= min_groups && groups <= max_groups;
+    }
+}
+
+RdsHostInfo RdsUtils::ParseHost(std::string_view host) {
+    RdsHostInfo info;
+    for (bool china : { false, true }) {
+        Domain domain;
+        if (match_host(host, china, domain)) {
+            info.is_rds_dns |= is_endpoint_prefix(domain.prefix);
+            info.is_rds_cluster_dns |= is_cluster_prefix(domain.prefix);
+            info.is_rds_proxy_dns |= is_proxy_prefix(domain.prefix);
+            info.is_rds_writer_cluster_dns |= is_writer_cluster_prefix(domain.prefix);
+            info.is_rds_reader_cluster_dns |= is_reader_cluster_prefix(domain.prefix);
+            info.is_rds_custom_cluster_dns |= is_custom_cluster_prefix(domain.prefix);
+        }
+    }
+
+    // Lookups fall back to the China endpoints when the host does not contain another endpoint
+    std::array<Search, 4> searches = {{
+        { false, is_endpoint_prefix },
+        { true, is_endpoint_prefix },
+        { false, is_cluster_prefix },
+        { true, is_cluster_prefix }
+    }};
+    search_host(host, searches);
+
+    for (size_t i = 0; i < 2; i++) {
+        const Search& search = searches[i];
+        if (!search.found) {
+            continue;
+        }
+        if (info.instance_host_domain.empty()) {
+            info.is_china = search.china;
+            info.prefix_type = get_prefix_type(search.domain.prefix);
+            info.instance_host_domain = search.domain.domain;
+            info.region = search.domain.region;
+        }
+        if (info.cluster_id.empty() && !search.domain.prefix.empty()) {
+            info.cluster_id = search.id;
+        }
+        if (info.instance_id.empty() && search.domain.prefix.empty()) {
+            info.instance_id = search.id;
+        }
+    }
+    for (size_t i = 2; i < 4 && info.cluster_host_id.empty(); i++) {
+        if (searches[i].found) {
+            info.cluster_host_id = searches[i].id;
+            info.cluster_host_domain = searches[i].domain.domain;
+        }
+    }
+    return info;
 }
 
 bool RdsUtils::IsDnsPatternValid(const std::string& host) {
@@ -59,132 +300,99 @@ bool RdsUtils::IsDnsPatternValid(const std::string& host) {
 }
 
 bool RdsUtils::IsRdsDns(const std::string& host) {
-    return std::regex_match(host, AURORA_DNS_PATTERN) || std::regex_match(host, AURORA_CHINA_DNS_PATTERN);
+    return ParseHost(host).is_rds_dns;
 }
 
 bool RdsUtils::IsRdsClusterDns(const std::string& host) {
-    return std::regex_match(host, AURORA_CLUSTER_PATTERN) || std::regex_match(host, AURORA_CHINA_CLUSTER_PATTERN);
+    return ParseHost(host).is_rds_cluster_dns;
 }
 
 bool RdsUtils::IsRdsProxyDns(const std::string& host) {
-    return std::regex_match(host, AURORA_PROXY_DNS_PATTERN) || std::regex_match(host, AURORA_CHINA_PROXY_DNS_PATTERN);
+    return ParseHost(host).is_rds_proxy_dns;
 }
 
 bool RdsUtils::IsRdsWriterClusterDns(const std::string& host) {
-    return std::regex_match(host, AURORA_WRITER_CLUSTER_PATTERN) || std::regex_match(host, AURORA_CHINA_WRITER_CLUSTER_PATTERN);
+    return ParseHost(host).is_rds_writer_cluster_dns;
 }
 
 bool RdsUtils::IsRdsReaderClusterDns(const std::string& host) {
-    return std::regex_match(host, AURORA_READER_CLUSTER_PATTERN) || std::regex_match(host, AURORA_CHINA_READER_CLUSTER_PATTERN);
+    return ParseHost(host).is_rds_reader_cluster_dns;
 }
 
 bool RdsUtils::IsRdsCustomClusterDns(const std::string& host) {
-    return std::regex_match(host, AURORA_CUSTOM_CLUSTER_PATTERN) || std::regex_match(host, AURORA_CHINA_CUSTOM_CLUSTER_PATTERN);
+    return ParseHost(host).is_rds_custom_cluster_dns;
 }
 
 std::string RdsUtils::GetRdsClusterHostUrl(const std::string& host) {
-    auto f = [ host ](const std::regex& pattern) {
-        std::smatch m;
-        if (std::regex_search(host, m, pattern) && m.size() > 1) {
-            std::string gr1 = m.size() > 1 ? m.str(1) : std::string("");
-            std::string gr2 = m.size() > 2 ? m.str(2) : std::string("");
-            std::string gr3 = m.size() > 3 ? m.str(3) : std::string("");
-            if (!gr1.empty() && !gr3.empty() &&
-                (strcmp_case_insensitive(gr2.c_str(), "cluster-") == 0 || strcmp_case_insensitive(gr2.c_str(), "cluster-ro-") == 0)) {
-                std::string result;
-                result.assign(gr1);
-                result.append(".cluster-");
-                result.append(gr3);
-
-                return result;
-            }
-        }
+    RdsHostInfo info = ParseHost(host);
+    if (info.cluster_host_id.empty()) {
         return std::string();
-    };
-
-    auto result = f(AURORA_CLUSTER_PATTERN);
-    if (!result.empty()) {
-        return result;
     }
 
-    return f(AURORA_CHINA_CLUSTER_PATTERN);
+    std::string result;
+    result.reserve(info.cluster_host_id.size() + CLUSTER_PREFIX.size() + info.cluster_host_domain.size() + 1);
+    result.append(info.cluster_host_id);
+    result.append(".");
+    result.append(CLUSTER_PREFIX);
+    result.append(info.cluster_host_domain);
+    return result;
 }
 
 std::string RdsUtils::GetRdsClusterId(const std::string& host) {
-    auto f = [ host ](const std::regex& pattern) {
-        std::smatch m;
-        if (std::regex_search(host, m, pattern) && m.size() > 1 && !m.str(2).empty()) {
-            return m.str(1);
-        }
-        return std::string();
-    };
-
-    auto result = f(AURORA_DNS_PATTERN);
-    if (!result.empty()) {
-        return result;
-    }
-
-    return f(AURORA_CHINA_DNS_PATTERN);
+    return std::string(ParseHost(host).cluster_id);
 }
 
 std::string RdsUtils::GetRdsInstanceId(const std::string& host) {
-    auto f = [ host ](const std::regex& pattern) {
-        std::smatch m;
-        if (std::regex_search(host, m, pattern) && m.size() > 1 && m.str(2).empty()) {
-            return m.str(1);
-        }
-        return std::string();
-    };
-
-    auto result = f(AURORA_DNS_PATTERN);
-    if (!result.empty()) {
-        return result;
-    }
-
-    return f(AURORA_CHINA_DNS_PATTERN);
+    return std::string(ParseHost(host).instance_id);
 }
 
 std::string RdsUtils::GetRdsInstanceHostPattern(const std::string& host) {
-    auto f = [ host ](const std::regex& pattern) {
-        std::smatch m;
-        if (std::regex_search(host, m, pattern) && m.size() > 4 && !m.str(3).empty()) {
-            std::string result("?.");
-            result.append(m.str(3));
-
-            return result;
-        }
+    RdsHostInfo info = ParseHost(host);
+    if (info.instance_host_domain.empty()) {
         return std::string();
-    };
-
-    auto result = f(AURORA_DNS_PATTERN);
-    if (!result.empty()) {
-        return result;
     }
 
-    return f(AURORA_CHINA_DNS_PATTERN);
+    std::string result("?.");
+    result.append(info.instance_host_domain);
+    return result;
 }
 
 std::string RdsUtils::GetRdsRegion(const std::string& host) {
-    auto f = [ host ](const std::regex& pattern) {
-        std::smatch m;
-        if (std::regex_search(host, m, pattern) && m.size() > 4 && !m.str(4).empty()) {
-            return m.str(4);
-        }
-        return std::string();
-    };
-
-    auto result = f(AURORA_DNS_PATTERN);
-    if (!result.empty()) {
-        return result;
-    }
-
-    return f(AURORA_CHINA_DNS_PATTERN);
+    return std::string(ParseHost(host).region);
 }
 
 bool RdsUtils::IsIpv4(const std::string& host) {
-    return std::regex_match(host, IPV4_PATTERN);
+    // Four decimal octets without leading zeros, the first one cannot be 0
+    size_t pos = 0;
+    for (int i = 0; i < 4; i++) {
+        size_t end = i < 3 ? host.find('.', pos) : host.size();
+        if (end == std::string::npos || end == pos || end - pos > 3 ||
+            !std::all_of(host.begin() + pos, host.begin() + end, is_digit) || (end - pos > 1 && host[pos] == '0')) {
+            return false;
+        }
+        int octet = 0;
+        for (size_t j = pos; j < end; j++) {
+            octet = octet * 10 + (host[j] - '0');
+        }
+        if (octet > 255 || (i == 0 && octet == 0)) {
+            return false;
+        }
+        pos = end + 1;
+    }
+    return true;
 }
 
 bool RdsUtils::IsIpv6(const std::string& host) {
-    return std::regex_match(host, IPV6_PATTERN) || std::regex_match(host, IPV6_COMPRESSED_PATTERN);
+    if (is_hex_groups(host, 8, 8)) {
+        return true;
+    }
+
+    // Compressed form, up to six groups on either side of the "::"
+    size_t separator = host.find("::");
+    if (separator == std::string::npos) {
+        return false;
+    }
+    std::string_view left = std::string_view(host).substr(0, separator);
+    std::string_view right = std::string_view(host).substr(separator + 2);
+    return (left.empty() || is_hex_groups(left, 1, 6)) && (right.empty() || is_hex_groups(right, 1, 6));
 }
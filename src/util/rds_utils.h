@@ -15,10 +15,48 @@
 #ifndef RDS_UTILS_H_
 #define RDS_UTILS_H_
 
-#include <regex>
+#include <string>
+#include <string_view>
+
+enum class RdsPrefixType {
+    NONE,
+    PROXY,
+    CLUSTER,
+    CLUSTER_RO,
+    CLUSTER_CUSTOM,
+    SHARDGRP
+};
+
+/**
+ * Every field RdsUtils extracts from a host, filled in by a single call to RdsUtils::ParseHost.
+ * The views point into the parsed host and are only valid as long as it is.
+ */
+struct RdsHostInfo {
+    bool is_rds_dns = false;
+    bool is_rds_cluster_dns = false;
+    bool is_rds_proxy_dns = false;
+    bool is_rds_writer_cluster_dns = false;
+    bool is_rds_reader_cluster_dns = false;
+    bool is_rds_custom_cluster_dns = false;
+
+    // Endpoint the fields below were taken from
+    bool is_china = false;
+    RdsPrefixType prefix_type = RdsPrefixType::NONE;
+    std::string_view cluster_id;
+    std::string_view instance_id;
+    // Instance host pattern without its leading "?."
+    std::string_view instance_host_domain;
+    std::string_view region;
+
+    // Cluster endpoint is "<cluster_host_id>.cluster-<cluster_host_domain>"
+    std::string_view cluster_host_id;
+    std::string_view cluster_host_domain;
+};
 
 class RdsUtils {
    public:
+    static RdsHostInfo ParseHost(std::string_view host);
+
     static bool IsDnsPatternValid(const std::string& host);
     static bool IsRdsDns(const std::string& host);
     static bool IsRdsClusterDns(const std::string& host);
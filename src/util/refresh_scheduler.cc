@@ -0,0 +1,198 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "refresh_scheduler.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <exception>
+#include <system_error>
+
+#include "logger_wrapper.h"
+
+const uint32_t RefreshScheduler::DEFAULT_POOL_SIZE = 4;
+const std::chrono::milliseconds RefreshScheduler::WORKER_KEEPALIVE = std::chrono::milliseconds(std::chrono::minutes(1));
+
+void RefreshScheduler::Configure(uint32_t pool_size) {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (pool_size > s.pool_size) {
+        LOG(INFO) << "[Refresh Scheduler] keeping up to " << pool_size << " idle workers, previously " << s.pool_size;
+        s.pool_size = pool_size;
+    }
+}
+
+uint64_t RefreshScheduler::Schedule(const Task& task, std::chrono::milliseconds delay) {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    // Lazily started so processes that never monitor anything do not pay for the timer thread
+    if (!s.timer_started) {
+        s.timer_started = true;
+        // Lives as long as the process
+        std::thread(&RefreshScheduler::run_timer).detach();
+    }
+
+    uint64_t task_id = s.next_task_id++;
+    Entry& entry = s.tasks[task_id];
+    entry.task = task;
+    entry.next_run = Clock::now() + std::max(delay, std::chrono::milliseconds(0));
+    s.timers.emplace(entry.next_run, task_id);
+    s.timer_cv.notify_one();
+    return task_id;
+}
+
+void RefreshScheduler::Wake(uint64_t task_id) {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto itr = s.tasks.find(task_id);
+    if (itr == s.tasks.end() || itr->second.running || itr->second.queued) {
+        return;
+    }
+
+    Entry& entry = itr->second;
+    s.timers.erase({ entry.next_run, task_id });
+    entry.next_run = Clock::now();
+    s.timers.emplace(entry.next_run, task_id);
+    s.timer_cv.notify_one();
+}
+
+void RefreshScheduler::Cancel(uint64_t task_id) {
+    State& s = state();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    auto itr = s.tasks.find(task_id);
+    if (itr == s.tasks.end()) {
+        return;
+    }
+
+    Entry& entry = itr->second;
+    if (entry.queued) {
+        s.due.erase(std::find(s.due.begin(), s.due.end(), task_id));
+        s.tasks.erase(itr);
+        return;
+    }
+    if (!entry.running) {
+        s.timers.erase({ entry.next_run, task_id });
+        s.tasks.erase(itr);
+        return;
+    }
+
+    // The worker removes the task once the run in progress returns
+    entry.cancelled = true;
+    if (entry.runner != std::this_thread::get_id()) {
+        s.done_cv.wait(lock, [&s, task_id] { return !s.tasks.contains(task_id); });
+    }
+}
+
+uint32_t RefreshScheduler::GetPoolSize() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.pool_size;
+}
+
+uint32_t RefreshScheduler::GetWorkerCount() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.workers;
+}
+
+size_t RefreshScheduler::GetTaskCount() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.tasks.size();
+}
+
+RefreshScheduler::State& RefreshScheduler::state() {
+    // Never destroyed, monitors held by static objects are cancelled during static destruction
+    static State* s = new State();
+    return *s;
+}
+
+void RefreshScheduler::run_timer() {
+    State& s = state();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    while (true) {
+        if (s.timers.empty()) {
+            s.timer_cv.wait(lock);
+            continue;
+        }
+        auto [next_run, task_id] = *s.timers.begin();
+        if (Clock::now() < next_run) {
+            s.timer_cv.wait_until(lock, next_run);
+            continue;
+        }
+        s.timers.erase(s.timers.begin());
+        s.tasks[task_id].queued = true;
+        s.due.push_back(task_id);
+
+        // Never waits for a busy worker, runs block on network I/O for as long as a connection takes
+        if (s.due.size() > s.idle_workers) {
+            try {
+                // Workers live until they have been idle for a while
+                std::thread(&RefreshScheduler::run_worker).detach();
+                s.workers++;
+            } catch (const std::system_error& ex) {
+                LOG(ERROR) << "[Refresh Scheduler] unable to start a worker, due tasks wait for a busy one: " << ex.what();
+            }
+        } else {
+            s.work_cv.notify_one();
+        }
+    }
+}
+
+void RefreshScheduler::run_worker() {
+    State& s = state();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    while (true) {
+        if (s.due.empty()) {
+            s.idle_workers++;
+            bool has_work = s.work_cv.wait_for(lock, WORKER_KEEPALIVE, [&s] { return !s.due.empty(); });
+            s.idle_workers--;
+            if (!has_work && s.idle_workers >= s.pool_size) {
+                s.workers--;
+                return;
+            }
+            continue;
+        }
+        uint64_t task_id = s.due.front();
+        s.due.pop_front();
+
+        Entry& entry = s.tasks[task_id];
+        entry.queued = false;
+        entry.running = true;
+        entry.runner = std::this_thread::get_id();
+        Task task = entry.task;
+        lock.unlock();
+
+        std::chrono::milliseconds delay = STOP;
+        try {
+            delay = task();
+        } catch (const std::exception& ex) {
+            LOG(ERROR) << "[Refresh Scheduler] refresh task " << task_id << " failed and is no longer run: " << ex.what();
+        }
+
+        lock.lock();
+        // Entries are only removed by cancellers while they are not running, the entry is still there
+        Entry& ran = s.tasks[task_id];
+        ran.running = false;
+        if (ran.cancelled || delay < std::chrono::milliseconds(0)) {
+            s.tasks.erase(task_id);
+            s.done_cv.notify_all();
+            continue;
+        }
+        ran.next_run = Clock::now() + delay;
+        s.timers.emplace(ran.next_run, task_id);
+        s.timer_cv.notify_one();
+    }
+}
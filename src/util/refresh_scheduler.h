@@ -0,0 +1,118 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef REFRESH_SCHEDULER_H_
+#define REFRESH_SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Process-wide scheduler driving the periodic refreshes of every monitor,
+ * limitless router polls and cluster topology refreshes alike.
+ *
+ * Tasks wait in a single timer queue ordered by their next run. One timer thread only keeps the time,
+ * and hands each task that comes due to a worker. Refreshes block on network I/O, so a worker is started
+ * whenever every worker is busy, and a slow cluster never delays the refreshes of the others.
+ * Idle workers beyond the pool size exit after a while, so the number of threads follows the number
+ * of refreshes running at once rather than the number of monitors.
+ * A task that is waiting for its next run is cancelled right away instead of after its interval.
+ */
+class RefreshScheduler {
+public:
+    /**
+     * Runs one refresh, and returns the delay before the next one, or STOP to not run again.
+     */
+    typedef std::function<std::chrono::milliseconds()> Task;
+
+    static constexpr std::chrono::milliseconds STOP = std::chrono::milliseconds(-1);
+    static const uint32_t DEFAULT_POOL_SIZE;
+    static const std::chrono::milliseconds WORKER_KEEPALIVE;
+
+    /**
+     * Grows the number of idle workers kept for the next runs to at least the given size.
+     * Does not limit the number of workers, it only saves starting threads for busy processes.
+     */
+    static void Configure(uint32_t pool_size);
+
+    /**
+     * Runs the task after the delay, and then after each delay it returns.
+     *
+     * @return the task ID, used to wake or cancel it
+     */
+    static uint64_t Schedule(const Task& task, std::chrono::milliseconds delay);
+
+    /**
+     * Runs the task now if it is waiting for its next run.
+     * Has no effect while it runs or waits for a worker, the delay it returns stands.
+     */
+    static void Wake(uint64_t task_id);
+
+    /**
+     * Removes the task. A run in progress is waited for, unless the task cancels itself,
+     * so the task no longer runs once this returns.
+     */
+    static void Cancel(uint64_t task_id);
+
+    static uint32_t GetPoolSize();
+    static uint32_t GetWorkerCount();
+    static size_t GetTaskCount();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        Task task;
+        Clock::time_point next_run;
+        // Due, waiting for a worker
+        bool queued = false;
+        bool running = false;
+        bool cancelled = false;
+        std::thread::id runner;
+    };
+
+    struct State {
+        std::mutex mutex;
+        // Wakes the timer thread when a task is due earlier than the one it waits for
+        std::condition_variable timer_cv;
+        // Wakes idle workers when tasks are due
+        std::condition_variable work_cv;
+        // Wakes cancellers waiting for a run in progress
+        std::condition_variable done_cv;
+        std::unordered_map<uint64_t, Entry> tasks;
+        // Task IDs by next run
+        std::set<std::pair<Clock::time_point, uint64_t>> timers;
+        // Task IDs due, in the order they came due
+        std::deque<uint64_t> due;
+        bool timer_started = false;
+        uint32_t workers = 0;
+        uint32_t idle_workers = 0;
+        uint32_t pool_size = DEFAULT_POOL_SIZE;
+        uint64_t next_task_id = 1;
+    };
+
+    static State& state();
+    static void run_timer();
+    static void run_worker();
+};
+
+#endif // REFRESH_SCHEDULER_H_
@@ -25,10 +25,9 @@ void SlidingCacheMap<K, V>::Put(const K& key, const V& value) {
 
 template <typename K, typename V>
 void SlidingCacheMap<K, V>::Put(const K& key, const V& value, int sec_ttl) {
-    std::lock_guard<std::mutex> lock(cache_lock);
-    std::chrono::steady_clock::time_point expiry_time =
-        std::chrono::steady_clock::now() + std::chrono::seconds(sec_ttl);
-    cache[key] = CacheEntry{value, expiry_time, sec_ttl};
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::shared_mutex> lock(shard.cache_lock);
+    put_entry(shard, key, value, sec_ttl, now_ticks());
 }
 
 template <typename K, typename V>
@@ -38,75 +37,152 @@ void SlidingCacheMap<K, V>::putIfAbsent(const K &key, const V &value) {
 
 template <typename K, typename V>
 void SlidingCacheMap<K, V>::putIfAbsent(const K &key, const V &value, int sec_ttl) {
-    std::lock_guard<std::mutex> lock(cache_lock);
-    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-    if (auto itr = cache.find(key); itr != cache.end()) {
-        CacheEntry& entry = itr->second;
-        // Already in cache & is not expired
-        if (entry.expiry > now) {
-            // Update TTL & Return value
-            entry.expiry = now + std::chrono::seconds(entry.sec_ttl);
+    Shard& shard = get_shard(key);
+    Ticks now = now_ticks();
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.cache_lock);
+        if (auto itr = shard.cache.find(key); itr != shard.cache.end() && touch(itr->second, now)) {
+            // Already in cache & is not expired
             return;
         }
     }
+    std::unique_lock<std::shared_mutex> lock(shard.cache_lock);
+    if (auto itr = shard.cache.find(key); itr != shard.cache.end() && touch(itr->second, now)) {
+        // Added by another thread in the meantime
+        return;
+    }
     // Either not in cache or is expired, put new into cache
-    std::chrono::steady_clock::time_point expiry_time =
-        std::chrono::steady_clock::now() + std::chrono::seconds(sec_ttl);
-    cache[key] = CacheEntry{value, expiry_time, sec_ttl};
+    put_entry(shard, key, value, sec_ttl, now);
 }
 
 template <typename K, typename V>
 V SlidingCacheMap<K, V>::Get(const K& key) {
-    std::lock_guard<std::mutex> lock(cache_lock);
-    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-    if (auto itr = cache.find(key); itr != cache.end()) {
-        CacheEntry& entry = itr->second;
-        if (entry.expiry > now) {
-            // Update TTL & Return value
-            entry.expiry = now + std::chrono::seconds(entry.sec_ttl);
-            return entry.value;
+    Shard& shard = get_shard(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.cache_lock);
+        auto itr = shard.cache.find(key);
+        if (itr == shard.cache.end()) {
+            return {};
+        }
+        if (touch(itr->second, now_ticks())) {
+            return itr->second.value;
         }
-        // Expired, remove from cache
-        cache.erase(itr);
     }
+    // Expired, remove from cache
+    erase_if_expired(shard, key);
     return {};
 }
 
 template <typename K, typename V>
 bool SlidingCacheMap<K, V>::Find(const K& key) {
-    std::lock_guard<std::mutex> lock(cache_lock);
-    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-    if (auto itr = cache.find(key); itr != cache.end()) {
-        CacheEntry& entry = itr->second;
-        if (entry.expiry > now) {
-            // Update TTL & Return found
-            entry.expiry = now + std::chrono::seconds(entry.sec_ttl);
+    Shard& shard = get_shard(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.cache_lock);
+        auto itr = shard.cache.find(key);
+        if (itr == shard.cache.end()) {
+            return false;
+        }
+        if (touch(itr->second, now_ticks())) {
             return true;
         }
-        // Expired, remove from cache
-        cache.erase(itr);
     }
+    // Expired, remove from cache
+    erase_if_expired(shard, key);
     return false;
 }
 
 template <typename K, typename V>
 unsigned int SlidingCacheMap<K, V>::Size() {
-    std::lock_guard<std::mutex> lock(cache_lock);
-    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-    for (auto itr = cache.begin(); itr != cache.end();) {
-        if (itr->second.expiry < now) {
-            itr = cache.erase(itr);
+    // Counts live entries without removing expired ones, shards are locked one at a time
+    Ticks now = now_ticks();
+    unsigned int size = 0;
+    for (Shard& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.cache_lock);
+        for (const auto& [key, entry] : shard.cache) {
+            if (entry.expiry.load(std::memory_order_relaxed) >= now) {
+                size++;
+            }
+        }
+    }
+    return size;
+}
+
+template <typename K, typename V>
+void SlidingCacheMap<K, V>::Clear() {
+    for (Shard& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.cache_lock);
+        shard.cache.clear();
+        shard.puts_since_sweep = 0;
+    }
+}
+
+template <typename K, typename V>
+typename SlidingCacheMap<K, V>::Shard& SlidingCacheMap<K, V>::get_shard(const K& key) {
+    return shards[std::hash<K>{}(key) % SHARD_COUNT];
+}
+
+template <typename K, typename V>
+typename SlidingCacheMap<K, V>::Ticks SlidingCacheMap<K, V>::now_ticks() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+template <typename K, typename V>
+typename SlidingCacheMap<K, V>::Ticks SlidingCacheMap<K, V>::ttl_ticks(int sec_ttl) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(sec_ttl)).count();
+}
+
+template <typename K, typename V>
+bool SlidingCacheMap<K, V>::touch(CacheEntry& entry, Ticks now) {
+    Ticks expiry = entry.expiry.load(std::memory_order_relaxed);
+    if (expiry < now) {
+        return false;
+    }
+    // Update TTL, concurrent readers may race here and any of their refreshes is valid
+    Ticks ttl = ttl_ticks(entry.sec_ttl);
+    Ticks new_expiry = now + ttl;
+    if (new_expiry - expiry > ttl / TTL_REFRESH_DIVISOR) {
+        entry.expiry.store(new_expiry, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+template <typename K, typename V>
+void SlidingCacheMap<K, V>::put_entry(Shard& shard, const K& key, const V& value, int sec_ttl, Ticks now) {
+    Ticks expiry = now + ttl_ticks(sec_ttl);
+    if (auto itr = shard.cache.find(key); itr != shard.cache.end()) {
+        itr->second.value = value;
+        itr->second.expiry.store(expiry, std::memory_order_relaxed);
+        itr->second.sec_ttl = sec_ttl;
+    } else {
+        shard.cache.try_emplace(key, value, expiry, sec_ttl);
+    }
+
+    // Amortize removal of entries that are never looked up again
+    if (++shard.puts_since_sweep >= PUTS_PER_SWEEP) {
+        sweep(shard, now);
+    }
+}
+
+template <typename K, typename V>
+void SlidingCacheMap<K, V>::sweep(Shard& shard, Ticks now) {
+    for (auto itr = shard.cache.begin(); itr != shard.cache.end();) {
+        if (itr->second.expiry.load(std::memory_order_relaxed) < now) {
+            itr = shard.cache.erase(itr);
         } else {
             itr++;
         }
     }
-    return cache.size();
+    shard.puts_since_sweep = 0;
 }
 
 template <typename K, typename V>
-void SlidingCacheMap<K, V>::Clear() {
-    std::lock_guard<std::mutex> lock(cache_lock);
-    cache.clear();
+void SlidingCacheMap<K, V>::erase_if_expired(Shard& shard, const K& key) {
+    std::unique_lock<std::shared_mutex> lock(shard.cache_lock);
+    // May have been refreshed or replaced since it was found expired
+    if (auto itr = shard.cache.find(key); itr != shard.cache.end() &&
+        itr->second.expiry.load(std::memory_order_relaxed) < now_ticks()) {
+        shard.cache.erase(itr);
+    }
 }
 
 // Explicit Template Instantiations
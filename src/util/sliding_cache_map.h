@@ -15,10 +15,20 @@
 #ifndef SLIDING_CACHE_MAP_H_
 #define SLIDING_CACHE_MAP_H_
 
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <mutex>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
 #include <unordered_map>
 
+/**
+ * Thread safe map with a sliding TTL per entry.
+ * Keys are spread over independently locked shards. Lookups only take a shared lock on their shard,
+ * and refresh the TTL with a relaxed atomic store that is skipped while the entry was refreshed recently.
+ * Expired entries are removed lazily on lookup and by periodic sweeps of a shard on insert.
+ */
 template <typename K, typename V>
 class SlidingCacheMap {
 public:
@@ -34,14 +44,38 @@ public:
     void Clear();
 
 private:
+    typedef std::chrono::steady_clock::rep Ticks;
+
     struct CacheEntry {
+        CacheEntry(const V& value, Ticks expiry, int sec_ttl) : value{ value }, expiry{ expiry }, sec_ttl{ sec_ttl } {}
+
         V value;
-        std::chrono::steady_clock::time_point expiry;
+        // Refreshed by readers holding a shared lock
+        std::atomic<Ticks> expiry;
         int sec_ttl;
     };
+
+    struct Shard {
+        std::unordered_map<K, CacheEntry> cache;
+        std::shared_mutex cache_lock;
+        uint32_t puts_since_sweep = 0;
+    };
+
+    static const size_t SHARD_COUNT = 16;
+    static const uint32_t PUTS_PER_SWEEP = 64;
+    // Skip TTL refreshes that would extend the expiry by less than this fraction of the TTL
+    static const int TTL_REFRESH_DIVISOR = 16;
     const int DEFAULT_EXPIRATION_SEC = 600; // 600s = 10m
-    std::unordered_map<K, CacheEntry> cache;
-    std::mutex cache_lock;
+
+    Shard& get_shard(const K& key);
+    static Ticks now_ticks();
+    static Ticks ttl_ticks(int sec_ttl);
+    static bool touch(CacheEntry& entry, Ticks now);
+    static void put_entry(Shard& shard, const K& key, const V& value, int sec_ttl, Ticks now);
+    static void sweep(Shard& shard, Ticks now);
+    static void erase_if_expired(Shard& shard, const K& key);
+
+    std::array<Shard, SHARD_COUNT> shards;
 };
 
 #endif // SLIDING_CACHE_MAP_H_
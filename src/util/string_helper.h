@@ -34,6 +34,7 @@
 #include <locale>
 #include <regex>
 #include <string>
+#include <string_view>
 
 #define AS_SQLTCHAR(str) (const_cast<SQLTCHAR*>(reinterpret_cast<const SQLTCHAR*>(str)))
 #define AS_CHAR(str) (reinterpret_cast<char*>(str))
@@ -48,6 +49,7 @@
     typedef std::wstring SQLSTR;
 
     typedef wchar_t RDSCHAR;
+    typedef std::wstring_view RDSSTRVIEW;
     typedef std::wostringstream RDSSTRSTREAM;
     typedef std::wregex RDSREGEX;
     typedef std::wsmatch RDSSTRMATCH;
@@ -57,6 +59,7 @@
     typedef std::string SQLSTR;
 
     typedef char RDSCHAR;
+    typedef std::string_view RDSSTRVIEW;
     typedef std::ostringstream RDSSTRSTREAM;
     typedef std::regex RDSREGEX;
     typedef std::smatch RDSSTRMATCH;
@@ -0,0 +1,81 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "html_util.h"
+
+namespace {
+    /**
+     * Sign on page in the shape of an ADFS one, inline scripts and styles of the given size around the login form.
+     */
+    std::string sign_on_page(size_t script_size) {
+        std::string page = "<!DOCTYPE html><html><head><title>Sign In</title><script type=\"text/javascript\">";
+        while (page.size() < script_size) {
+            page += "if (a < b && c > d) { document.getElementById('userNameInput').value = \"\"; }\n";
+        }
+        page += "</script><style>.text { width: 100%; }</style></head><body>\n";
+        page += "<form method=\"post\" id=\"loginForm\" autocomplete=\"off\" action=\"/adfs/ls/IdpInitiatedSignOn.aspx?loginToRp=urn:amazon:webservices&amp;client-request-id=1234-uuid-5678\">\n";
+        page += "<input id=\"userNameInput\" name=\"UserName\" type=\"email\" value=\"\" tabindex=\"1\" class=\"text fullWidth\" />\n";
+        page += "<input id=\"passwordInput\" name=\"Password\" type=\"password\" tabindex=\"2\" class=\"text fullWidth\" />\n";
+        for (int i = 0; i < 20; i++) {
+            page += "<input id=\"hidden" + std::to_string(i) + "\" name=\"Hidden" + std::to_string(i) + "\" type=\"hidden\" value=\"value&#x2b;" + std::to_string(i) + "\" />\n";
+        }
+        page += "<input id=\"kmsiInput\" name=\"Kmsi\" type=\"checkbox\" value=\"true\" />\n";
+        page += "<input id=\"optionForms\" type=\"hidden\" name=\"AuthMethod\" value=\"FormsAuthentication\"/>\n";
+        page += "</form></body></html>";
+        return page;
+    }
+
+    std::string saml_page(size_t assertion_size) {
+        std::string page = "<html><body><form method=\"POST\" name=\"hiddenform\" action=\"https://signin.aws.amazon.com:443/saml\">";
+        page += "<input type=\"hidden\" name=\"SAMLResponse\" value=\"";
+        while (page.size() < assertion_size) {
+            page += "PHNhbWxwOlJlc3BvbnNlIElEPSJfMTIzNDU2Nzg5MCIgVmVyc2lvbj0iMi4wIj4&#x2b;PC9zYW1scDpSZXNwb25zZT4&#x3d;";
+        }
+        page += "\" /><noscript><p>Script is disabled. Click Submit to continue.</p><input type=\"submit\" value=\"Submit\" /></noscript></form>";
+        page += "<script language=\"javascript\">window.setTimeout('document.forms[0].submit()', 0);</script></body></html>";
+        return page;
+    }
+}
+
+static void BM_ExtractForm(benchmark::State& state) {
+    std::string page = sign_on_page(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::istringstream html(page);
+        std::string action;
+        std::vector<std::pair<std::string, std::string>> inputs;
+        benchmark::DoNotOptimize(HtmlUtil::ExtractForm(html, action, inputs));
+    }
+    state.SetBytesProcessed(state.iterations() * page.size());
+}
+
+static void BM_ExtractInputValue(benchmark::State& state) {
+    std::string page = saml_page(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::istringstream html(page);
+        std::string value;
+        benchmark::DoNotOptimize(HtmlUtil::ExtractInputValue(html, "SAMLResponse", value));
+    }
+    state.SetBytesProcessed(state.iterations() * page.size());
+}
+
+// Arguments are the size of the inline scripts and of the SAML assertion
+BENCHMARK(BM_ExtractForm)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK(BM_ExtractInputValue)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
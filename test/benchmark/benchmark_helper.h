@@ -0,0 +1,43 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BENCHMARK_HELPER_H_
+#define BENCHMARK_HELPER_H_
+
+#include <string>
+#include <vector>
+
+#include "host_info.h"
+
+// Topology sizes and thread counts every hot path benchmark runs across
+#define TOPOLOGY_SIZES RangeMultiplier(2)->Range(1, 64)
+#define THREAD_COUNTS ThreadRange(1, 8)
+
+class BenchmarkHelper {
+public:
+    /**
+     * Builds a cluster topology of the given size, one writer followed by readers with varying weights.
+     */
+    static std::vector<HostInfo> CreateTopology(int size) {
+        std::vector<HostInfo> hosts;
+        hosts.reserve(size);
+        for (int i = 0; i < size; i++) {
+            std::string host = "instance-" + std::to_string(i) + ".XYZ.us-east-2.rds.amazonaws.com";
+            hosts.emplace_back(host, 5432, UP, i == 0, nullptr, static_cast<uint64_t>(i % 10 + 1));
+        }
+        return hosts;
+    }
+};
+
+#endif // BENCHMARK_HELPER_H_
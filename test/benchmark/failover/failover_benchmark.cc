@@ -0,0 +1,154 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end failover benchmarks against the cluster simulated by the mock ODBC driver.
+// Every connection, including the ones opened by the topology monitors, goes through the Driver Manager.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "failover_service.h"
+#include "mock_odbc_driver/mock_cluster_control.h"
+
+namespace {
+    const std::vector<std::string> instances = { "instance-1", "instance-2", "instance-3" };
+    const std::string communication_link_failure = "08S01";
+    const std::chrono::milliseconds monitor_settle_time = std::chrono::seconds(2);
+
+    std::string cluster_statement() {
+        std::string statement = "MOCK CLUSTER";
+        for (const std::string& instance : instances) {
+            statement += " " + instance;
+        }
+        return statement;
+    }
+
+    bool start_service(const std::string& cluster_id, const std::string& attributes) {
+        char service_id[MAX_CLUSTER_ID_LEN] = {0};
+        cluster_id.copy(service_id, MAX_CLUSTER_ID_LEN - 1);
+        SQLSTR conn_str = MockClusterControl::GetConnectionString(MOCK_CLUSTER_HOST, "CLUSTERID=" + cluster_id + ";" + attributes);
+        return StartFailoverService(service_id, AURORA_POSTGRES, AS_SQLTCHAR(conn_str.c_str()));
+    }
+
+    /**
+     * Fails over the simulated writer, then measures how long FailoverConnection takes to return a connection
+     * to an instance that satisfies the failover mode.
+     */
+    void run_failover(benchmark::State& state, const std::string& cluster_id, bool expect_writer,
+                      const std::string& setup_statement) {
+        MockClusterControl control;
+        control.Execute(cluster_statement());
+        if (!setup_statement.empty()) {
+            control.Execute(setup_statement);
+        }
+        uint32_t downtime_ms = static_cast<uint32_t>(state.range(0));
+
+        if (!start_service(cluster_id, "FAILOVERMODE=" + std::string(expect_writer ? "STRICT_WRITER" : "STRICT_READER") +
+                ";FAILOVERREADERFANOUT=" + std::to_string(state.range(1)))) {
+            state.SkipWithError("unable to start the failover service");
+            return;
+        }
+        std::this_thread::sleep_for(monitor_settle_time);
+
+        size_t writer = 0;
+        int64_t failures = 0;
+        int64_t peak_threads = 0;
+        for (auto _ : state) {
+            // Alternate the writer between the first two instances, the last instance always stays a reader
+            writer = 1 - writer;
+            control.Execute("MOCK FAILOVER " + instances[writer] + " 0 " + std::to_string(downtime_ms));
+
+            auto start = std::chrono::steady_clock::now();
+            FailoverResult result = FailoverConnection(cluster_id.c_str(), communication_link_failure.c_str(), control.GetHenv());
+            auto end = std::chrono::steady_clock::now();
+            state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+            peak_threads = std::max(peak_threads, MockClusterControl::GetThreadCount());
+
+            state.PauseTiming();
+            std::string instance = FAILOVER_SUCCEED == result.status ? MockClusterControl::GetInstanceId(result.hdbc) : "";
+            if (instance.empty() || (instance == instances[writer]) != expect_writer) {
+                failures++;
+            }
+            if (FAILOVER_SUCCEED == result.status) {
+                OdbcHelper::Cleanup(SQL_NULL_HANDLE, result.hdbc, SQL_NULL_HANDLE);
+            }
+            // Let both restarted instances come back before the next failover
+            std::this_thread::sleep_for(std::chrono::milliseconds(downtime_ms));
+            state.ResumeTiming();
+        }
+
+        StopFailoverService(cluster_id.c_str());
+        state.counters["failures"] = static_cast<double>(failures);
+        state.counters["peak_threads"] = static_cast<double>(peak_threads);
+    }
+}
+
+static void BM_TimeToNewWriter(benchmark::State& state) {
+    run_failover(state, "bm-new-writer-" + std::to_string(state.range(0)), true, "");
+}
+
+static void BM_TimeToReader(benchmark::State& state) {
+    run_failover(state, "bm-reader-" + std::to_string(state.range(0)) + "-" + std::to_string(state.range(1)), false, "");
+}
+
+static void BM_TimeToReaderWithBlackholedReader(benchmark::State& state) {
+    // The reader that is not restarted never answers, only the demoted writer can be reached once it is back up
+    run_failover(state, "bm-blackhole-" + std::to_string(state.range(0)) + "-" + std::to_string(state.range(1)), false,
+        "MOCK BLACKHOLE " + instances[2] + " 2000");
+}
+
+/**
+ * Steady state thread count and query load of the topology monitors, for a growing number of clusters.
+ */
+static void BM_MonitorThreads(benchmark::State& state) {
+    MockClusterControl control;
+    control.Execute(cluster_statement());
+    int64_t baseline_threads = MockClusterControl::GetThreadCount();
+
+    std::vector<std::string> cluster_ids;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        cluster_ids.push_back("bm-monitor-" + std::to_string(state.range(0)) + "-" + std::to_string(i));
+        start_service(cluster_ids.back(), "TOPOLOGYHIGHREFRESHRATE=100;TOPOLOGYREFRESHRATE=1000");
+    }
+    std::this_thread::sleep_for(monitor_settle_time);
+
+    uint64_t queries = 0;
+    for (auto _ : state) {
+        uint64_t queries_before = control.GetStats()["queries"];
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+        queries += control.GetStats()["queries"] - queries_before;
+    }
+
+    int64_t threads = MockClusterControl::GetThreadCount() - baseline_threads;
+    state.counters["threads"] = static_cast<double>(threads);
+    state.counters["threads_per_cluster"] = static_cast<double>(threads) / static_cast<double>(state.range(0));
+    state.counters["queries"] = benchmark::Counter(static_cast<double>(queries), benchmark::Counter::kIsRate);
+    for (const std::string& cluster_id : cluster_ids) {
+        StopFailoverService(cluster_id.c_str());
+    }
+}
+
+// Arguments are the simulated downtime of the restarted instances in ms, and the reader fan-out
+BENCHMARK(BM_TimeToNewWriter)->Args({ 100, 1 })->Args({ 500, 1 })->Iterations(5)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TimeToReader)->Args({ 500, 1 })->Args({ 500, 2 })->Iterations(5)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TimeToReaderWithBlackholedReader)->Args({ 500, 1 })->Args({ 500, 2 })->Iterations(5)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MonitorThreads)->RangeMultiplier(4)->Range(1, 16)->Iterations(3)->UseManualTime()->Unit(benchmark::kMillisecond);
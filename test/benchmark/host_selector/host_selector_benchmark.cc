@@ -0,0 +1,41 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include "../benchmark_helper.h"
+#include "highest_weight_host_selector.h"
+#include "random_host_selector.h"
+#include "round_robin_host_selector.h"
+
+template <typename Selector, bool is_writer>
+static void BM_GetHost(benchmark::State& state) {
+    std::vector<HostInfo> hosts = BenchmarkHelper::CreateTopology(static_cast<int>(state.range(0)));
+    std::unordered_map<std::string, std::string> properties;
+    RoundRobinHostSelector::SetRoundRobinWeight(hosts, properties);
+    Selector selector;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(selector.GetHost(hosts, is_writer, properties));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE2(BM_GetHost, RandomHostSelector, false)->TOPOLOGY_SIZES->THREAD_COUNTS;
+BENCHMARK_TEMPLATE2(BM_GetHost, RandomHostSelector, true)->TOPOLOGY_SIZES->THREAD_COUNTS;
+BENCHMARK_TEMPLATE2(BM_GetHost, HighestWeightHostSelector, false)->TOPOLOGY_SIZES->THREAD_COUNTS;
+BENCHMARK_TEMPLATE2(BM_GetHost, HighestWeightHostSelector, true)->TOPOLOGY_SIZES->THREAD_COUNTS;
+// Round robin state is shared by every selector through its cluster cache
+BENCHMARK_TEMPLATE2(BM_GetHost, RoundRobinHostSelector, false)->TOPOLOGY_SIZES->THREAD_COUNTS;
+BENCHMARK_TEMPLATE2(BM_GetHost, RoundRobinHostSelector, true)->TOPOLOGY_SIZES->THREAD_COUNTS;
@@ -0,0 +1,138 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MOCK_CLUSTER_CONTROL_H_
+#define MOCK_CLUSTER_CONTROL_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+// ODBC APIs
+#include <sql.h>
+#include <sqlext.h>
+
+#include "odbc_helper.h"
+#include "string_helper.h"
+
+#define MOCK_CLUSTER_HOST "database-mock.cluster-xyz.us-east-2.rds.amazonaws.com"
+#define MOCK_READER_CLUSTER_HOST "database-mock.cluster-ro-xyz.us-east-2.rds.amazonaws.com"
+
+/**
+ * Scripts the cluster simulated by the mock ODBC driver, through a connection opened by the Driver Manager.
+ */
+class MockClusterControl {
+public:
+    MockClusterControl() {
+        OdbcHelper::AllocateHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, henv_, "MockClusterControl failed to allocate environment");
+        OdbcHelper::SetHenvToOdbc3(henv_, "MockClusterControl failed to set ODBC version");
+        OdbcHelper::AllocateHandle(SQL_HANDLE_DBC, henv_, hdbc_, "MockClusterControl failed to allocate connection");
+        SQLSTR conn_str = GetConnectionString(MOCK_CLUSTER_HOST);
+        OdbcHelper::ConnStrConnect(AS_SQLTCHAR(conn_str.c_str()), hdbc_);
+    }
+
+    ~MockClusterControl() {
+        OdbcHelper::Cleanup(henv_, hdbc_, SQL_NULL_HANDLE);
+    }
+
+    /**
+     * Connection string loading the mock driver, followed by any additional attributes.
+     */
+    static SQLSTR GetConnectionString(const std::string& host, const std::string& attributes = "") {
+        std::string conn_str = "DRIVER=" MOCK_ODBC_DRIVER_PATH ";SERVER=" + host + ";PORT=5432;" + attributes;
+        return StringHelper::ToSQLSTR(conn_str);
+    }
+
+    SQLHENV GetHenv() const {
+        return henv_;
+    }
+
+    /**
+     * Runs a MOCK statement, see SimulatedCluster for the supported statements.
+     */
+    bool Execute(const std::string& statement) {
+        SQLHSTMT stmt = SQL_NULL_HANDLE;
+        SQLSTR query = StringHelper::ToSQLSTR(statement);
+        if (!OdbcHelper::AllocateHandle(SQL_HANDLE_STMT, hdbc_, stmt, "MockClusterControl failed to allocate statement") ||
+            !OdbcHelper::ExecuteQuery(stmt, AS_SQLTCHAR(query.c_str()), "MockClusterControl failed to execute: " + statement)) {
+            return false;
+        }
+        OdbcHelper::Cleanup(SQL_NULL_HANDLE, SQL_NULL_HANDLE, stmt);
+        return true;
+    }
+
+    std::map<std::string, uint64_t> GetStats() {
+        std::map<std::string, uint64_t> stats;
+        SQLHSTMT stmt = SQL_NULL_HANDLE;
+        SQLSTR query = StringHelper::ToSQLSTR(std::string("MOCK STATS"));
+        SQLCHAR name[64] = {0};
+        SQLCHAR value[32] = {0};
+        SQLLEN name_len = 0;
+        SQLLEN value_len = 0;
+        if (!OdbcHelper::AllocateHandle(SQL_HANDLE_STMT, hdbc_, stmt, "MockClusterControl failed to allocate statement") ||
+            !OdbcHelper::ExecuteQuery(stmt, AS_SQLTCHAR(query.c_str()), "MockClusterControl failed to query stats")) {
+            return stats;
+        }
+        SQLBindCol(stmt, 1, SQL_C_CHAR, name, sizeof(name), &name_len);
+        SQLBindCol(stmt, 2, SQL_C_CHAR, value, sizeof(value), &value_len);
+        while (SQL_SUCCEEDED(SQLFetch(stmt))) {
+            stats[AS_CHAR(name)] = std::stoull(AS_CHAR(value));
+        }
+        OdbcHelper::Cleanup(SQL_NULL_HANDLE, SQL_NULL_HANDLE, stmt);
+        return stats;
+    }
+
+    /**
+     * Instance a connection is established to, empty if the connection is broken.
+     */
+    static std::string GetInstanceId(SQLHDBC hdbc) {
+        SQLHSTMT stmt = SQL_NULL_HANDLE;
+        SQLTCHAR instance_id[256] = {0};
+        SQLLEN instance_id_len = 0;
+        SQLSTR query = StringHelper::ToSQLSTR(std::string("SELECT pg_catalog.aurora_db_instance_identifier()"));
+        if (!OdbcHelper::AllocateHandle(SQL_HANDLE_STMT, hdbc, stmt, "MockClusterControl failed to allocate statement") ||
+            !OdbcHelper::ExecuteQuery(stmt, AS_SQLTCHAR(query.c_str()), "MockClusterControl failed to query instance")) {
+            return std::string();
+        }
+        SQLBindCol(stmt, 1, SQL_C_TCHAR, instance_id, sizeof(instance_id), &instance_id_len);
+        if (!OdbcHelper::FetchResults(stmt, "MockClusterControl failed to fetch instance")) {
+            return std::string();
+        }
+        OdbcHelper::Cleanup(SQL_NULL_HANDLE, SQL_NULL_HANDLE, stmt);
+        return StringHelper::ToString(instance_id);
+    }
+
+    /**
+     * Number of threads in this process, 0 where it cannot be determined.
+     */
+    static int64_t GetThreadCount() {
+#ifdef __linux__
+        std::error_code ec;
+        int64_t count = 0;
+        for (std::filesystem::directory_iterator itr("/proc/self/task", ec), end; !ec && itr != end; itr.increment(ec)) {
+            count++;
+        }
+        return count;
+#else
+        return 0;
+#endif
+    }
+
+private:
+    SQLHENV henv_ = SQL_NULL_HENV;
+    SQLHDBC hdbc_ = SQL_NULL_HDBC;
+};
+
+#endif // MOCK_CLUSTER_CONTROL_H_
@@ -0,0 +1,541 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Minimal ODBC driver answering the queries issued by this library from a SimulatedCluster.
+// Only ANSI entry points are exported, the Driver Manager converts calls from Unicode applications.
+#define SQL_NOUNICODEMAP
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// ODBC APIs
+#include <sql.h>
+#include <sqlext.h>
+#include <sqltypes.h>
+
+#include "simulated_cluster.h"
+
+#define SQL_STATE_STRING_TRUNCATED "01004"
+#define SQL_STATE_INVALID_CURSOR_STATE "24000"
+#define SQL_STATE_INVALID_DESCRIPTOR_INDEX "07009"
+#define SQL_STATE_CONNECTION_NOT_OPEN "08003"
+#define SQL_STATE_INVALID_APPLICATION_BUFFER_TYPE "HY003"
+#define SQL_STATE_INVALID_INFO_TYPE "HY096"
+
+namespace {
+    const char* DRIVER_ODBC_VER = "03.80";
+    const char* DRIVER_NAME = "mock-odbc-driver";
+    const char* DRIVER_VER = "01.00.0000";
+    const char* DBMS_NAME = "PostgreSQL";
+    const char* SERVER_KEY = "SERVER";
+
+    struct MockDiag {
+        std::string sql_state;
+        std::string message;
+    };
+
+    struct MockHandle {
+        explicit MockHandle(SQLSMALLINT handle_type) : handle_type{ handle_type } {}
+        SQLSMALLINT handle_type;
+        std::vector<MockDiag> diags;
+    };
+
+    struct MockEnv : MockHandle {
+        MockEnv() : MockHandle(SQL_HANDLE_ENV) {}
+    };
+
+    struct MockDbc : MockHandle {
+        MockDbc() : MockHandle(SQL_HANDLE_DBC) {}
+        bool connected = false;
+        std::string instance;
+        uint64_t session_epoch = 0;
+    };
+
+    struct MockBinding {
+        SQLSMALLINT target_type;
+        SQLPOINTER target;
+        SQLLEN length;
+        SQLLEN* indicator;
+    };
+
+    struct MockStmt : MockHandle {
+        explicit MockStmt(MockDbc* dbc) : MockHandle(SQL_HANDLE_STMT), dbc{ dbc } {}
+        MockDbc* dbc;
+        SimulatedCluster::ResultSet rows;
+        size_t curr_row = 0;
+        bool has_result = false;
+        std::map<SQLUSMALLINT, MockBinding> bindings;
+    };
+
+    SQLRETURN set_error(MockHandle* handle, const std::string& sql_state, const std::string& message) {
+        handle->diags.push_back(MockDiag{ sql_state, message });
+        return SQL_ERROR;
+    }
+
+    MockHandle* to_handle(SQLSMALLINT handle_type, SQLHANDLE handle) {
+        switch (handle_type) {
+            case SQL_HANDLE_ENV:
+                return static_cast<MockEnv*>(handle);
+            case SQL_HANDLE_DBC:
+                return static_cast<MockDbc*>(handle);
+            case SQL_HANDLE_STMT:
+                return static_cast<MockStmt*>(handle);
+            default:
+                return nullptr;
+        }
+    }
+
+    std::string to_string(const SQLCHAR* str, SQLINTEGER length) {
+        if (!str) {
+            return std::string();
+        }
+        const char* chars = reinterpret_cast<const char*>(str);
+        return SQL_NTS == length ? std::string(chars) : std::string(chars, length);
+    }
+
+    SQLRETURN copy_string(const std::string& value, SQLCHAR* target, SQLLEN length, SQLLEN* indicator, MockHandle* handle) {
+        if (indicator) {
+            *indicator = static_cast<SQLLEN>(value.size());
+        }
+        if (!target || length <= 0) {
+            return SQL_SUCCESS;
+        }
+        size_t copied = std::min(value.size(), static_cast<size_t>(length - 1));
+        std::memcpy(target, value.data(), copied);
+        target[copied] = '\0';
+        if (copied < value.size()) {
+            handle->diags.push_back(MockDiag{ SQL_STATE_STRING_TRUNCATED, "string data, right truncated" });
+            return SQL_SUCCESS_WITH_INFO;
+        }
+        return SQL_SUCCESS;
+    }
+
+    SQLRETURN copy_wide_string(const std::string& value, SQLWCHAR* target, SQLLEN length, SQLLEN* indicator, MockHandle* handle) {
+        // Simulated values are ASCII, each character maps to a single code unit
+        if (indicator) {
+            *indicator = static_cast<SQLLEN>(value.size() * sizeof(SQLWCHAR));
+        }
+        SQLLEN capacity = length / static_cast<SQLLEN>(sizeof(SQLWCHAR));
+        if (!target || capacity <= 0) {
+            return SQL_SUCCESS;
+        }
+        size_t copied = std::min(value.size(), static_cast<size_t>(capacity - 1));
+        for (size_t i = 0; i < copied; i++) {
+            target[i] = static_cast<SQLWCHAR>(value[i]);
+        }
+        target[copied] = 0;
+        if (copied < value.size()) {
+            handle->diags.push_back(MockDiag{ SQL_STATE_STRING_TRUNCATED, "string data, right truncated" });
+            return SQL_SUCCESS_WITH_INFO;
+        }
+        return SQL_SUCCESS;
+    }
+
+    template <typename T>
+    SQLRETURN copy_value(T value, SQLPOINTER target, SQLLEN* indicator) {
+        if (target) {
+            std::memcpy(target, &value, sizeof(T));
+        }
+        if (indicator) {
+            *indicator = sizeof(T);
+        }
+        return SQL_SUCCESS;
+    }
+
+    SQLRETURN convert(const std::string& value, SQLSMALLINT target_type, SQLPOINTER target, SQLLEN length,
+                      SQLLEN* indicator, MockHandle* handle) {
+        switch (target_type) {
+            case SQL_C_CHAR:
+                return copy_string(value, static_cast<SQLCHAR*>(target), length, indicator, handle);
+            case SQL_C_WCHAR:
+                return copy_wide_string(value, static_cast<SQLWCHAR*>(target), length, indicator, handle);
+            case SQL_C_BIT:
+                return copy_value<unsigned char>(value == "1" || value == "t" || value == "true" ? 1 : 0, target, indicator);
+            case SQL_C_FLOAT:
+                return copy_value<SQLREAL>(std::strtof(value.c_str(), nullptr), target, indicator);
+            case SQL_C_DOUBLE:
+                return copy_value<SQLDOUBLE>(std::strtod(value.c_str(), nullptr), target, indicator);
+            case SQL_C_LONG:
+            case SQL_C_SLONG:
+                return copy_value<SQLINTEGER>(static_cast<SQLINTEGER>(std::strtol(value.c_str(), nullptr, 10)), target, indicator);
+            case SQL_C_SBIGINT:
+                return copy_value<SQLBIGINT>(std::strtoll(value.c_str(), nullptr, 10), target, indicator);
+            default:
+                return set_error(handle, SQL_STATE_INVALID_APPLICATION_BUFFER_TYPE, "program type out of range");
+        }
+    }
+
+    std::map<std::string, std::string> parse_connection_string(const std::string& conn_str) {
+        std::map<std::string, std::string> attributes;
+        size_t pos = 0;
+        while (pos < conn_str.size()) {
+            size_t equals = conn_str.find('=', pos);
+            if (equals == std::string::npos) {
+                break;
+            }
+            std::string key = conn_str.substr(pos, equals - pos);
+            std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::toupper(c); });
+
+            size_t end;
+            std::string value;
+            if (equals + 1 < conn_str.size() && conn_str[equals + 1] == '{') {
+                end = conn_str.find('}', equals + 1);
+                end = std::string::npos == end ? conn_str.size() : end;
+                value = conn_str.substr(equals + 2, end - equals - 2);
+                end = conn_str.find(';', end);
+            } else {
+                end = conn_str.find(';', equals);
+                value = conn_str.substr(equals + 1, (std::string::npos == end ? conn_str.size() : end) - equals - 1);
+            }
+            attributes[key] = value;
+            pos = std::string::npos == end ? conn_str.size() : end + 1;
+        }
+        return attributes;
+    }
+}
+
+extern "C" {
+
+SQLRETURN SQL_API SQLAllocHandle(SQLSMALLINT HandleType, SQLHANDLE InputHandle, SQLHANDLE* OutputHandle) {
+    if (!OutputHandle) {
+        return SQL_ERROR;
+    }
+    switch (HandleType) {
+        case SQL_HANDLE_ENV:
+            *OutputHandle = new MockEnv();
+            return SQL_SUCCESS;
+        case SQL_HANDLE_DBC:
+            if (!InputHandle) {
+                return SQL_INVALID_HANDLE;
+            }
+            *OutputHandle = new MockDbc();
+            return SQL_SUCCESS;
+        case SQL_HANDLE_STMT: {
+            if (!InputHandle) {
+                return SQL_INVALID_HANDLE;
+            }
+            MockDbc* dbc = static_cast<MockDbc*>(InputHandle);
+            dbc->diags.clear();
+            if (!dbc->connected) {
+                return set_error(dbc, SQL_STATE_CONNECTION_NOT_OPEN, "connection not open");
+            }
+            *OutputHandle = new MockStmt(dbc);
+            return SQL_SUCCESS;
+        }
+        default:
+            return SQL_ERROR;
+    }
+}
+
+SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT HandleType, SQLHANDLE Handle) {
+    if (!Handle) {
+        return SQL_INVALID_HANDLE;
+    }
+    switch (HandleType) {
+        case SQL_HANDLE_ENV:
+            delete static_cast<MockEnv*>(Handle);
+            return SQL_SUCCESS;
+        case SQL_HANDLE_DBC: {
+            MockDbc* dbc = static_cast<MockDbc*>(Handle);
+            if (dbc->connected) {
+                SimulatedCluster::GetInstance().Disconnect();
+            }
+            delete dbc;
+            return SQL_SUCCESS;
+        }
+        case SQL_HANDLE_STMT:
+            delete static_cast<MockStmt*>(Handle);
+            return SQL_SUCCESS;
+        default:
+            return SQL_ERROR;
+    }
+}
+
+SQLRETURN SQL_API SQLSetEnvAttr(SQLHENV EnvironmentHandle, SQLINTEGER, SQLPOINTER, SQLINTEGER) {
+    return EnvironmentHandle ? SQL_SUCCESS : SQL_INVALID_HANDLE;
+}
+
+SQLRETURN SQL_API SQLSetConnectAttr(SQLHDBC ConnectionHandle, SQLINTEGER, SQLPOINTER, SQLINTEGER) {
+    return ConnectionHandle ? SQL_SUCCESS : SQL_INVALID_HANDLE;
+}
+
+SQLRETURN SQL_API SQLSetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER, SQLPOINTER, SQLINTEGER) {
+    return StatementHandle ? SQL_SUCCESS : SQL_INVALID_HANDLE;
+}
+
+SQLRETURN SQL_API SQLGetInfo(SQLHDBC ConnectionHandle, SQLUSMALLINT InfoType, SQLPOINTER InfoValue,
+                             SQLSMALLINT BufferLength, SQLSMALLINT* StringLength) {
+    if (!ConnectionHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockDbc* dbc = static_cast<MockDbc*>(ConnectionHandle);
+    dbc->diags.clear();
+
+    const char* info;
+    switch (InfoType) {
+        case SQL_DRIVER_ODBC_VER:
+            info = DRIVER_ODBC_VER;
+            break;
+        case SQL_DRIVER_NAME:
+            info = DRIVER_NAME;
+            break;
+        case SQL_DRIVER_VER:
+            info = DRIVER_VER;
+            break;
+        case SQL_DBMS_NAME:
+            info = DBMS_NAME;
+            break;
+        default:
+            return set_error(dbc, SQL_STATE_INVALID_INFO_TYPE, "information type out of range");
+    }
+
+    SQLLEN length = 0;
+    SQLRETURN rc = copy_string(info, static_cast<SQLCHAR*>(InfoValue), BufferLength, &length, dbc);
+    if (StringLength) {
+        *StringLength = static_cast<SQLSMALLINT>(length);
+    }
+    return rc;
+}
+
+SQLRETURN SQL_API SQLDriverConnect(SQLHDBC ConnectionHandle, SQLHWND, SQLCHAR* InConnectionString, SQLSMALLINT StringLength1,
+                                   SQLCHAR* OutConnectionString, SQLSMALLINT BufferLength, SQLSMALLINT* StringLength2Ptr,
+                                   SQLUSMALLINT) {
+    if (!ConnectionHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockDbc* dbc = static_cast<MockDbc*>(ConnectionHandle);
+    dbc->diags.clear();
+
+    std::string conn_str = to_string(InConnectionString, StringLength1);
+    std::map<std::string, std::string> attributes = parse_connection_string(conn_str);
+    auto server = attributes.find(SERVER_KEY);
+    if (server == attributes.end() || server->second.empty()) {
+        return set_error(dbc, SQL_STATE_UNABLE_TO_CONNECT, "no SERVER in connection string");
+    }
+
+    std::string sql_state;
+    std::string message;
+    if (!SimulatedCluster::GetInstance().Connect(server->second, dbc->instance, dbc->session_epoch, sql_state, message)) {
+        return set_error(dbc, sql_state, message);
+    }
+    dbc->connected = true;
+
+    SQLLEN length = 0;
+    SQLRETURN rc = copy_string(conn_str, OutConnectionString, BufferLength, &length, dbc);
+    if (StringLength2Ptr) {
+        *StringLength2Ptr = static_cast<SQLSMALLINT>(length);
+    }
+    return rc;
+}
+
+SQLRETURN SQL_API SQLDisconnect(SQLHDBC ConnectionHandle) {
+    if (!ConnectionHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockDbc* dbc = static_cast<MockDbc*>(ConnectionHandle);
+    dbc->diags.clear();
+    if (dbc->connected) {
+        SimulatedCluster::GetInstance().Disconnect();
+        dbc->connected = false;
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLExecDirect(SQLHSTMT StatementHandle, SQLCHAR* StatementText, SQLINTEGER TextLength) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    stmt->diags.clear();
+    stmt->rows.clear();
+    stmt->curr_row = 0;
+    stmt->has_result = false;
+
+    std::string sql_state;
+    std::string message;
+    if (!SimulatedCluster::GetInstance().Execute(stmt->dbc->instance, stmt->dbc->session_epoch,
+            to_string(StatementText, TextLength), stmt->rows, sql_state, message)) {
+        return set_error(stmt, sql_state, message);
+    }
+    stmt->has_result = true;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT StatementHandle, SQLSMALLINT* ColumnCount) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    stmt->diags.clear();
+    if (ColumnCount) {
+        *ColumnCount = stmt->rows.empty() ? 0 : static_cast<SQLSMALLINT>(stmt->rows.front().size());
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLRowCount(SQLHSTMT StatementHandle, SQLLEN* RowCount) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    stmt->diags.clear();
+    if (RowCount) {
+        *RowCount = static_cast<SQLLEN>(stmt->rows.size());
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLBindCol(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLSMALLINT TargetType,
+                             SQLPOINTER TargetValue, SQLLEN BufferLength, SQLLEN* StrLen_or_Ind) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    stmt->diags.clear();
+    if (0 == ColumnNumber) {
+        return set_error(stmt, SQL_STATE_INVALID_DESCRIPTOR_INDEX, "invalid descriptor index");
+    }
+    if (!TargetValue) {
+        stmt->bindings.erase(ColumnNumber);
+    } else {
+        stmt->bindings[ColumnNumber] = MockBinding{ TargetType, TargetValue, BufferLength, StrLen_or_Ind };
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFetch(SQLHSTMT StatementHandle) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    stmt->diags.clear();
+    if (!stmt->has_result) {
+        return set_error(stmt, SQL_STATE_INVALID_CURSOR_STATE, "invalid cursor state");
+    }
+    if (stmt->curr_row >= stmt->rows.size()) {
+        return SQL_NO_DATA;
+    }
+
+    const std::vector<std::string>& row = stmt->rows[stmt->curr_row++];
+    SQLRETURN rc = SQL_SUCCESS;
+    for (const auto& [column, binding] : stmt->bindings) {
+        if (column > row.size()) {
+            return set_error(stmt, SQL_STATE_INVALID_DESCRIPTOR_INDEX, "invalid descriptor index");
+        }
+        SQLRETURN column_rc = convert(row[column - 1], binding.target_type, binding.target, binding.length, binding.indicator, stmt);
+        if (SQL_ERROR == column_rc) {
+            return column_rc;
+        }
+        rc = std::max(rc, column_rc);
+    }
+    return rc;
+}
+
+SQLRETURN SQL_API SQLGetData(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLSMALLINT TargetType,
+                             SQLPOINTER TargetValue, SQLLEN BufferLength, SQLLEN* StrLen_or_Ind) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    stmt->diags.clear();
+    if (!stmt->has_result || 0 == stmt->curr_row) {
+        return set_error(stmt, SQL_STATE_INVALID_CURSOR_STATE, "invalid cursor state");
+    }
+    const std::vector<std::string>& row = stmt->rows[stmt->curr_row - 1];
+    if (0 == ColumnNumber || ColumnNumber > row.size()) {
+        return set_error(stmt, SQL_STATE_INVALID_DESCRIPTOR_INDEX, "invalid descriptor index");
+    }
+    return convert(row[ColumnNumber - 1], TargetType, TargetValue, BufferLength, StrLen_or_Ind, stmt);
+}
+
+SQLRETURN SQL_API SQLMoreResults(SQLHSTMT StatementHandle) {
+    return StatementHandle ? SQL_NO_DATA : SQL_INVALID_HANDLE;
+}
+
+SQLRETURN SQL_API SQLCloseCursor(SQLHSTMT StatementHandle) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    stmt->diags.clear();
+    stmt->rows.clear();
+    stmt->curr_row = 0;
+    stmt->has_result = false;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT StatementHandle, SQLUSMALLINT Option) {
+    if (!StatementHandle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockStmt* stmt = static_cast<MockStmt*>(StatementHandle);
+    switch (Option) {
+        case SQL_CLOSE:
+            return SQLCloseCursor(StatementHandle);
+        case SQL_UNBIND:
+            stmt->bindings.clear();
+            return SQL_SUCCESS;
+        case SQL_RESET_PARAMS:
+            return SQL_SUCCESS;
+        case SQL_DROP:
+            return SQLFreeHandle(SQL_HANDLE_STMT, StatementHandle);
+        default:
+            return SQL_ERROR;
+    }
+}
+
+SQLRETURN SQL_API SQLCancel(SQLHSTMT StatementHandle) {
+    return StatementHandle ? SQL_SUCCESS : SQL_INVALID_HANDLE;
+}
+
+SQLRETURN SQL_API SQLGetDiagRec(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT RecNumber, SQLCHAR* Sqlstate,
+                                SQLINTEGER* NativeError, SQLCHAR* MessageText, SQLSMALLINT BufferLength,
+                                SQLSMALLINT* TextLength) {
+    if (!Handle) {
+        return SQL_INVALID_HANDLE;
+    }
+    MockHandle* handle = to_handle(HandleType, Handle);
+    if (!handle || handle->handle_type != HandleType || RecNumber <= 0) {
+        return SQL_ERROR;
+    }
+    if (static_cast<size_t>(RecNumber) > handle->diags.size()) {
+        return SQL_NO_DATA;
+    }
+
+    const MockDiag& diag = handle->diags[RecNumber - 1];
+    if (Sqlstate) {
+        std::memcpy(Sqlstate, diag.sql_state.c_str(), diag.sql_state.size() + 1);
+    }
+    if (NativeError) {
+        *NativeError = 0;
+    }
+    SQLRETURN rc = SQL_SUCCESS;
+    if (MessageText && BufferLength > 0) {
+        size_t copied = std::min(diag.message.size(), static_cast<size_t>(BufferLength - 1));
+        std::memcpy(MessageText, diag.message.data(), copied);
+        MessageText[copied] = '\0';
+        rc = copied < diag.message.size() ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
+    }
+    if (TextLength) {
+        *TextLength = static_cast<SQLSMALLINT>(diag.message.size());
+    }
+    return rc;
+}
+
+} // extern "C"
@@ -0,0 +1,367 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "simulated_cluster.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    const char* SCRIPT_ENV_VAR = "MOCK_ODBC_SCRIPT";
+    const char* ALL_INSTANCES = "*";
+
+    std::string to_lower(std::string str) {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+        return str;
+    }
+
+    std::string to_upper(std::string str) {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::toupper(c); });
+        return str;
+    }
+
+    std::vector<std::string> tokenize(const std::string& statement) {
+        std::vector<std::string> tokens;
+        std::istringstream stream(statement);
+        std::string token;
+        while (stream >> token) {
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    bool is_control_statement(const std::string& query) {
+        size_t start = query.find_first_not_of(" \t\r\n");
+        return start != std::string::npos && to_upper(query.substr(start, 5)) == "MOCK ";
+    }
+
+    uint32_t parse_ms(const std::string& value) {
+        size_t parsed = 0;
+        unsigned long ms = std::stoul(value, &parsed);
+        if (parsed != value.size()) {
+            throw std::invalid_argument(value);
+        }
+        return static_cast<uint32_t>(ms);
+    }
+}
+
+const std::vector<std::string> SimulatedCluster::DEFAULT_INSTANCES = { "instance-1", "instance-2", "instance-3" };
+const uint32_t SimulatedCluster::DEFAULT_DOWNTIME_MS = 1000;
+
+SimulatedCluster& SimulatedCluster::GetInstance() {
+    static SimulatedCluster cluster;
+    return cluster;
+}
+
+SimulatedCluster::SimulatedCluster() {
+    reset(DEFAULT_INSTANCES);
+
+    // Allows scripting the cluster when the driver is used through unixODBC by an unmodified application
+    const char* script = std::getenv(SCRIPT_ENV_VAR);
+    if (script) {
+        std::istringstream statements(script);
+        std::string statement;
+        while (std::getline(statements, statement, ';')) {
+            ResultSet result;
+            std::string sql_state;
+            std::string message;
+            if (is_control_statement(statement)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                execute_control(statement, result, sql_state, message);
+            }
+        }
+    }
+}
+
+bool SimulatedCluster::Connect(const std::string& server, std::string& instance, uint64_t& session_epoch,
+                               std::string& sql_state, std::string& message) {
+    std::string resolved;
+    uint32_t latency_ms = 0;
+    uint32_t blackhole_ms = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        apply_scheduled_failovers(std::chrono::steady_clock::now());
+        resolved = resolve(to_lower(server));
+        auto itr = instances_.find(resolved);
+        if (itr == instances_.end()) {
+            failed_connects_++;
+            sql_state = SQL_STATE_UNABLE_TO_CONNECT;
+            message = "could not translate host name \"" + server + "\" to address";
+            return false;
+        }
+        latency_ms = itr->second.latency_ms;
+        blackhole_ms = itr->second.blackhole_ms;
+    }
+
+    // Network conditions are simulated without holding the lock, like any other slow host
+    if (blackhole_ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(blackhole_ms));
+        failed_connects_++;
+        sql_state = SQL_STATE_UNABLE_TO_CONNECT;
+        message = "timeout expired connecting to \"" + server + "\"";
+        return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    apply_scheduled_failovers(std::chrono::steady_clock::now());
+    if (!is_up(resolved, std::chrono::steady_clock::now())) {
+        failed_connects_++;
+        sql_state = SQL_STATE_UNABLE_TO_CONNECT;
+        message = "connection to \"" + server + "\" refused";
+        return false;
+    }
+    instance = resolved;
+    session_epoch = instances_.at(resolved).epoch;
+    connects_++;
+    open_connections_++;
+    return true;
+}
+
+void SimulatedCluster::Disconnect() {
+    open_connections_--;
+}
+
+bool SimulatedCluster::Execute(const std::string& instance, uint64_t session_epoch, const std::string& query,
+                               ResultSet& result, std::string& sql_state, std::string& message) {
+    result.clear();
+    if (is_control_statement(query)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return execute_control(query, result, sql_state, message);
+    }
+
+    queries_++;
+    uint32_t latency_ms = 0;
+    uint32_t blackhole_ms = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itr = instances_.find(instance);
+        if (itr != instances_.end()) {
+            latency_ms = itr->second.latency_ms;
+            blackhole_ms = itr->second.blackhole_ms;
+        }
+    }
+
+    if (blackhole_ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(blackhole_ms));
+        failed_queries_++;
+        sql_state = SQL_STATE_COMMUNICATION_LINK_FAILURE;
+        message = "could not receive data from server: Connection timed out";
+        return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    apply_scheduled_failovers(now);
+    if (!is_up(instance, now) || instances_.at(instance).epoch != session_epoch) {
+        failed_queries_++;
+        sql_state = SQL_STATE_COMMUNICATION_LINK_FAILURE;
+        message = "server closed the connection unexpectedly";
+        return false;
+    }
+
+    bool is_writer = instance == writer_;
+    if (query.find("aurora_limitless_router_endpoints") != std::string::npos) {
+        for (const auto& [router_endpoint, load] : routers_) {
+            result.push_back({ router_endpoint, load });
+        }
+    } else if (query.find("limitless_subclusters") != std::string::npos) {
+        result.push_back({ routers_.empty() ? "0" : "1" });
+    } else if (query.find("aurora_replica_status") != std::string::npos) {
+        if (query.find("aurora_db_instance_identifier") != std::string::npos) {
+            // Writer ID query, only returns a row when connected to the writer
+            if (is_writer) {
+                result.push_back({ instance });
+            }
+        } else {
+            for (const std::string& id : instance_order_) {
+                result.push_back({ id, id == writer_ ? "1" : "0", "0", "0" });
+            }
+        }
+    } else if (query.find("aurora_db_instance_identifier") != std::string::npos) {
+        result.push_back({ instance });
+    } else if (query.find("pg_is_in_recovery") != std::string::npos) {
+        result.push_back({ is_writer ? "0" : "1" });
+    } else if (query.find("SELECT 1") != std::string::npos) {
+        result.push_back({ "1" });
+    } else {
+        failed_queries_++;
+        sql_state = SQL_STATE_SYNTAX_ERROR;
+        message = "query is not supported by the mock driver: " + query;
+        return false;
+    }
+    return true;
+}
+
+bool SimulatedCluster::execute_control(const std::string& statement, ResultSet& result,
+                                       std::string& sql_state, std::string& message) {
+    std::vector<std::string> tokens = tokenize(statement);
+    std::string command = tokens.size() > 1 ? to_upper(tokens[1]) : "";
+    std::vector<std::string> args(tokens.size() > 2 ? tokens.begin() + 2 : tokens.end(), tokens.end());
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    apply_scheduled_failovers(now);
+
+    auto for_each_target = [this, &sql_state, &message](const std::string& target, const auto& update) {
+        std::string id = to_lower(target);
+        if (id == ALL_INSTANCES) {
+            for (auto& [name, instance] : instances_) {
+                update(instance);
+            }
+            return true;
+        }
+        auto itr = instances_.find(id);
+        if (itr == instances_.end()) {
+            sql_state = SQL_STATE_SYNTAX_ERROR;
+            message = "unknown instance: " + target;
+            return false;
+        }
+        update(itr->second);
+        return true;
+    };
+
+    try {
+        if (command == "CLUSTER" && !args.empty()) {
+            std::vector<std::string> ids;
+            std::transform(args.begin(), args.end(), std::back_inserter(ids), to_lower);
+            reset(ids);
+            return true;
+        }
+        if (command == "FAILOVER" && !args.empty() && args.size() <= 3) {
+            std::string new_writer = to_lower(args[0]);
+            if (!instances_.contains(new_writer)) {
+                sql_state = SQL_STATE_SYNTAX_ERROR;
+                message = "unknown instance: " + args[0];
+                return false;
+            }
+            uint32_t delay_ms = args.size() > 1 ? parse_ms(args[1]) : 0;
+            uint32_t downtime_ms = args.size() > 2 ? parse_ms(args[2]) : DEFAULT_DOWNTIME_MS;
+            scheduled_failovers_.push_back(ScheduledFailover{ now + std::chrono::milliseconds(delay_ms), new_writer, downtime_ms });
+            apply_scheduled_failovers(now);
+            return true;
+        }
+        if (command == "LATENCY" && args.size() == 2) {
+            uint32_t latency_ms = parse_ms(args[1]);
+            return for_each_target(args[0], [latency_ms](Instance& instance) { instance.latency_ms = latency_ms; });
+        }
+        if (command == "BLACKHOLE" && args.size() == 2) {
+            uint32_t blackhole_ms = parse_ms(args[1]);
+            return for_each_target(args[0], [blackhole_ms](Instance& instance) { instance.blackhole_ms = blackhole_ms; });
+        }
+        if (command == "RESTORE" && args.size() == 1) {
+            return for_each_target(args[0], [](Instance& instance) {
+                instance.latency_ms = 0;
+                instance.blackhole_ms = 0;
+            });
+        }
+        if (command == "ROUTERS" && args.size() % 2 == 0) {
+            routers_.clear();
+            for (size_t i = 0; i < args.size(); i += 2) {
+                routers_.emplace_back(args[i], args[i + 1]);
+            }
+            return true;
+        }
+        if (command == "STATS" && args.empty()) {
+            result.push_back({ "connects", std::to_string(connects_.load()) });
+            result.push_back({ "failed_connects", std::to_string(failed_connects_.load()) });
+            result.push_back({ "open_connections", std::to_string(open_connections_.load()) });
+            result.push_back({ "queries", std::to_string(queries_.load()) });
+            result.push_back({ "failed_queries", std::to_string(failed_queries_.load()) });
+            result.push_back({ "failovers", std::to_string(failovers_.load()) });
+            return true;
+        }
+    } catch (const std::exception& ex) {
+        sql_state = SQL_STATE_SYNTAX_ERROR;
+        message = "invalid number in mock statement: " + statement;
+        return false;
+    }
+
+    sql_state = SQL_STATE_SYNTAX_ERROR;
+    message = "invalid mock statement: " + statement;
+    return false;
+}
+
+void SimulatedCluster::reset(const std::vector<std::string>& instances) {
+    // Epochs keep increasing across resets, so sessions opened on a previous cluster never validate
+    uint64_t next_epoch = 0;
+    for (const auto& [id, instance] : instances_) {
+        next_epoch = std::max(next_epoch, instance.epoch);
+    }
+
+    instances_.clear();
+    instance_order_ = instances;
+    for (const std::string& id : instance_order_) {
+        instances_[id].epoch = ++next_epoch;
+    }
+    writer_ = instance_order_.empty() ? "" : instance_order_.front();
+    scheduled_failovers_.clear();
+    routers_.clear();
+    next_reader_ = 0;
+}
+
+void SimulatedCluster::apply_scheduled_failovers(std::chrono::steady_clock::time_point now) {
+    auto itr = scheduled_failovers_.begin();
+    while (itr != scheduled_failovers_.end()) {
+        if (itr->at > now) {
+            ++itr;
+            continue;
+        }
+
+        uint64_t next_epoch = 0;
+        for (const auto& [id, instance] : instances_) {
+            next_epoch = std::max(next_epoch, instance.epoch);
+        }
+
+        // Both the demoted writer and the promoted reader restart, dropping their sessions
+        std::chrono::steady_clock::time_point down_until = itr->at + std::chrono::milliseconds(itr->downtime_ms);
+        for (const std::string& id : { writer_, itr->new_writer }) {
+            auto restarted = instances_.find(id);
+            if (restarted != instances_.end()) {
+                restarted->second.epoch = ++next_epoch;
+                restarted->second.down_until = down_until;
+            }
+        }
+        writer_ = itr->new_writer;
+        failovers_++;
+        itr = scheduled_failovers_.erase(itr);
+    }
+}
+
+std::string SimulatedCluster::resolve(const std::string& server) {
+    if (server.find(".cluster-ro-") != std::string::npos) {
+        // Reader endpoint rotates over the readers that are up, like its DNS record
+        std::vector<std::string> readers;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for (const std::string& id : instance_order_) {
+            if (id != writer_ && is_up(id, now)) {
+                readers.push_back(id);
+            }
+        }
+        return readers.empty() ? writer_ : readers[next_reader_++ % readers.size()];
+    }
+    if (server.find(".cluster-") != std::string::npos) {
+        return writer_;
+    }
+    return server.substr(0, server.find('.'));
+}
+
+bool SimulatedCluster::is_up(const std::string& instance, std::chrono::steady_clock::time_point now) const {
+    auto itr = instances_.find(instance);
+    return itr != instances_.end() && itr->second.down_until <= now;
+}
@@ -0,0 +1,107 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIMULATED_CLUSTER_H
+#define SIMULATED_CLUSTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define SQL_STATE_UNABLE_TO_CONNECT "08001"
+#define SQL_STATE_COMMUNICATION_LINK_FAILURE "08S01"
+#define SQL_STATE_SYNTAX_ERROR "42000"
+
+/**
+ * In-process stand-in for an Aurora PostgreSQL cluster, backing the mock ODBC driver.
+ *
+ * Instances are addressed the same way as on RDS, by the first label of the SERVER value.
+ * The cluster and cluster-ro endpoints resolve to the current writer and to a reader.
+ * Connections are bound to the instance they resolved to, and break once that instance restarts.
+ *
+ * The cluster is scripted by executing statements starting with MOCK on any connection:
+ *   MOCK CLUSTER <writer> [<reader> ...]                  replaces the cluster, the first instance is the writer
+ *   MOCK FAILOVER <new writer> [<delay ms> [<downtime ms>]] promotes a reader, both instances restart during downtime
+ *   MOCK LATENCY <instance|*> <ms>                         delays every connect and query to the instance
+ *   MOCK BLACKHOLE <instance|*> <ms>                       connects and queries hang for ms, then fail
+ *   MOCK RESTORE <instance|*>                              clears latency and black holes
+ *   MOCK ROUTERS [<router endpoint> <load> ...]            sets the limitless routers, none disables limitless
+ *   MOCK STATS                                             returns counters as (name, value) rows
+ */
+class SimulatedCluster {
+public:
+    typedef std::vector<std::vector<std::string>> ResultSet;
+
+    static const std::vector<std::string> DEFAULT_INSTANCES;
+    static const uint32_t DEFAULT_DOWNTIME_MS;
+
+    static SimulatedCluster& GetInstance();
+
+    /**
+     * Resolves the server to an instance and opens a simulated session on it.
+     * Returns false with an SQL state and message if the instance is unknown, down or black-holed.
+     */
+    bool Connect(const std::string& server, std::string& instance, uint64_t& session_epoch,
+        std::string& sql_state, std::string& message);
+    void Disconnect();
+
+    /**
+     * Runs a query on a session opened by Connect, or a MOCK control statement on any session.
+     */
+    bool Execute(const std::string& instance, uint64_t session_epoch, const std::string& query,
+        ResultSet& result, std::string& sql_state, std::string& message);
+
+private:
+    struct Instance {
+        uint64_t epoch = 0;
+        uint32_t latency_ms = 0;
+        uint32_t blackhole_ms = 0;
+        std::chrono::steady_clock::time_point down_until;
+    };
+
+    struct ScheduledFailover {
+        std::chrono::steady_clock::time_point at;
+        std::string new_writer;
+        uint32_t downtime_ms;
+    };
+
+    SimulatedCluster();
+
+    bool execute_control(const std::string& statement, ResultSet& result, std::string& sql_state, std::string& message);
+    void reset(const std::vector<std::string>& instances);
+    void apply_scheduled_failovers(std::chrono::steady_clock::time_point now);
+    std::string resolve(const std::string& server);
+    bool is_up(const std::string& instance, std::chrono::steady_clock::time_point now) const;
+
+    std::mutex mutex_;
+    std::map<std::string, Instance> instances_;
+    std::vector<std::string> instance_order_;
+    std::string writer_;
+    std::vector<ScheduledFailover> scheduled_failovers_;
+    std::vector<std::pair<std::string, std::string>> routers_;
+    size_t next_reader_ = 0;
+
+    std::atomic<uint64_t> connects_ = 0;
+    std::atomic<uint64_t> failed_connects_ = 0;
+    std::atomic<uint64_t> open_connections_ = 0;
+    std::atomic<uint64_t> queries_ = 0;
+    std::atomic<uint64_t> failed_queries_ = 0;
+    std::atomic<uint64_t> failovers_ = 0;
+};
+
+#endif // SIMULATED_CLUSTER_H
@@ -0,0 +1,84 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include "connection_string_helper.h"
+
+namespace {
+    SQLSTR conn_str = TEXT(
+        "DSN=aws-rds-odbc;"                                                 \
+        "SERVER=database-pg-name.cluster-XYZ.us-east-2.rds.amazonaws.com;"  \
+        "PORT=5432;"                                                        \
+        "DATABASE=postgres;"                                                \
+        "UID=user;"                                                         \
+        "PWD=password;"                                                     \
+        "SSLMODE=require;"                                                  \
+        "ENABLECLUSTERFAILOVER=1;"                                          \
+        "FAILOVERMODE=READER_OR_WRITER;"                                    \
+        "READERHOSTSELECTORSTRATEGY=ROUND_ROBIN;"                           \
+        "FAILOVERTIMEOUT=10000;");
+
+    // Pads the connection string with the given number of additional attributes
+    SQLSTR padded_conn_str(int64_t extra_attributes) {
+        SQLSTR padded = conn_str;
+        for (int64_t i = 0; i < extra_attributes; i++) {
+            padded += StringHelper::ToSQLSTR("ATTRIBUTE" + std::to_string(i) + "=value" + std::to_string(i) + ";");
+        }
+        return padded;
+    }
+}
+
+static void BM_ParseConnectionString(benchmark::State& state) {
+    SQLSTR input = padded_conn_str(state.range(0));
+    for (auto _ : state) {
+        std::map<SQLSTR, SQLSTR> conn_info;
+        ConnectionStringHelper::ParseConnectionString(input, conn_info);
+        benchmark::DoNotOptimize(conn_info);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size() * sizeof(SQLTCHAR));
+}
+
+static void BM_BuildConnectionString(benchmark::State& state) {
+    std::map<SQLSTR, SQLSTR> conn_info;
+    ConnectionStringHelper::ParseConnectionString(padded_conn_str(state.range(0)), conn_info);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ConnectionStringHelper::BuildConnectionString(conn_info));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ConnectionStringIndexWith(benchmark::State& state) {
+    SQLSTR input = padded_conn_str(state.range(0));
+    SQLSTR host = TEXT("database-pg-name-instance-1.XYZ.us-east-2.rds.amazonaws.com");
+    for (auto _ : state) {
+        ConnectionStringIndex index(input);
+        benchmark::DoNotOptimize(index.With({ { TEXT("SERVER"), host }, { TEXT("ENABLECLUSTERFAILOVER"), TEXT("0") } }, false));
+    }
+    state.SetBytesProcessed(state.iterations() * input.size() * sizeof(SQLTCHAR));
+}
+
+static void BM_ConnectionStringTemplateForHost(benchmark::State& state) {
+    ConnectionStringTemplate conn_template(padded_conn_str(state.range(0)), { { TEXT("ENABLECLUSTERFAILOVER"), TEXT("0") } }, false);
+    SQLSTR host = TEXT("database-pg-name-instance-1.XYZ.us-east-2.rds.amazonaws.com");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conn_template.ForHost(host));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ParseConnectionString)->RangeMultiplier(4)->Range(0, 64)->ThreadRange(1, 8);
+BENCHMARK(BM_BuildConnectionString)->RangeMultiplier(4)->Range(0, 64)->ThreadRange(1, 8);
+BENCHMARK(BM_ConnectionStringIndexWith)->RangeMultiplier(4)->Range(0, 64)->ThreadRange(1, 8);
+BENCHMARK(BM_ConnectionStringTemplateForHost)->RangeMultiplier(4)->Range(0, 64)->ThreadRange(1, 8);
@@ -0,0 +1,62 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <string>
+
+#include "rds_utils.h"
+
+namespace {
+    // One host of every kind the classifiers distinguish
+    const std::array<std::string, 10> hosts = {
+        "database-test-name.cluster-XYZ.us-east-2.rds.amazonaws.com",
+        "database-test-name.cluster-ro-XYZ.us-east-2.rds.amazonaws.com",
+        "database-test-name.cluster-custom-XYZ.us-east-2.rds.amazonaws.com",
+        "instance-test-name.XYZ.us-east-2.rds.amazonaws.com",
+        "proxy-test-name.proxy-XYZ.us-east-2.rds.amazonaws.com",
+        "database-test-name.cluster-XYZ.rds.cn-northwest-1.amazonaws.com.cn",
+        "database-test-name.cluster-XYZ.us-isob-east-1.rds.sc2s.sgov.gov",
+        "10.10.10.10",
+        "2001:0db8:85a3:0000:0000:8a2e:0370:7334",
+        "example.com"
+    };
+}
+
+#define RDS_UTILS_BENCHMARK(FUNCTION)                                       \
+    static void BM_##FUNCTION(benchmark::State& state) {                    \
+        size_t i = 0;                                                       \
+        for (auto _ : state) {                                              \
+            benchmark::DoNotOptimize(RdsUtils::FUNCTION(hosts[i++ % hosts.size()])); \
+        }                                                                   \
+        state.SetItemsProcessed(state.iterations());                        \
+    }                                                                       \
+    BENCHMARK(BM_##FUNCTION)->ThreadRange(1, 8);
+
+RDS_UTILS_BENCHMARK(IsDnsPatternValid)
+RDS_UTILS_BENCHMARK(IsRdsDns)
+RDS_UTILS_BENCHMARK(IsRdsClusterDns)
+RDS_UTILS_BENCHMARK(IsRdsProxyDns)
+RDS_UTILS_BENCHMARK(IsRdsWriterClusterDns)
+RDS_UTILS_BENCHMARK(IsRdsReaderClusterDns)
+RDS_UTILS_BENCHMARK(IsRdsCustomClusterDns)
+RDS_UTILS_BENCHMARK(IsIpv4)
+RDS_UTILS_BENCHMARK(IsIpv6)
+RDS_UTILS_BENCHMARK(GetRdsClusterHostUrl)
+RDS_UTILS_BENCHMARK(GetRdsClusterId)
+RDS_UTILS_BENCHMARK(GetRdsInstanceHostPattern)
+RDS_UTILS_BENCHMARK(GetRdsInstanceId)
+RDS_UTILS_BENCHMARK(GetRdsRegion)
+RDS_UTILS_BENCHMARK(ParseHost)
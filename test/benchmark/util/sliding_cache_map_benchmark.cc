@@ -0,0 +1,104 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include "../benchmark_helper.h"
+#include "sliding_cache_map.h"
+
+namespace {
+    const int cluster_count = 16;
+
+    std::string cluster_key(int64_t i) {
+        return "cluster-" + std::to_string(i % cluster_count);
+    }
+}
+
+// Shared across threads of a run to measure contention, same as the global topology map
+static SlidingCacheMap<std::string, std::vector<HostInfo>> topology_map;
+
+static void BM_SlidingCacheMapGet(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::vector<HostInfo> hosts = BenchmarkHelper::CreateTopology(static_cast<int>(state.range(0)));
+        for (int i = 0; i < cluster_count; i++) {
+            topology_map.Put(cluster_key(i), hosts);
+        }
+    }
+    int64_t i = state.thread_index();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(topology_map.Get(cluster_key(i++)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SlidingCacheMapFind(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::vector<HostInfo> hosts = BenchmarkHelper::CreateTopology(static_cast<int>(state.range(0)));
+        for (int i = 0; i < cluster_count; i++) {
+            topology_map.Put(cluster_key(i), hosts);
+        }
+    }
+    int64_t i = state.thread_index();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(topology_map.Find(cluster_key(i++)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SlidingCacheMapPut(benchmark::State& state) {
+    std::vector<HostInfo> hosts = BenchmarkHelper::CreateTopology(static_cast<int>(state.range(0)));
+    int64_t i = state.thread_index();
+    for (auto _ : state) {
+        topology_map.Put(cluster_key(i++), hosts);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// One writer thread per run, the remaining threads read
+static void BM_SlidingCacheMapMixed(benchmark::State& state) {
+    std::vector<HostInfo> hosts = BenchmarkHelper::CreateTopology(static_cast<int>(state.range(0)));
+    if (state.thread_index() == 0) {
+        for (int i = 0; i < cluster_count; i++) {
+            topology_map.Put(cluster_key(i), hosts);
+        }
+    }
+    int64_t i = state.thread_index();
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            topology_map.Put(cluster_key(i++), hosts);
+        } else {
+            benchmark::DoNotOptimize(topology_map.Get(cluster_key(i++)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SlidingCacheMapSize(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::vector<HostInfo> hosts = BenchmarkHelper::CreateTopology(1);
+        for (int i = 0; i < cluster_count; i++) {
+            topology_map.Put(cluster_key(i), hosts);
+        }
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(topology_map.Size());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SlidingCacheMapGet)->TOPOLOGY_SIZES->THREAD_COUNTS;
+BENCHMARK(BM_SlidingCacheMapFind)->TOPOLOGY_SIZES->THREAD_COUNTS;
+BENCHMARK(BM_SlidingCacheMapPut)->TOPOLOGY_SIZES->THREAD_COUNTS;
+BENCHMARK(BM_SlidingCacheMapMixed)->TOPOLOGY_SIZES->ThreadRange(2, 8);
+BENCHMARK(BM_SlidingCacheMapSize)->THREAD_COUNTS;
@@ -0,0 +1,155 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "auth_context.h"
+
+#include <chrono>
+#include <cstring>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../mock_objects.h"
+
+namespace {
+    const char* access_key("test_access_key");
+    const char* secret_key("test_secret_key");
+    const char* session_key("test_session_key");
+
+    FederatedAuthConfig adfs_config() {
+        FederatedAuthConfig config = {};
+        strcpy(config.idp_endpoint, "endpoint");
+        strcpy(config.idp_port, "1234");
+        strcpy(config.relaying_party_id, "urn:amazon:webservices");
+        strcpy(config.iam_role_arn, "arn:aws:iam::123456789012:role/role");
+        strcpy(config.iam_idp_arn, "arn:aws:iam::123456789012:saml-provider/idp");
+        strcpy(config.idp_username, "user");
+        strcpy(config.idp_password, "pwd");
+        return config;
+    }
+}
+
+static Aws::SDKOptions sdk_options;
+
+// Identity provider that skips the sign in flow, and counts how often it runs
+class TestFederatedProvider : public FederationCredentialProvider {
+public:
+    TestFederatedProvider(std::shared_ptr<Aws::STS::STSClient> sts_client, int& sign_in_count)
+        : FederationCredentialProvider("idp_arn", "role_arn", nullptr, std::move(sts_client)), sign_in_count(sign_in_count) {}
+
+protected:
+    std::string GetSAMLAssertion(std::string& err_info) override {
+        sign_in_count++;
+        return "saml_assertion";
+    }
+
+private:
+    int& sign_in_count;
+};
+
+class AuthContextTest : public testing::Test {
+protected:
+    std::shared_ptr<MOCK_STS_CLIENT> mock_sts_client;
+    int sign_in_count = 0;
+
+    // Runs once per suite
+    static void SetUpTestSuite() {
+        Aws::InitAPI(sdk_options);
+    }
+    static void TearDownTestSuite() {
+        Aws::ShutdownAPI(sdk_options);
+    }
+
+    // Runs per test case
+    void SetUp() override {
+        mock_sts_client = std::make_shared<MOCK_STS_CLIENT>();
+        sign_in_count = 0;
+    }
+    void TearDown() override {
+        mock_sts_client.reset();
+    }
+
+    static Aws::STS::Model::AssumeRoleWithSAMLOutcome saml_outcome(std::chrono::system_clock::duration lifetime) {
+        Aws::STS::Model::Credentials credentials;
+        credentials.SetAccessKeyId(access_key);
+        credentials.SetSecretAccessKey(secret_key);
+        credentials.SetSessionToken(session_key);
+        credentials.SetExpiration(Aws::Utils::DateTime(std::chrono::system_clock::now() + lifetime));
+        Aws::STS::Model::AssumeRoleWithSAMLResult saml_result;
+        saml_result.SetCredentials(credentials);
+        return Aws::STS::Model::AssumeRoleWithSAMLOutcome(saml_result);
+    }
+};
+
+TEST_F(AuthContextTest, ValidateConfig) {
+    FederatedAuthConfig empty_config = {};
+    EXPECT_TRUE(AuthContext::ValidateConfig(IAM, empty_config));
+    EXPECT_FALSE(AuthContext::ValidateConfig(ADFS, empty_config));
+    EXPECT_FALSE(AuthContext::ValidateConfig(OKTA, empty_config));
+    EXPECT_FALSE(AuthContext::ValidateConfig(INVALID, empty_config));
+
+    FederatedAuthConfig config = adfs_config();
+    EXPECT_TRUE(AuthContext::ValidateConfig(ADFS, config));
+    // Okta needs the app ID instead of the relaying party ID
+    EXPECT_FALSE(AuthContext::ValidateConfig(OKTA, config));
+    strcpy(config.app_id, "app");
+    EXPECT_TRUE(AuthContext::ValidateConfig(OKTA, config));
+}
+
+TEST_F(AuthContextTest, Key) {
+    FederatedAuthConfig empty_config = {};
+    FederatedAuthConfig config = adfs_config();
+
+    // IAM ignores the federated configuration
+    EXPECT_EQ(AuthContext::Key(IAM, empty_config), AuthContext::Key(IAM, config));
+    EXPECT_NE(AuthContext::Key(IAM, config), AuthContext::Key(ADFS, config));
+    EXPECT_NE(AuthContext::Key(ADFS, config), AuthContext::Key(OKTA, config));
+    EXPECT_EQ(AuthContext::Key(ADFS, config), AuthContext::Key(ADFS, adfs_config()));
+
+    FederatedAuthConfig other_user = adfs_config();
+    strcpy(other_user.idp_username, "other");
+    EXPECT_NE(AuthContext::Key(ADFS, config), AuthContext::Key(ADFS, other_user));
+
+    // Moving characters between adjacent fields changes the key
+    FederatedAuthConfig shifted = adfs_config();
+    strcpy(shifted.idp_username, "userp");
+    strcpy(shifted.idp_password, "wd");
+    EXPECT_NE(AuthContext::Key(ADFS, config), AuthContext::Key(ADFS, shifted));
+}
+
+TEST_F(AuthContextTest, FederatedCredentialsCached) {
+    EXPECT_CALL(*mock_sts_client, AssumeRoleWithSAML(testing::_))
+        .WillOnce(testing::Return(saml_outcome(std::chrono::hours(1))));
+
+    AuthContext context(ADFS, std::make_unique<TestFederatedProvider>(mock_sts_client, sign_in_count));
+    std::string token;
+    EXPECT_TRUE(context.GenerateConnectAuthToken(token, "host", "us-east-1", 5432, "user"));
+    EXPECT_FALSE(token.empty());
+    EXPECT_TRUE(context.GenerateConnectAuthToken(token, "host", "us-east-1", 5432, "user"));
+    EXPECT_TRUE(context.GenerateConnectAuthToken(token, "other-host", "us-east-1", 5432, "user"));
+    EXPECT_EQ(1, sign_in_count);
+}
+
+TEST_F(AuthContextTest, ExpiredFederatedCredentialsNotCached) {
+    EXPECT_CALL(*mock_sts_client, AssumeRoleWithSAML(testing::_))
+        .WillOnce(testing::Return(saml_outcome(std::chrono::seconds(-1))))
+        .WillOnce(testing::Return(saml_outcome(std::chrono::hours(1))));
+
+    AuthContext context(OKTA, std::make_unique<TestFederatedProvider>(mock_sts_client, sign_in_count));
+    std::string token;
+    EXPECT_TRUE(context.GenerateConnectAuthToken(token, "host", "us-east-1", 5432, "user"));
+    EXPECT_TRUE(context.GenerateConnectAuthToken(token, "host", "us-east-1", 5432, "user"));
+    EXPECT_TRUE(context.GenerateConnectAuthToken(token, "host", "us-east-1", 5432, "user"));
+    EXPECT_EQ(2, sign_in_count);
+}
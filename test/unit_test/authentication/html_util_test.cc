@@ -0,0 +1,144 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "html_util.h"
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+    const std::string sign_on_page(
+        "<!DOCTYPE html><html><head><title>Sign In</title>"
+        "<script type=\"text/javascript\">var form = '<form action=\"/fake\">'; if (a < b) { document.write('<input name=\"Fake\" value=\"x\">'); }</script>"
+        "<style>input { color: red; }</style></head><body>\n"
+        "<!-- <form action=\"/commented\"> <input name=\"Commented\" value=\"x\"> -->\n"
+        "<FORM method=\"post\" id=\"loginForm\" onKeyPress=\"if (event && event.keyCode == 13) Login.submitLoginRequest();\"\n"
+        "    action=\"/adfs/ls/IdpInitiatedSignOn.aspx?loginToRp=urn:amazon:webservices&amp;client-request-id=1234\">\n"
+        "<input id=\"userNameInput\" name=\"UserName\" type=\"email\" value=\"\" tabindex=\"1\" />\n"
+        "<input id=\"passwordInput\" name=\"Password\" type=\"password\" value=\"\"/>\n"
+        "<input type=hidden name=AuthMethod value=FormsAuthentication>\n"
+        "<input name='Kmsi' value='true' checked>\n"
+        "<input value=\"no name\">\n"
+        "</form></body></html>");
+}
+
+class HtmlUtilTest : public testing::Test {
+protected:
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+};
+
+TEST_F(HtmlUtilTest, EscapeHtmlEntity) {
+    EXPECT_EQ("a+b=c", HtmlUtil::EscapeHtmlEntity("a&#x2b;b&#x3d;c"));
+    EXPECT_EQ("<\"'&>", HtmlUtil::EscapeHtmlEntity("&lt;&quot;&apos;&amp;&gt;"));
+    EXPECT_EQ("+=", HtmlUtil::EscapeHtmlEntity("&#X2B;&#61;"));
+    EXPECT_EQ("no entities", HtmlUtil::EscapeHtmlEntity("no entities"));
+    // Unknown entities and bare ampersands are kept as is
+    EXPECT_EQ("a&b;c", HtmlUtil::EscapeHtmlEntity("a&b;c"));
+    EXPECT_EQ("a&client-request-id=1", HtmlUtil::EscapeHtmlEntity("a&client-request-id=1"));
+    EXPECT_EQ("&amp&", HtmlUtil::EscapeHtmlEntity("&amp&"));
+    EXPECT_EQ("&#;&#x;&#x110;", HtmlUtil::EscapeHtmlEntity("&#;&#x;&#x110;"));
+    EXPECT_EQ("", HtmlUtil::EscapeHtmlEntity(""));
+}
+
+TEST_F(HtmlUtilTest, TagReader) {
+    std::istringstream html("text <A Href=\"x&amp;y\" data-flag disabled>link</a> < 3 <br/><img src=i.png alt='a \"b\"'/><?xml?><p");
+    HtmlTagReader reader(html);
+    std::string value;
+
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ("a", reader.GetName());
+    EXPECT_TRUE(reader.GetAttribute("HREF", value));
+    EXPECT_EQ("x&y", value);
+    EXPECT_TRUE(reader.GetAttribute("data-flag", value));
+    EXPECT_EQ("", value);
+    EXPECT_FALSE(reader.GetAttribute("title", value));
+
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ("br", reader.GetName());
+
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ("img", reader.GetName());
+    EXPECT_TRUE(reader.GetAttribute("src", value));
+    EXPECT_EQ("i.png", value);
+    EXPECT_TRUE(reader.GetAttribute("alt", value));
+    EXPECT_EQ("a \"b\"", value);
+
+    // Cut off by the end of the document
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ("p", reader.GetName());
+    EXPECT_FALSE(reader.Next());
+}
+
+TEST_F(HtmlUtilTest, ExtractForm) {
+    std::istringstream html(sign_on_page);
+    std::string action;
+    std::vector<std::pair<std::string, std::string>> inputs;
+    EXPECT_TRUE(HtmlUtil::ExtractForm(html, action, inputs));
+    EXPECT_EQ("/adfs/ls/IdpInitiatedSignOn.aspx?loginToRp=urn:amazon:webservices&client-request-id=1234", action);
+
+    std::vector<std::pair<std::string, std::string>> expected_inputs = {
+        {"UserName", ""},
+        {"Password", ""},
+        {"AuthMethod", "FormsAuthentication"},
+        {"Kmsi", "true"}
+    };
+    EXPECT_EQ(expected_inputs, inputs);
+}
+
+TEST_F(HtmlUtilTest, ExtractForm_NoAction) {
+    std::istringstream html("<form method=\"post\"><input name=\"a\" value=\"b\"></form>");
+    std::string action;
+    std::vector<std::pair<std::string, std::string>> inputs;
+    EXPECT_FALSE(HtmlUtil::ExtractForm(html, action, inputs));
+}
+
+TEST_F(HtmlUtilTest, ExtractForm_UnterminatedInput) {
+    std::istringstream html("<form action=\"/adfs/ls\"><input id=\"userNameInput\" name=\"UserName\" type=\"email\" value=\"\" tabindex=\"1\"");
+    std::string action;
+    std::vector<std::pair<std::string, std::string>> inputs;
+    EXPECT_TRUE(HtmlUtil::ExtractForm(html, action, inputs));
+    EXPECT_EQ("/adfs/ls", action);
+    ASSERT_EQ(1, inputs.size());
+    EXPECT_EQ("UserName", inputs[0].first);
+}
+
+TEST_F(HtmlUtilTest, ExtractInputValue) {
+    std::istringstream html(
+        "<form><input type=\"hidden\" name=\"RelayState\" value=\"state\" />"
+        "<input type=\"hidden\" name=\"SAMLResponse\" value=\"PHNhbWw&#x2b;&#x3d;\" />"
+        "<input type=\"hidden\" name=\"SAMLResponse\" value=\"second\" /></form>");
+    std::string value;
+    EXPECT_TRUE(HtmlUtil::ExtractInputValue(html, "SAMLResponse", value));
+    EXPECT_EQ("PHNhbWw+=", value);
+
+    // Stops right after the input
+    std::string rest(std::istreambuf_iterator<char>(html.rdbuf()), {});
+    EXPECT_EQ("<input type=\"hidden\" name=\"SAMLResponse\" value=\"second\" /></form>", rest);
+}
+
+TEST_F(HtmlUtilTest, ExtractInputValue_Missing) {
+    std::string value;
+    std::istringstream no_input("<form><input name=\"samlresponse\" value=\"x\"></form>");
+    EXPECT_FALSE(HtmlUtil::ExtractInputValue(no_input, "SAMLResponse", value));
+
+    std::istringstream empty_value("<input name=\"SAMLResponse\" value=\"\">");
+    EXPECT_FALSE(HtmlUtil::ExtractInputValue(empty_value, "SAMLResponse", value));
+}
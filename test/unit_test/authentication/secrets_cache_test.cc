@@ -0,0 +1,203 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "secrets_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+    const std::string secret_id("secret_ID");
+    const std::string region("us-east-2");
+    const SecretsCache::Secret secret_v1{ "test-user", "test-password" };
+    const SecretsCache::Secret secret_v2{ "test-user", "rotated-password" };
+
+    // Polls until the condition holds, refreshes run on the scheduler independently of the test
+    template <typename Condition>
+    bool wait_for(Condition condition, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+}
+
+class SecretsCacheTest : public testing::Test {
+protected:
+    std::atomic<int> fetch_count{ 0 };
+    // Returned by the fetcher, swapped by tests to simulate a rotation
+    SecretsCache::Secret current_secret = secret_v1;
+    std::mutex current_secret_mutex;
+    bool fail_fetch = false;
+    std::chrono::milliseconds fetch_delay{ 0 };
+    SecretsCache::Secret secret;
+
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+    // Runs per test case
+    void SetUp() override {}
+    void TearDown() override {}
+
+    SecretsCache::Fetcher fetcher() {
+        return [this](const std::string& id, const std::string& fetch_region, SecretsCache::Secret& fetched) {
+            fetch_count++;
+            std::this_thread::sleep_for(fetch_delay);
+            std::lock_guard<std::mutex> lock(current_secret_mutex);
+            fetched = current_secret;
+            fetched.username += fetch_region == region ? "" : "@" + fetch_region;
+            return !fail_fetch;
+        };
+    }
+
+    void rotate(const SecretsCache::Secret& rotated) {
+        std::lock_guard<std::mutex> lock(current_secret_mutex);
+        current_secret = rotated;
+    }
+};
+
+TEST_F(SecretsCacheTest, CachesSecret) {
+    SecretsCache cache(fetcher());
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(cache.Get(secret_id, region, secret));
+        EXPECT_EQ(secret_v1, secret);
+    }
+    EXPECT_EQ(1, fetch_count);
+
+    // Keyed by region as well
+    EXPECT_TRUE(cache.Get(secret_id, "us-west-2", secret));
+    EXPECT_EQ("test-user@us-west-2", secret.username);
+    EXPECT_EQ(2, fetch_count);
+    EXPECT_EQ(2, cache.Size());
+}
+
+TEST_F(SecretsCacheTest, ConcurrentMissesShareFetch) {
+    fetch_delay = std::chrono::milliseconds(200);
+    SecretsCache cache(fetcher());
+
+    std::atomic<int> successes{ 0 };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 16; i++) {
+        threads.emplace_back([&cache, &successes] {
+            SecretsCache::Secret read;
+            if (cache.Get(secret_id, region, read) && read == secret_v1) {
+                successes++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(16, successes);
+    EXPECT_EQ(1, fetch_count);
+}
+
+TEST_F(SecretsCacheTest, FailedFetchNotCached) {
+    fail_fetch = true;
+    SecretsCache cache(fetcher());
+    EXPECT_FALSE(cache.Get(secret_id, region, secret));
+
+    fail_fetch = false;
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_EQ(secret_v1, secret);
+    EXPECT_EQ(2, fetch_count);
+}
+
+TEST_F(SecretsCacheTest, ZeroTtlDisablesCaching) {
+    SecretsCache cache(fetcher(), std::chrono::seconds(0));
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_EQ(2, fetch_count);
+
+    cache.SetTtl(std::chrono::seconds(600));
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_EQ(3, fetch_count);
+}
+
+TEST_F(SecretsCacheTest, RefreshAfterRotation) {
+    SecretsCache cache(fetcher());
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    rotate(secret_v2);
+
+    // Cached until a connection reports the secret as rejected
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_EQ(secret_v1, secret);
+
+    EXPECT_TRUE(cache.Refresh(secret_id, region, secret_v1, secret));
+    EXPECT_EQ(secret_v2, secret);
+    EXPECT_EQ(2, fetch_count);
+
+    // Other connections that were rejected with the old secret get the new one without fetching it again
+    EXPECT_TRUE(cache.Refresh(secret_id, region, secret_v1, secret));
+    EXPECT_EQ(secret_v2, secret);
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_EQ(secret_v2, secret);
+    EXPECT_EQ(2, fetch_count);
+}
+
+TEST_F(SecretsCacheTest, RefreshRateLimited) {
+    SecretsCache cache(fetcher());
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+
+    // The secret did not change, fetching it again right away would not help
+    EXPECT_TRUE(cache.Refresh(secret_id, region, secret_v1, secret));
+    EXPECT_TRUE(cache.Refresh(secret_id, region, secret_v1, secret));
+    EXPECT_TRUE(cache.Refresh(secret_id, region, secret_v1, secret));
+    EXPECT_EQ(secret_v1, secret);
+    EXPECT_EQ(2, fetch_count);
+}
+
+TEST_F(SecretsCacheTest, RefreshFetchesUncachedSecret) {
+    SecretsCache cache(fetcher());
+    EXPECT_TRUE(cache.Refresh(secret_id, region, secret_v2, secret));
+    EXPECT_EQ(secret_v1, secret);
+    EXPECT_EQ(1, fetch_count);
+}
+
+TEST_F(SecretsCacheTest, BackgroundRefresh) {
+    SecretsCache cache(fetcher(), std::chrono::seconds(1));
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    rotate(secret_v2);
+
+    // Read, so it is fetched again after 75% of the TTL
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_TRUE(wait_for([this] { return fetch_count == 2; }));
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_EQ(secret_v2, secret);
+    EXPECT_TRUE(wait_for([this] { return fetch_count == 3; }));
+
+    // Unused since, left to expire
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    EXPECT_EQ(3, fetch_count);
+}
+
+TEST_F(SecretsCacheTest, Clear) {
+    SecretsCache cache(fetcher());
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    cache.Clear();
+    EXPECT_EQ(0, cache.Size());
+    EXPECT_TRUE(cache.Get(secret_id, region, secret));
+    EXPECT_EQ(2, fetch_count);
+}
@@ -0,0 +1,188 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "token_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+    const std::string key_a("host-a-us-east-1-5432-user");
+    const std::string key_b("host-b-us-east-1-5432-user");
+    const std::string key_c("host-c-us-east-1-5432-user");
+    const std::string token_a("token_a");
+    const std::string token_b("token_b");
+    const std::string token_c("token_c");
+    const std::chrono::seconds ttl_long(600);
+    const std::chrono::seconds ttl_short(2);
+
+    // Polls until the condition holds, refreshes run on the scheduler independently of the test
+    template <typename Condition>
+    bool wait_for(Condition condition, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+}
+
+class TokenCacheTest : public testing::Test {
+protected:
+    std::string token;
+
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+    // Runs per test case
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TokenCacheTest, PutGet) {
+    TokenCache cache;
+    cache.Put(key_a, token_a, ttl_long);
+
+    EXPECT_TRUE(cache.Get(key_a, token));
+    EXPECT_EQ(token_a, token);
+    EXPECT_FALSE(cache.Get(key_b, token));
+
+    TokenCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(1, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+}
+
+TEST_F(TokenCacheTest, Expired) {
+    TokenCache cache;
+    cache.Put(key_a, token_a, std::chrono::seconds(-1));
+    EXPECT_FALSE(cache.Get(key_a, token));
+}
+
+TEST_F(TokenCacheTest, LruEviction) {
+    TokenCache cache(2, TokenCache::DEFAULT_REFRESH_PERCENT);
+    cache.Put(key_a, token_a, ttl_long);
+    cache.Put(key_b, token_b, ttl_long);
+
+    // Reading key_a makes key_b the least recently used
+    EXPECT_TRUE(cache.Get(key_a, token));
+    cache.Put(key_c, token_c, ttl_long);
+
+    EXPECT_EQ(2, cache.Size());
+    EXPECT_TRUE(cache.Get(key_a, token));
+    EXPECT_FALSE(cache.Get(key_b, token));
+    EXPECT_TRUE(cache.Get(key_c, token));
+    EXPECT_EQ(1, cache.GetStats().evictions);
+}
+
+TEST_F(TokenCacheTest, ConfigureShrinks) {
+    TokenCache cache;
+    cache.Put(key_a, token_a, ttl_long);
+    cache.Put(key_b, token_b, ttl_long);
+    cache.Put(key_c, token_c, ttl_long);
+
+    cache.Configure(1, TokenCache::DEFAULT_REFRESH_PERCENT);
+    EXPECT_EQ(1, cache.Size());
+    EXPECT_TRUE(cache.Get(key_c, token));
+}
+
+TEST_F(TokenCacheTest, PlaceholderMisses) {
+    TokenCache cache;
+    cache.SetGenerator(key_a, [](std::string& generated) {
+        generated = token_b;
+        return true;
+    });
+    EXPECT_FALSE(cache.Get(key_a, token));
+}
+
+TEST_F(TokenCacheTest, RefreshUsedToken) {
+    TokenCache cache(TokenCache::DEFAULT_MAX_SIZE, 50);
+    std::atomic<int> generated_count{ 0 };
+    cache.SetGenerator(key_a, [&generated_count](std::string& generated) {
+        generated = token_b;
+        generated_count++;
+        return true;
+    });
+    cache.Put(key_a, token_a, ttl_short);
+    EXPECT_TRUE(cache.Get(key_a, token));
+    EXPECT_EQ(token_a, token);
+
+    // Refreshed half way through the TTL, before the cached token expires
+    EXPECT_TRUE(wait_for([&cache] { return cache.GetStats().refreshes > 0; }));
+    EXPECT_TRUE(cache.Get(key_a, token));
+    EXPECT_EQ(token_b, token);
+    EXPECT_EQ(1, generated_count);
+}
+
+TEST_F(TokenCacheTest, UnusedTokenNotRefreshed) {
+    TokenCache cache(TokenCache::DEFAULT_MAX_SIZE, 1);
+    std::atomic<int> generated_count{ 0 };
+    cache.SetGenerator(key_a, [&generated_count](std::string& generated) {
+        generated = token_b;
+        generated_count++;
+        return true;
+    });
+    cache.Put(key_a, token_a, ttl_short);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(0, generated_count);
+    EXPECT_EQ(0, cache.GetStats().refreshes);
+}
+
+TEST_F(TokenCacheTest, RefreshFailureKeepsToken) {
+    TokenCache cache(TokenCache::DEFAULT_MAX_SIZE, 1);
+    cache.SetGenerator(key_a, [](std::string& generated) {
+        return false;
+    });
+    cache.Put(key_a, token_a, ttl_short);
+    EXPECT_TRUE(cache.Get(key_a, token));
+
+    // The retry would be past the expiry, so the cached token is kept until it expires
+    EXPECT_TRUE(wait_for([&cache] { return cache.GetStats().refresh_failures > 0; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(1, cache.GetStats().refresh_failures);
+    EXPECT_TRUE(cache.Get(key_a, token));
+    EXPECT_EQ(token_a, token);
+}
+
+TEST_F(TokenCacheTest, ConcurrentAccess) {
+    TokenCache cache(8, TokenCache::DEFAULT_REFRESH_PERCENT);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&cache, t] {
+            std::string value;
+            for (int i = 0; i < 1000; i++) {
+                std::string key = "key-" + std::to_string((t * 7 + i) % 16);
+                if (!cache.Get(key, value)) {
+                    cache.Put(key, key, ttl_long);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    TokenCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(8000, stats.hits + stats.misses);
+    EXPECT_LE(cache.Size(), 8);
+}
@@ -16,6 +16,8 @@
 
 #include <gtest/gtest.h>
 
+#include <future>
+
 #include "../mock_objects.h"
 #include "string_helper.h"
 
@@ -189,3 +191,138 @@ TEST_F(ClusterTopologyMonitorTest, run_panic_with_cached_hosts) {
     // Check that topology did not increase in size or decrease
     EXPECT_EQ(1, topology_map->Size());
 }
+
+TEST_F(ClusterTopologyMonitorTest, force_refresh_wakes_on_topology_update) {
+    std::vector<HostInfo> topology;
+    topology.push_back(HostInfo("writer.server.com", 1234, UP, true, nullptr));
+    topology.push_back(HostInfo("reader_a.server.com", 1234, UP, false, nullptr));
+
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(testing::_, testing::_, testing::_))
+        .Times(testing::AtLeast(0));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckResult(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_query_helper, QueryTopology(testing::_))
+        .WillRepeatedly(Return(topology));
+
+    // Monitor is not started, the topology is only published by the second refresh below
+    monitor = std::make_shared<ClusterTopologyMonitor>(
+        cluster_id,
+        topology_map,
+        conn_str,
+        mock_odbc_helper,
+        mock_query_helper,
+        ignore_topology_request_ns,
+        high_refresh_rate_ns,
+        refresh_rate_ns
+    );
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::future<std::vector<HostInfo>> waiter = std::async(std::launch::async, [this] {
+        return monitor->ForceRefresh(true, std::chrono::milliseconds(std::chrono::seconds(sleep_duration_sec)).count());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(high_refresh_rate_ns));
+    monitor->ForceRefresh(reinterpret_cast<SQLHDBC>(1), 0);
+
+    std::vector<HostInfo> hosts = waiter.get();
+    EXPECT_EQ(topology.size(), hosts.size());
+    // Waiter is notified on publish instead of polling until the timeout
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(sleep_duration_sec));
+}
+
+TEST_F(ClusterTopologyMonitorTest, topology_snapshot_published_on_update) {
+    std::vector<HostInfo> cached_topology;
+    cached_topology.push_back(HostInfo("writer.server.com", 1234, UP, true, nullptr));
+    topology_map->Put(cluster_id, cached_topology);
+
+    std::vector<HostInfo> topology;
+    topology.push_back(HostInfo("writer.server.com", 1234, UP, true, nullptr));
+    topology.push_back(HostInfo("reader_a.server.com", 1234, UP, false, nullptr));
+
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(testing::_, testing::_, testing::_))
+        .Times(testing::AtLeast(0));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckResult(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_query_helper, QueryTopology(testing::_))
+        .WillRepeatedly(Return(topology));
+
+    monitor = std::make_shared<ClusterTopologyMonitor>(
+        cluster_id,
+        topology_map,
+        conn_str,
+        mock_odbc_helper,
+        mock_query_helper,
+        ignore_topology_request_ns,
+        high_refresh_rate_ns,
+        refresh_rate_ns
+    );
+
+    // Initial snapshot is seeded from the shared cache
+    std::shared_ptr<const TopologySnapshot> initial = monitor->GetTopologySnapshot();
+    EXPECT_EQ(0, initial->generation);
+    EXPECT_EQ(cached_topology, initial->hosts);
+
+    monitor->ForceRefresh(reinterpret_cast<SQLHDBC>(1), 0);
+
+    // Update publishes a new snapshot and leaves the previous one untouched
+    std::shared_ptr<const TopologySnapshot> updated = monitor->GetTopologySnapshot();
+    EXPECT_NE(initial, updated);
+    EXPECT_EQ(1, updated->generation);
+    EXPECT_EQ(topology, updated->hosts);
+    EXPECT_EQ(cached_topology, initial->hosts);
+    EXPECT_EQ(topology, topology_map->Get(cluster_id));
+}
+
+TEST_F(ClusterTopologyMonitorTest, topology_change_notifies_listeners) {
+    std::vector<HostInfo> cached_topology;
+    cached_topology.push_back(HostInfo("writer.server.com", 1234, UP, true, nullptr));
+    cached_topology.push_back(HostInfo("reader_a.server.com", 1234, UP, false, nullptr));
+    topology_map->Put(cluster_id, cached_topology);
+
+    std::vector<HostInfo> failed_over_topology;
+    failed_over_topology.push_back(HostInfo("writer.server.com", 1234, UP, false, nullptr));
+    failed_over_topology.push_back(HostInfo("reader_a.server.com", 1234, UP, true, nullptr));
+
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(testing::_, testing::_, testing::_))
+        .Times(testing::AtLeast(0));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckResult(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_query_helper, QueryTopology(testing::_))
+        .WillOnce(Return(failed_over_topology))
+        .WillRepeatedly(Return(cached_topology));
+
+    monitor = std::make_shared<ClusterTopologyMonitor>(
+        cluster_id,
+        topology_map,
+        conn_str,
+        mock_odbc_helper,
+        mock_query_helper,
+        ignore_topology_request_ns,
+        high_refresh_rate_ns,
+        refresh_rate_ns
+    );
+
+    int notifications = 0;
+    std::vector<TopologyEvent> events;
+    uint64_t subscription_id = monitor->Subscribe(
+        [&notifications, &events](const std::shared_ptr<const TopologySnapshot>& topology, const std::vector<TopologyEvent>& changes) {
+            notifications++;
+            events = changes;
+        });
+
+    monitor->ForceRefresh(reinterpret_cast<SQLHDBC>(1), 0);
+    EXPECT_EQ(1, notifications);
+    ASSERT_EQ(1, events.size());
+    EXPECT_EQ(WRITER_CHANGED, events[0].type);
+    EXPECT_EQ("reader_a.server.com", events[0].host.GetHost());
+
+    // No notifications after unsubscribing
+    monitor->Unsubscribe(subscription_id);
+    monitor->ForceRefresh(reinterpret_cast<SQLHDBC>(1), 0);
+    EXPECT_EQ(1, notifications);
+}
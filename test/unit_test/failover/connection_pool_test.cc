@@ -0,0 +1,275 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <thread>
+
+#include "../host_selector/random_host_selector.h"
+#include "../mock_objects.h"
+#include "../util/connection_string_keys.h"
+
+using ::testing::_;
+using ::testing::Return;
+
+namespace {
+    const std::string cluster_id = "clusterId";
+    const std::string host_a = "instance-a.XYZ.us-east-2.rds.amazonaws.com";
+    const std::string host_b = "instance-b.XYZ.us-east-2.rds.amazonaws.com";
+    const int port = 5432;
+}
+
+class ConnectionPoolTest : public testing::Test {
+protected:
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+    // Runs per test case
+    void SetUp() override {
+        // Mock ODBC for Cluster Monitor
+        mock_odbc_helper_monitor = std::make_shared<MOCK_ODBC_HELPER>();
+        EXPECT_CALL(*mock_odbc_helper_monitor, CheckResult(_, _, _, _)).WillRepeatedly(Return(true));
+        EXPECT_CALL(*mock_odbc_helper_monitor, Cleanup(_, _, _)).Times(1);
+        mock_topology_monitor = std::make_shared<MOCK_TOPOLOGY_MONITOR>(mock_odbc_helper_monitor);
+        EXPECT_CALL(*mock_topology_monitor, GetTopologySnapshot()).WillRepeatedly([this] { return snapshot; });
+
+        // Mock ODBC for Connection Pool, every allocated handle is unique
+        mock_odbc_helper = std::make_shared<MOCK_ODBC_HELPER>();
+        EXPECT_CALL(*mock_odbc_helper, AllocateHandle(_, _, _, _))
+            .WillRepeatedly([this](SQLSMALLINT, SQLHANDLE, SQLHANDLE& output_handle, const std::string&) {
+                output_handle = reinterpret_cast<SQLHANDLE>(++allocated_handles);
+                return true;
+            });
+        EXPECT_CALL(*mock_odbc_helper, Cleanup(_, _, _)).WillRepeatedly(Return());
+
+        conn_info[SERVER_HOST_KEY] = TEXT("database-pg-name.cluster-XYZ.us-east-2.rds.amazonaws.com");
+        snapshot = std::make_shared<const TopologySnapshot>(1, std::vector<HostInfo>{
+            HostInfo(host_a, port, UP, true, nullptr, 1),
+            HostInfo(host_b, port, UP, false, nullptr, 1)
+        });
+    }
+    void TearDown() override {}
+
+    std::shared_ptr<ConnectionPool> create_pool(uint32_t idle_ttl_sec, uint32_t max_idle) {
+        return std::make_shared<ConnectionPool>(cluster_id, conn_info, mock_topology_monitor,
+            std::make_shared<RandomHostSelector>(), mock_odbc_helper, idle_ttl_sec, max_idle);
+    }
+
+    uintptr_t allocated_handles = 0;
+    std::map<SQLSTR, SQLSTR> conn_info;
+    std::shared_ptr<const TopologySnapshot> snapshot;
+    std::shared_ptr<MOCK_TOPOLOGY_MONITOR> mock_topology_monitor;
+    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper_monitor;
+    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper;
+};
+
+TEST_F(ConnectionPoolTest, acquire_reuses_released_connection) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(1).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).Times(1).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    EXPECT_NE(nullptr, hdbc);
+    pool->Release(hdbc);
+    EXPECT_EQ(1, pool->IdleSize());
+
+    EXPECT_EQ(hdbc, pool->Acquire(SQL_NULL_HENV, true));
+    EXPECT_EQ(0, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, acquire_keeps_roles_apart) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC writer_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    pool->Release(writer_hdbc);
+
+    SQLHDBC reader_hdbc = pool->Acquire(SQL_NULL_HENV, false);
+    EXPECT_NE(nullptr, reader_hdbc);
+    EXPECT_NE(writer_hdbc, reader_hdbc);
+    EXPECT_EQ(1, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, acquire_keeps_environments_apart) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+    SQLHENV other_henv = reinterpret_cast<SQLHENV>(0x1);
+
+    SQLHDBC hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    pool->Release(hdbc);
+
+    SQLHDBC other_hdbc = pool->Acquire(other_henv, true);
+    EXPECT_NE(nullptr, other_hdbc);
+    EXPECT_NE(hdbc, other_hdbc);
+    EXPECT_EQ(1, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, acquire_drops_stale_connection) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillOnce(Return(false));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    pool->Release(hdbc);
+
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, hdbc, _)).Times(1);
+    SQLHDBC new_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    EXPECT_NE(nullptr, new_hdbc);
+    EXPECT_NE(hdbc, new_hdbc);
+}
+
+TEST_F(ConnectionPoolTest, idle_connections_expire) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).Times(0);
+    std::shared_ptr<ConnectionPool> pool = create_pool(0, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    pool->Release(pool->Acquire(SQL_NULL_HENV, true));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    EXPECT_NE(nullptr, pool->Acquire(SQL_NULL_HENV, true));
+    EXPECT_EQ(0, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, release_respects_max_idle) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, 1);
+
+    SQLHDBC first_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    SQLHDBC second_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    pool->Release(first_hdbc);
+
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, second_hdbc, _)).Times(1);
+    pool->Release(second_hdbc);
+    EXPECT_EQ(1, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, topology_change_drains_demoted_writer) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC old_writer_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    pool->Release(old_writer_hdbc);
+    EXPECT_EQ(1, pool->IdleSize());
+
+    snapshot = std::make_shared<const TopologySnapshot>(2, std::vector<HostInfo>{
+        HostInfo(host_a, port, UP, false, nullptr, 1),
+        HostInfo(host_b, port, UP, true, nullptr, 1)
+    });
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, old_writer_hdbc, _)).Times(1);
+    SQLHDBC new_writer_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    EXPECT_NE(old_writer_hdbc, new_writer_hdbc);
+    EXPECT_EQ(0, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, release_drops_connection_to_removed_host) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(1).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC hdbc = pool->Acquire(SQL_NULL_HENV, false);
+    snapshot = std::make_shared<const TopologySnapshot>(2, std::vector<HostInfo>{
+        HostInfo(host_a, port, UP, true, nullptr, 1)
+    });
+
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, hdbc, _)).Times(1);
+    pool->Release(hdbc);
+    EXPECT_EQ(0, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, release_unknown_connection) {
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+    SQLHDBC hdbc = reinterpret_cast<SQLHDBC>(0xFF);
+
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, hdbc, _)).Times(1);
+    pool->Release(hdbc);
+    EXPECT_EQ(0, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, drain_host) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC writer_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    SQLHDBC reader_hdbc = pool->Acquire(SQL_NULL_HENV, false);
+    pool->Release(writer_hdbc);
+    pool->Release(reader_hdbc);
+    EXPECT_EQ(2, pool->IdleSize());
+
+    pool->Drain(host_b);
+    EXPECT_EQ(1, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, topology_change_drains_idle_connections) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC writer_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    SQLHDBC reader_hdbc = pool->Acquire(SQL_NULL_HENV, false);
+    pool->Release(writer_hdbc);
+    pool->Release(reader_hdbc);
+
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillRepeatedly(Return(true));
+    std::promise<std::thread::id> drained;
+    std::future<std::thread::id> drained_future = drained.get_future();
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, reader_hdbc, _)).WillOnce([&drained](SQLHENV, SQLHDBC, SQLHSTMT) {
+        drained.set_value(std::this_thread::get_id());
+    });
+    pool->OnTopologyChange(std::make_shared<const TopologySnapshot>(2, std::vector<HostInfo>{
+        HostInfo(host_a, port, UP, true, nullptr, 1)
+    }));
+    // Drained right away by the pool, without waiting for the next Acquire or Release
+    ASSERT_EQ(std::future_status::ready, drained_future.wait_for(std::chrono::seconds(5)));
+    // Nothing is disconnected on the publishing thread
+    EXPECT_NE(std::this_thread::get_id(), drained_future.get());
+    EXPECT_EQ(1, pool->IdleSize());
+
+    EXPECT_EQ(writer_hdbc, pool->Acquire(SQL_NULL_HENV, true));
+    EXPECT_EQ(0, pool->IdleSize());
+
+    // Older snapshots are ignored
+    pool->OnTopologyChange(std::make_shared<const TopologySnapshot>(1, std::vector<HostInfo>{}));
+    pool->Release(writer_hdbc);
+    EXPECT_EQ(1, pool->IdleSize());
+}
+
+TEST_F(ConnectionPoolTest, writer_change_replaces_idle_writer_connection) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillRepeatedly(Return(true));
+    std::shared_ptr<ConnectionPool> pool = create_pool(ConnectionPool::DEFAULT_IDLE_TTL_SEC, ConnectionPool::DEFAULT_MAX_IDLE_PER_HOST);
+
+    SQLHDBC old_writer_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    pool->Release(old_writer_hdbc);
+
+    std::promise<void> drained;
+    std::future<void> drained_future = drained.get_future();
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, old_writer_hdbc, _)).WillOnce([&drained](SQLHENV, SQLHDBC, SQLHSTMT) {
+        drained.set_value();
+    });
+    snapshot = std::make_shared<const TopologySnapshot>(2, std::vector<HostInfo>{
+        HostInfo(host_a, port, UP, false, nullptr, 1),
+        HostInfo(host_b, port, UP, true, nullptr, 1)
+    });
+    pool->OnTopologyChange(snapshot);
+    ASSERT_EQ(std::future_status::ready, drained_future.wait_for(std::chrono::seconds(5)));
+
+    // Connected to the new writer in the background, Acquire does not connect again
+    for (int i = 0; i < 500 && pool->IdleSize() == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    SQLHDBC new_writer_hdbc = pool->Acquire(SQL_NULL_HENV, true);
+    EXPECT_NE(nullptr, new_writer_hdbc);
+    EXPECT_NE(old_writer_hdbc, new_writer_hdbc);
+}
@@ -16,6 +16,9 @@
 
 #include <gtest/gtest.h>
 
+#include <future>
+#include <thread>
+
 #include "../dialect/dialect_aurora_postgres.h"
 #include "../mock_objects.h"
 #include "../util/connection_string_helper.h"
@@ -263,6 +266,95 @@ TEST_F(FailoverServiceTest, failover_strict_writer_success) {
     EXPECT_EQ(failover_service->GetCurrentHost(), writer_host);
 }
 
+TEST_F(FailoverServiceTest, concurrent_writer_failovers_share_verification) {
+    conn_info_ptr->insert_or_assign(FAILOVER_MODE_KEY, FAILOVER_MODE_VALUE_STRICT_WRITER);
+
+    HostInfo writer_host(endpoint_prefix + "-writer", port, UP, true, nullptr, host_weight);
+    HostInfo reader_host(endpoint_prefix + "-reader", port, UP, false, nullptr, host_weight);
+    topology.push_back(writer_host);
+    topology.push_back(reader_host);
+    topology_map->Put(cluster_id, topology);
+
+    SQLHDBC joining_hdbc = hdbc;
+    std::future<FailoverStatus> joining_failover;
+    // Second failover arrives while the first one is still verifying the writer
+    EXPECT_CALL(*mock_topology_monitor, ForceRefresh(true, testing::_))
+        .Times(1)
+        .WillOnce([this, &joining_hdbc, &joining_failover](bool, uint32_t) {
+            joining_failover = std::async(std::launch::async, [this, &joining_hdbc] {
+                return failover_service->Failover(joining_hdbc, failover_sql_state);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            return topology;
+        });
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(testing::_, testing::_))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(testing::_))
+        .WillRepeatedly(Return(true));
+    // is_connected_to_reader()
+    EXPECT_CALL(*mock_odbc_helper, AllocateHandle(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, ExecuteQuery(testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, BindColumn(testing::_, testing::_, testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, FetchResults(testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+
+    failover_service = std::make_shared<FailoverService>(
+        server_host,
+        cluster_id,
+        driver_dialect,
+        conn_info_ptr,
+        topology_map,
+        mock_topology_monitor,
+        mock_odbc_helper
+    );
+    EXPECT_EQ(FAILOVER_SUCCEED, failover_service->Failover(hdbc, failover_sql_state));
+    EXPECT_EQ(FAILOVER_SUCCEED, joining_failover.get());
+    EXPECT_EQ(failover_service->GetCurrentHost(), writer_host);
+}
+
+TEST_F(FailoverServiceTest, failed_writer_verification_does_not_block_later_failovers) {
+    conn_info_ptr->insert_or_assign(FAILOVER_MODE_KEY, FAILOVER_MODE_VALUE_STRICT_WRITER);
+
+    HostInfo writer_host(endpoint_prefix + "-writer", port, UP, true, nullptr, host_weight);
+    topology.push_back(writer_host);
+    topology_map->Put(cluster_id, topology);
+
+    EXPECT_CALL(*mock_topology_monitor, ForceRefresh(true, testing::_))
+        .Times(2)
+        .WillOnce([](bool, uint32_t) -> std::vector<HostInfo> {
+            throw std::runtime_error("refresh failed");
+        })
+        .WillOnce(Return(topology));
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(testing::_))
+        .WillRepeatedly(Return(true));
+    // is_connected_to_reader()
+    EXPECT_CALL(*mock_odbc_helper, AllocateHandle(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, ExecuteQuery(testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, FetchResults(testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+
+    failover_service = std::make_shared<FailoverService>(
+        server_host,
+        cluster_id,
+        driver_dialect,
+        conn_info_ptr,
+        topology_map,
+        mock_topology_monitor,
+        mock_odbc_helper
+    );
+    EXPECT_THROW(failover_service->Failover(hdbc, failover_sql_state), std::runtime_error);
+    // The failed verification is completed, the next failover verifies again instead of waiting on it
+    EXPECT_EQ(FAILOVER_SUCCEED, failover_service->Failover(hdbc, failover_sql_state));
+}
+
 TEST_F(FailoverServiceTest, failover_fail_no_hosts) {
     topology.clear();
     topology_map->Put(cluster_id, topology);
@@ -342,3 +434,148 @@ TEST_F(FailoverServiceTest, failover_strict_writer_fail_no_writer) {
     EXPECT_EQ(failover_service->Failover(hdbc, failover_sql_state),
         FAILOVER_FAILED);
 }
+
+TEST_F(FailoverServiceTest, failover_reader_fanout_success) {
+    conn_info_ptr->insert_or_assign(FAILOVER_READER_FANOUT_KEY, TEXT("3"));
+
+    HostInfo writer_host(endpoint_prefix + "-writer", port, UP, true, nullptr, host_weight);
+    HostInfo reader_host_a(endpoint_prefix + "-reader-a", port, UP, false, nullptr, host_weight);
+    HostInfo reader_host_b(endpoint_prefix + "-reader-b", port, UP, false, nullptr, host_weight);
+    HostInfo reader_host_c(endpoint_prefix + "-reader-c", port, UP, false, nullptr, host_weight);
+    topology.push_back(writer_host);
+    topology.push_back(reader_host_a);
+    topology.push_back(reader_host_b);
+    topology.push_back(reader_host_c);
+    topology_map->Put(cluster_id, topology);
+
+    EXPECT_CALL(*mock_topology_monitor, ForceRefresh(false, testing::_))
+        .WillRepeatedly(Return(topology));
+    // Only the last reader is reachable, all readers are attempted at the same time
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(testing::_, testing::_))
+        .Times(3)
+        .WillRepeatedly([](SQLTCHAR* conn_cstr, SQLHDBC&) {
+            SQLSTR conn = reinterpret_cast<const SQLSTR::value_type*>(conn_cstr);
+            return conn.find(TEXT("reader-c")) != SQLSTR::npos;
+        });
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(testing::_, testing::_, testing::_))
+        .Times(testing::AtLeast(0));
+    // Racing environment, handles and is_connected_to_reader()
+    EXPECT_CALL(*mock_odbc_helper, AllocateHandle(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, SetHenvToOdbc3(testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, ExecuteQuery(testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, BindColumn(testing::_, testing::_, testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, FetchResults(testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+
+    failover_service = std::make_shared<FailoverService>(
+        server_host,
+        cluster_id,
+        driver_dialect,
+        conn_info_ptr,
+        topology_map,
+        mock_topology_monitor,
+        mock_odbc_helper
+    );
+
+    // Winning handle replaces the given one, keep the original for TearDown
+    SQLHDBC failover_hdbc = hdbc;
+    SQLHENV henv = reinterpret_cast<SQLHENV>(1);
+    EXPECT_EQ(failover_service->Failover(failover_hdbc, failover_sql_state, henv),
+        FAILOVER_SUCCEED);
+    EXPECT_EQ(failover_service->GetCurrentHost(), reader_host_c);
+}
+
+TEST_F(FailoverServiceTest, failover_reader_fanout_frees_losing_handles) {
+    conn_info_ptr->insert_or_assign(FAILOVER_READER_FANOUT_KEY, TEXT("3"));
+
+    HostInfo writer_host(endpoint_prefix + "-writer", port, UP, true, nullptr, host_weight);
+    HostInfo reader_host_a(endpoint_prefix + "-reader-a", port, UP, false, nullptr, host_weight);
+    HostInfo reader_host_b(endpoint_prefix + "-reader-b", port, UP, false, nullptr, host_weight);
+    HostInfo reader_host_c(endpoint_prefix + "-reader-c", port, UP, false, nullptr, host_weight);
+    topology.push_back(writer_host);
+    topology.push_back(reader_host_a);
+    topology.push_back(reader_host_b);
+    topology.push_back(reader_host_c);
+    topology_map->Put(cluster_id, topology);
+
+    EXPECT_CALL(*mock_topology_monitor, ForceRefresh(false, testing::_))
+        .WillRepeatedly(Return(topology));
+    // The losing readers are still connecting when the last reader wins
+    const std::chrono::milliseconds losing_connect_time(500);
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(testing::_, testing::_))
+        .Times(3)
+        .WillRepeatedly([losing_connect_time](SQLTCHAR* conn_cstr, SQLHDBC&) {
+            SQLSTR conn = reinterpret_cast<const SQLSTR::value_type*>(conn_cstr);
+            if (conn.find(TEXT("reader-c")) != SQLSTR::npos) {
+                return true;
+            }
+            std::this_thread::sleep_for(losing_connect_time);
+            return false;
+        });
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(testing::_))
+        .WillRepeatedly(Return(true));
+    const SQLHENV race_henv = reinterpret_cast<SQLHENV>(0x10);
+    std::shared_ptr<std::atomic<uintptr_t>> next_handle = std::make_shared<std::atomic<uintptr_t>>(0x100);
+    EXPECT_CALL(*mock_odbc_helper, AllocateHandle(testing::_, testing::_, testing::_, testing::_))
+        .WillRepeatedly([next_handle, race_henv](SQLSMALLINT type, SQLHANDLE, SQLHANDLE& handle, const std::string&) {
+            if (SQL_HANDLE_ENV == type) {
+                handle = race_henv;
+            } else if (SQL_HANDLE_DBC == type) {
+                handle = reinterpret_cast<SQLHANDLE>(next_handle->fetch_add(1));
+            }
+            return true;
+        });
+    EXPECT_CALL(*mock_odbc_helper, SetHenvToOdbc3(race_henv, testing::_))
+        .WillOnce(Return(true));
+    // Losing attempts outlive the test body, they only capture shared state
+    std::shared_ptr<std::atomic<int>> freed_handles = std::make_shared<std::atomic<int>>(0);
+    std::shared_ptr<std::atomic<bool>> race_henv_freed = std::make_shared<std::atomic<bool>>(false);
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(testing::_, testing::_, testing::_))
+        .WillRepeatedly([freed_handles, race_henv_freed, race_henv](SQLHENV henv, SQLHDBC hdbc, SQLHSTMT) {
+            if (SQL_NULL_HDBC != hdbc) {
+                (*freed_handles)++;
+            }
+            if (race_henv == henv) {
+                *race_henv_freed = true;
+            }
+        });
+    EXPECT_CALL(*mock_odbc_helper, ExecuteQuery(testing::_, testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, FetchResults(testing::_, testing::_))
+        .WillRepeatedly(Return(true));
+
+    failover_service = std::make_shared<FailoverService>(
+        server_host,
+        cluster_id,
+        driver_dialect,
+        conn_info_ptr,
+        topology_map,
+        mock_topology_monitor,
+        mock_odbc_helper
+    );
+
+    SQLHDBC failover_hdbc = hdbc;
+    SQLHENV henv = reinterpret_cast<SQLHENV>(1);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    EXPECT_EQ(failover_service->Failover(failover_hdbc, failover_sql_state, henv),
+        FAILOVER_SUCCEED);
+    // Returns with the first reader, without waiting for the losing attempts
+    EXPECT_LT(std::chrono::steady_clock::now() - start, losing_connect_time);
+    EXPECT_EQ(failover_service->GetCurrentHost(), reader_host_c);
+    EXPECT_EQ(1, freed_handles->load());
+
+    // The losing attempts free their own handles once they return, and the racing environment once the service is gone
+    failover_service = nullptr;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((freed_handles->load() < 3 || !race_henv_freed->load()) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(3, freed_handles->load());
+    EXPECT_TRUE(race_henv_freed->load());
+}
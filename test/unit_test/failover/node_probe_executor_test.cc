@@ -0,0 +1,102 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "node_probe_executor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace {
+    const std::chrono::seconds wait_timeout = std::chrono::seconds(5);
+}
+
+class NodeProbeExecutorTest : public testing::Test {
+  protected:
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+    // Runs per test case
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(NodeProbeExecutorTest, submit_runs_task) {
+    std::promise<void> ran;
+    std::future<void> ran_future = ran.get_future();
+
+    EXPECT_TRUE(NodeProbeExecutor::Submit([&ran] { ran.set_value(); }));
+    EXPECT_EQ(std::future_status::ready, ran_future.wait_for(wait_timeout));
+}
+
+TEST_F(NodeProbeExecutorTest, submit_after_runs_task_after_delay) {
+    std::promise<void> ran;
+    std::future<void> ran_future = ran.get_future();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    EXPECT_LT(0, NodeProbeExecutor::SubmitAfter([&ran] { ran.set_value(); }, std::chrono::milliseconds(50)));
+    EXPECT_EQ(std::future_status::ready, ran_future.wait_for(wait_timeout));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+}
+
+TEST_F(NodeProbeExecutorTest, cancel_waiting_task) {
+    std::atomic<bool> ran = false;
+    uint64_t task_id = NodeProbeExecutor::SubmitAfter([&ran] { ran = true; }, std::chrono::milliseconds(50));
+
+    EXPECT_TRUE(NodeProbeExecutor::Cancel(task_id));
+    EXPECT_FALSE(NodeProbeExecutor::Cancel(task_id));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(ran);
+}
+
+TEST_F(NodeProbeExecutorTest, acquire_bounded_by_max_probes) {
+    uint32_t max_probes = NodeProbeExecutor::GetMaxProbes();
+    uint32_t acquired = 0;
+    while (NodeProbeExecutor::TryAcquire()) {
+        acquired++;
+        ASSERT_LE(acquired, max_probes);
+    }
+    EXPECT_EQ(max_probes, NodeProbeExecutor::GetActiveProbes());
+    EXPECT_FALSE(NodeProbeExecutor::TryAcquire());
+
+    NodeProbeExecutor::Release();
+    EXPECT_TRUE(NodeProbeExecutor::TryAcquire());
+
+    for (uint32_t i = 0; i < max_probes; i++) {
+        NodeProbeExecutor::Release();
+    }
+    EXPECT_EQ(0, NodeProbeExecutor::GetActiveProbes());
+}
+
+TEST_F(NodeProbeExecutorTest, release_does_not_underflow) {
+    EXPECT_EQ(0, NodeProbeExecutor::GetActiveProbes());
+    NodeProbeExecutor::Release();
+    EXPECT_EQ(0, NodeProbeExecutor::GetActiveProbes());
+}
+
+TEST_F(NodeProbeExecutorTest, configure_only_grows) {
+    uint32_t pool_size = NodeProbeExecutor::GetPoolSize();
+    uint32_t max_probes = NodeProbeExecutor::GetMaxProbes();
+
+    NodeProbeExecutor::Configure(pool_size - 1, max_probes - 1);
+    EXPECT_EQ(pool_size, NodeProbeExecutor::GetPoolSize());
+    EXPECT_EQ(max_probes, NodeProbeExecutor::GetMaxProbes());
+
+    NodeProbeExecutor::Configure(pool_size + 1, max_probes + 1);
+    EXPECT_EQ(pool_size + 1, NodeProbeExecutor::GetPoolSize());
+    EXPECT_EQ(max_probes + 1, NodeProbeExecutor::GetMaxProbes());
+}
@@ -0,0 +1,247 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "standby_connection_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "../mock_objects.h"
+#include "../util/connection_string_keys.h"
+#include "../util/refresh_scheduler.h"
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Return;
+using ::testing::SetArgReferee;
+
+namespace {
+    const std::string cluster_id = "clusterId";
+    const std::string writer_host = "writer.XYZ.us-east-2.rds.amazonaws.com";
+    const std::string reader_host_a = "reader-a.XYZ.us-east-2.rds.amazonaws.com";
+    const std::string reader_host_b = "reader-b.XYZ.us-east-2.rds.amazonaws.com";
+    const std::string reader_host_c = "reader-c.XYZ.us-east-2.rds.amazonaws.com";
+    const int port = 5432;
+    // Any value other than SQL_NULL_HANDLE
+    SQLHANDLE dummy_handle = reinterpret_cast<SQLHANDLE>(0x1);
+}
+
+class StandbyConnectionPoolTest : public testing::Test {
+protected:
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+    // Runs per test case
+    void SetUp() override {
+        mock_odbc_helper = std::make_shared<MOCK_ODBC_HELPER>();
+        EXPECT_CALL(*mock_odbc_helper, AllocateHandle(_, _, _, _))
+            .WillRepeatedly(DoAll(SetArgReferee<2>(dummy_handle), Return(true)));
+        EXPECT_CALL(*mock_odbc_helper, SetHenvToOdbc3(_, _)).WillRepeatedly(Return(true));
+        EXPECT_CALL(*mock_odbc_helper, Cleanup(_, _, _)).WillRepeatedly(Return());
+
+        conn_info[SERVER_HOST_KEY] = TEXT("database-pg-name.cluster-XYZ.us-east-2.rds.amazonaws.com");
+        topology = {
+            HostInfo(writer_host, port, UP, true, nullptr, 1),
+            HostInfo(reader_host_a, port, UP, false, nullptr, 1),
+            HostInfo(reader_host_b, port, UP, false, nullptr, 5),
+            HostInfo(reader_host_c, port, DOWN, false, nullptr, 10)
+        };
+    }
+    void TearDown() override {}
+
+    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper;
+    std::map<SQLSTR, SQLSTR> conn_info;
+    std::vector<HostInfo> topology;
+};
+
+TEST_F(StandbyConnectionPoolTest, refresh_connects_writer_and_highest_weight_readers) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 2, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+
+    pool.Refresh(topology);
+    EXPECT_EQ(2, pool.Size());
+
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    EXPECT_TRUE(pool.Take(false, hdbc, host, references));
+    EXPECT_EQ(reader_host_b, host.GetHost());
+    EXPECT_TRUE(pool.Take(false, hdbc, host, references));
+    EXPECT_EQ(writer_host, host.GetHost());
+    EXPECT_FALSE(pool.Take(false, hdbc, host, references));
+}
+
+TEST_F(StandbyConnectionPoolTest, take_prefers_role) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).WillRepeatedly(Return(true));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 3, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+
+    pool.Refresh(topology);
+    EXPECT_EQ(3, pool.Size());
+
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    EXPECT_TRUE(pool.Take(true, hdbc, host, references));
+    EXPECT_EQ(writer_host, host.GetHost());
+    EXPECT_EQ(dummy_handle, hdbc);
+    // No writer left, falls back to a reader
+    EXPECT_TRUE(pool.Take(true, hdbc, host, references));
+    EXPECT_FALSE(host.IsHostWriter());
+    EXPECT_EQ(1, pool.Size());
+}
+
+TEST_F(StandbyConnectionPoolTest, refresh_skips_down_writer) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 3, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+
+    topology[0] = HostInfo(writer_host, port, DOWN, true, nullptr, 1);
+    pool.Refresh(topology);
+    EXPECT_EQ(2, pool.Size());
+
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    EXPECT_TRUE(pool.Take(true, hdbc, host, references));
+    EXPECT_FALSE(host.IsHostWriter());
+}
+
+TEST_F(StandbyConnectionPoolTest, refresh_keeps_live_connections) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).Times(2).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillRepeatedly(Return(true));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 2, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+
+    pool.Refresh(topology);
+    pool.Refresh(topology);
+    EXPECT_EQ(2, pool.Size());
+}
+
+TEST_F(StandbyConnectionPoolTest, refresh_drops_dead_connections) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _))
+        .WillOnce(Return(true))
+        .WillOnce(Return(true))
+        .WillRepeatedly(Return(false));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillRepeatedly(Return(false));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 2, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+
+    pool.Refresh(topology);
+    EXPECT_EQ(2, pool.Size());
+
+    pool.Refresh(topology);
+    EXPECT_EQ(0, pool.Size());
+}
+
+TEST_F(StandbyConnectionPoolTest, refresh_drops_removed_hosts) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillRepeatedly(Return(true));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 2, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+
+    pool.Refresh(topology);
+    pool.Refresh({ HostInfo(writer_host, port, UP, true, nullptr, 1) });
+    EXPECT_EQ(1, pool.Size());
+
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    EXPECT_TRUE(pool.Take(false, hdbc, host, references));
+    EXPECT_EQ(writer_host, host.GetHost());
+}
+
+TEST_F(StandbyConnectionPoolTest, take_during_refresh) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).WillRepeatedly(Return(true));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 2, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+    pool.Refresh(topology);
+
+    // Connections stay available while they are probed, except the one being probed
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    bool taken = false;
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillOnce([&](SQLHDBC) {
+        taken = pool.Take(true, hdbc, host, references);
+        return true;
+    });
+    pool.Refresh({ HostInfo(writer_host, port, UP, true, nullptr, 1), HostInfo(reader_host_b, port, UP, false, nullptr, 5) });
+    EXPECT_TRUE(taken);
+    EXPECT_EQ(reader_host_b, host.GetHost());
+}
+
+TEST_F(StandbyConnectionPoolTest, references_held_until_handed_over) {
+    std::vector<SQLSTR> conn_strs;
+    // The driver takes a service reference for each connection with failover enabled
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).WillRepeatedly([&conn_strs](SQLTCHAR* conn_str, SQLHDBC&) {
+        conn_strs.push_back(StringHelper::ToSQLSTR(conn_str));
+        EXPECT_FALSE(StandbyReferenceScope::Record("other-cluster", 1));
+        return StandbyReferenceScope::Record(cluster_id, 1);
+    });
+    int released = 0;
+    EXPECT_CALL(*mock_odbc_helper, Cleanup(_, _, _)).WillRepeatedly([&released](SQLHENV, SQLHDBC, SQLHSTMT) {
+        released += StandbyReferenceScope::Record(cluster_id, -1) ? 1 : 0;
+    });
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillRepeatedly(Return(true));
+    StandbyConnectionPool pool(cluster_id, conn_info, nullptr, mock_odbc_helper, dummy_handle, 2, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+
+    pool.Refresh(topology);
+    EXPECT_EQ(2, conn_strs.size());
+    // Standby connections keep failover enabled, they are handed over as failed over sessions
+    for (const SQLSTR& conn_str : conn_strs) {
+        EXPECT_NE(SQLSTR::npos, conn_str.find(SQLSTR(ENABLE_FAILOVER_KEY) + TEXT("=") + BOOL_TRUE));
+    }
+    EXPECT_FALSE(StandbyReferenceScope::Record(cluster_id, 1));
+
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    EXPECT_TRUE(pool.Take(true, hdbc, host, references));
+    EXPECT_EQ(1, references);
+
+    // Dropping the remaining connection releases its reference without counting it
+    pool.Refresh({});
+    EXPECT_EQ(1, released);
+}
+
+TEST_F(StandbyConnectionPoolTest, start_refreshes_on_scheduler) {
+    EXPECT_CALL(*mock_odbc_helper, ConnStrConnect(_, _)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper, CheckConnection(_)).WillRepeatedly(Return(true));
+    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper_monitor = std::make_shared<MOCK_ODBC_HELPER>();
+    EXPECT_CALL(*mock_odbc_helper_monitor, CheckResult(_, _, _, _)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mock_odbc_helper_monitor, Cleanup(_, _, _)).Times(1);
+    std::shared_ptr<MOCK_TOPOLOGY_MONITOR> mock_topology_monitor = std::make_shared<MOCK_TOPOLOGY_MONITOR>(mock_odbc_helper_monitor);
+    EXPECT_CALL(*mock_topology_monitor, GetTopologySnapshot())
+        .WillRepeatedly(Return(std::make_shared<const TopologySnapshot>(1, topology)));
+    StandbyConnectionPool pool(cluster_id, conn_info, mock_topology_monitor, mock_odbc_helper, dummy_handle, 2, StandbyConnectionPool::DEFAULT_REFRESH_RATE_MS);
+    size_t task_count = RefreshScheduler::GetTaskCount();
+
+    pool.Start();
+    EXPECT_EQ(task_count + 1, RefreshScheduler::GetTaskCount());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pool.Size() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(2, pool.Size());
+
+    // A handed over connection is replaced right away instead of at the next refresh
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    HostInfo host;
+    int references = 0;
+    EXPECT_TRUE(pool.Take(true, hdbc, host, references));
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pool.Size() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(2, pool.Size());
+
+    pool.Stop();
+    EXPECT_EQ(task_count, RefreshScheduler::GetTaskCount());
+}
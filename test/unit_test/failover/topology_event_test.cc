@@ -0,0 +1,90 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "topology_event.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+    const std::string writer_host = "writer.server.com";
+    const std::string reader_host_a = "reader_a.server.com";
+    const std::string reader_host_b = "reader_b.server.com";
+    const int port = 1234;
+}
+
+class TopologyEventTest : public testing::Test {
+protected:
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+    // Runs per test case
+    void SetUp() override {
+        topology = {
+            HostInfo(writer_host, port, UP, true, nullptr),
+            HostInfo(reader_host_a, port, UP, false, nullptr)
+        };
+    }
+    void TearDown() override {}
+
+    std::vector<HostInfo> topology;
+};
+
+TEST_F(TopologyEventTest, no_change) {
+    EXPECT_TRUE(TopologyEvent::Diff(topology, topology).empty());
+}
+
+TEST_F(TopologyEventTest, writer_changed) {
+    std::vector<HostInfo> current = {
+        HostInfo(writer_host, port, UP, false, nullptr),
+        HostInfo(reader_host_a, port, UP, true, nullptr)
+    };
+
+    std::vector<TopologyEvent> events = TopologyEvent::Diff(topology, current);
+    ASSERT_EQ(1, events.size());
+    EXPECT_EQ(WRITER_CHANGED, events[0].type);
+    EXPECT_EQ(reader_host_a, events[0].host.GetHost());
+}
+
+TEST_F(TopologyEventTest, host_added_and_removed) {
+    std::vector<HostInfo> current = {
+        HostInfo(writer_host, port, UP, true, nullptr),
+        HostInfo(reader_host_b, port, UP, false, nullptr)
+    };
+
+    std::vector<TopologyEvent> events = TopologyEvent::Diff(topology, current);
+    ASSERT_EQ(2, events.size());
+    EXPECT_EQ(HOST_ADDED, events[0].type);
+    EXPECT_EQ(reader_host_b, events[0].host.GetHost());
+    EXPECT_EQ(HOST_REMOVED, events[1].type);
+    EXPECT_EQ(reader_host_a, events[1].host.GetHost());
+}
+
+TEST_F(TopologyEventTest, weight_changed) {
+    std::vector<HostInfo> current = {
+        HostInfo(writer_host, port, UP, true, nullptr),
+        HostInfo(reader_host_a, port, UP, false, nullptr, 5)
+    };
+
+    std::vector<TopologyEvent> events = TopologyEvent::Diff(topology, current);
+    ASSERT_EQ(1, events.size());
+    EXPECT_EQ(WEIGHT_CHANGED, events[0].type);
+    EXPECT_EQ(reader_host_a, events[0].host.GetHost());
+}
+
+TEST_F(TopologyEventTest, initial_topology) {
+    std::vector<TopologyEvent> events = TopologyEvent::Diff({}, topology);
+    ASSERT_EQ(2, events.size());
+    EXPECT_EQ(HOST_ADDED, events[0].type);
+    EXPECT_EQ(HOST_ADDED, events[1].type);
+}
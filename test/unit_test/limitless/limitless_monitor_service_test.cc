@@ -14,6 +14,7 @@
 
 #include "limitless_monitor_service.h"
 
+#include <atomic>
 #include <cstdio>
 
 #include <gmock/gmock.h>
@@ -53,13 +54,15 @@ class LimitlessMonitorServiceTest : public testing::Test {
     static void TearDownTestSuite() {}
 
     // Runs per test case
-    void SetUp() override {}
+    void SetUp() override {
+        // round robin remembers the last router it handed out per cluster across services
+        RoundRobinHostSelector::ClearCache();
+    }
     void TearDown() override {}
 };
 
 TEST_F(LimitlessMonitorServiceTest, SingleMonitorTest) {
-    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper = std::make_shared<MOCK_ODBC_HELPER>();
-    EXPECT_CALL(*mock_odbc_helper, TestConnectionToServer(testing::_, testing::_)).Times(1).WillOnce(Return(true));
+    // routers are handed out from the monitor's last poll, without connecting to them first
     
     std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
     mock_monitor->test_limitless_routers.push_back(HostInfo("test_host1", 5432, UP, true, nullptr, 101)); // round robin should choose this one
@@ -69,7 +72,7 @@ TEST_F(LimitlessMonitorServiceTest, SingleMonitorTest) {
         .Times(1)
         .WillOnce(Invoke(mock_monitor.get(), &MOCK_LIMITLESS_ROUTER_MONITOR::MockOpen));
 
-    LimitlessMonitorService limitless_monitor_service(mock_odbc_helper);
+    LimitlessMonitorService limitless_monitor_service;
     std::string test_service_id = "";
 
     limitless_monitor_service.NewService(test_service_id, test_connection_string_lazy_c_str, test_host_port, mock_monitor);
@@ -92,11 +95,30 @@ TEST_F(LimitlessMonitorServiceTest, SingleMonitorTest) {
     EXPECT_FALSE(service_exists);
 }
 
-TEST_F(LimitlessMonitorServiceTest, MultipleMonitorTest) {
-    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper = std::make_shared<MOCK_ODBC_HELPER>();
-    EXPECT_CALL(*mock_odbc_helper, TestConnectionToServer(testing::_, "correct1")).Times(1).WillOnce(Return(true));
-    EXPECT_CALL(*mock_odbc_helper, TestConnectionToServer(testing::_, "correct2")).Times(1).WillOnce(Return(true));
+TEST_F(LimitlessMonitorServiceTest, MalformedRefreshPoolSizeIgnored) {
+    std::map<SQLSTR, SQLSTR> conn_str_map;
+    conn_str_map[SERVER_HOST_KEY] = TEXT("limitless.shardgrp-1234.us-east-2.rds.amazonaws.com");
+    conn_str_map[LIMITLESS_MONITOR_INTERVAL_MS_KEY] = StringHelper::ToSQLSTR(std::to_string(TEST_LIMITLESS_MONITOR_INTERVAL_MS));
+    conn_str_map[LIMITLESS_MODE_KEY] = LIMITLESS_MODE_VALUE_LAZY;
+    conn_str_map[REFRESH_POOL_SIZE_KEY] = TEXT("many");
+    SQLSTR conn_str = ConnectionStringHelper::BuildConnectionString(conn_str_map);
+
+    std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
+    EXPECT_CALL(*mock_monitor, Open(false, testing::_, test_host_port, TEST_LIMITLESS_MONITOR_INTERVAL_MS, testing::_, testing::_))
+        .Times(1)
+        .WillOnce(Invoke(mock_monitor.get(), &MOCK_LIMITLESS_ROUTER_MONITOR::MockOpen));
+
+    // the service starts with the pool size unchanged
+    LimitlessMonitorService limitless_monitor_service;
+    std::string test_service_id = "malformed_pool_size";
+    uint32_t pool_size = RefreshScheduler::GetPoolSize();
+    EXPECT_TRUE(limitless_monitor_service.NewService(test_service_id, AS_SQLTCHAR(conn_str.c_str()), test_host_port, mock_monitor));
+    EXPECT_EQ(pool_size, RefreshScheduler::GetPoolSize());
+
+    limitless_monitor_service.DecrementReferenceCounter(test_service_id);
+}
 
+TEST_F(LimitlessMonitorServiceTest, MultipleMonitorTest) {
     std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor1 = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
     mock_monitor1->test_limitless_routers.push_back(HostInfo("correct1", 5432, UP, true, nullptr, 100));
     std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor2 = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
@@ -113,7 +135,7 @@ TEST_F(LimitlessMonitorServiceTest, MultipleMonitorTest) {
     EXPECT_CALL(*mock_monitor3, Open(false, test_connection_string_lazy_c_str, test_host_port, TEST_LIMITLESS_MONITOR_INTERVAL_MS, testing::_, testing::_))
         .Times(1).WillOnce(Invoke(mock_monitor3.get(), &MOCK_LIMITLESS_ROUTER_MONITOR::MockOpen));
 
-    LimitlessMonitorService limitless_monitor_service(mock_odbc_helper);
+    LimitlessMonitorService limitless_monitor_service;
     std::string mock_monitor1_id = "";
     std::string mock_monitor2_id = "monitor2";
     std::string mock_monitor3_id = "monitor3";
@@ -172,8 +194,7 @@ TEST_F(LimitlessMonitorServiceTest, MultipleMonitorTest) {
 }
 
 TEST_F(LimitlessMonitorServiceTest, ImmediateMonitorTest) {
-    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper = std::make_shared<MOCK_ODBC_HELPER>();
-    EXPECT_CALL(*mock_odbc_helper, TestConnectionToServer(testing::_, testing::_)).Times(1).WillOnce(Return(true));
+    // routers are handed out from the monitor's last poll, without connecting to them first
 
     std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
     mock_monitor->test_limitless_routers.push_back(HostInfo("test_host1", 5432, UP, true, nullptr, 101)); // round robin should choose this one
@@ -183,7 +204,7 @@ TEST_F(LimitlessMonitorServiceTest, ImmediateMonitorTest) {
         .Times(1)
         .WillOnce(Invoke(mock_monitor.get(), &MOCK_LIMITLESS_ROUTER_MONITOR::MockOpen));
 
-    LimitlessMonitorService limitless_monitor_service(mock_odbc_helper);
+    LimitlessMonitorService limitless_monitor_service;
     std::string test_service_id = "service_1";
 
     limitless_monitor_service.NewService(test_service_id, test_connection_string_immediate_c_str, test_host_port, mock_monitor);
@@ -206,7 +227,7 @@ TEST_F(LimitlessMonitorServiceTest, ImmediateMonitorTest) {
 }
 
 TEST_F(LimitlessMonitorServiceTest, NoMonitorTest) {
-    LimitlessMonitorService limitless_monitor_service(std::make_shared<MOCK_ODBC_HELPER>());
+    LimitlessMonitorService limitless_monitor_service;
     EXPECT_FALSE(limitless_monitor_service.CheckService("this_service_does_not_exist"));
     EXPECT_TRUE(limitless_monitor_service.GetHostInfo("this_one_neither") == nullptr);
 
@@ -215,35 +236,270 @@ TEST_F(LimitlessMonitorServiceTest, NoMonitorTest) {
     limitless_monitor_service.DecrementReferenceCounter("non_existent");
 }
 
-TEST_F(LimitlessMonitorServiceTest, SelectHighestWeightOnBadRoundRobinHost) {
-    std::shared_ptr<MOCK_ODBC_HELPER> mock_odbc_helper = std::make_shared<MOCK_ODBC_HELPER>();
-    // there should be a single call testing the connection to the round robin host (hosta), and the mock monitor should return false
-    // NOTE: gtest displays a warning as the mocked method will return false by default anyways,
-    //   but this expect call is useful to ensure the round robin host is chosen first
-    EXPECT_CALL(*mock_odbc_helper, TestConnectionToServer(testing::_, "hosta")).Times(1).WillOnce(Return(false));
-    EXPECT_CALL(*mock_odbc_helper, TestConnectionToServer(testing::_, "hostz")).Times(1).WillOnce(Return(true));
+TEST_F(LimitlessMonitorServiceTest, StopDoesNotWaitForPollInterval) {
+    std::map<SQLSTR, SQLSTR> conn_str_map;
+    conn_str_map[SERVER_HOST_KEY] = TEXT("limitless.shardgrp-1234.us-east-2.rds.amazonaws.com");
+    conn_str_map[LIMITLESS_MODE_KEY] = LIMITLESS_MODE_VALUE_LAZY;
+    conn_str_map[LIMITLESS_MONITOR_INTERVAL_MS_KEY] = TEXT("60000");
+    SQLSTR conn_str = ConnectionStringHelper::BuildConnectionString(conn_str_map);
+
+    LimitlessMonitorService limitless_monitor_service;
+    std::string test_service_id = "service_1";
+    // lazy, the monitor's first poll is only due after the interval
+    EXPECT_TRUE(limitless_monitor_service.NewService(test_service_id, AS_SQLTCHAR(conn_str.c_str()), test_host_port, std::make_shared<LimitlessRouterMonitor>()));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    limitless_monitor_service.DecrementReferenceCounter(test_service_id);
+    EXPECT_FALSE(limitless_monitor_service.CheckService(test_service_id));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
 
+TEST_F(LimitlessMonitorServiceTest, SkipRouterReportedDown) {
     std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
     mock_monitor->test_limitless_routers.push_back(HostInfo("hosta", 5432, UP, true, nullptr, 100)); // round robin choice (alphabetical; a < z)
-    mock_monitor->test_limitless_routers.push_back(HostInfo("hostz", 5432, UP, true, nullptr, 200)); // highest weight choice (200 > 100)
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hostz", 5432, UP, true, nullptr, 200));
 
     EXPECT_CALL(*mock_monitor, Open(true, test_connection_string_immediate_c_str, test_host_port, TEST_LIMITLESS_MONITOR_INTERVAL_MS, testing::_, testing::_))
         .Times(1)
         .WillOnce(Invoke(mock_monitor.get(), &MOCK_LIMITLESS_ROUTER_MONITOR::MockOpen));
 
-    LimitlessMonitorService limitless_monitor_service(mock_odbc_helper);
+    LimitlessMonitorService limitless_monitor_service;
     std::string test_service_id = "service_1";
     limitless_monitor_service.NewService(test_service_id, test_connection_string_immediate_c_str, test_host_port, mock_monitor);
     EXPECT_TRUE(limitless_monitor_service.CheckService(test_service_id));
 
-    // check host immediately, as limitless mode is immediate
+    // the caller failed to connect to the round robin choice
     std::shared_ptr<HostInfo> host_info = limitless_monitor_service.GetHostInfo(test_service_id);
-    EXPECT_TRUE(host_info != nullptr);
-    if (host_info != nullptr) {
-        EXPECT_EQ(host_info->GetHost(), "hostz"); // highest weight host - not round robin choice
+    ASSERT_TRUE(host_info != nullptr);
+    EXPECT_EQ(host_info->GetHost(), "hosta");
+    limitless_monitor_service.ReportRouterFailure(test_service_id, "hosta");
+
+    // only the router that is still up is handed out until the monitor reaches hosta again
+    for (int i = 0; i < 3; i++) {
+        host_info = limitless_monitor_service.GetHostInfo(test_service_id);
+        ASSERT_TRUE(host_info != nullptr);
+        EXPECT_EQ(host_info->GetHost(), "hostz");
     }
 
+    limitless_monitor_service.ReportRouterFailure(test_service_id, "hostz");
+    EXPECT_TRUE(limitless_monitor_service.GetHostInfo(test_service_id) == nullptr);
+
+    // reports for unknown services are ignored
+    limitless_monitor_service.ReportRouterFailure("non_existent", "hosta");
+
     // clean up monitor service
     limitless_monitor_service.DecrementReferenceCounter(test_service_id);
     EXPECT_FALSE(limitless_monitor_service.CheckService(test_service_id));
 }
+
+TEST_F(LimitlessMonitorServiceTest, UnreachableRouterMarkedDown) {
+    std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
+    std::shared_ptr<std::vector<HostInfo>> limitless_routers = std::make_shared<std::vector<HostInfo>>();
+    std::shared_ptr<std::mutex> limitless_routers_mutex = std::make_shared<std::mutex>();
+    mock_monitor->MockOpen(true, nullptr, test_host_port, TEST_LIMITLESS_MONITOR_INTERVAL_MS, limitless_routers, limitless_routers_mutex);
+
+    // no caller reported hosta, the monitor finds it unreachable on its own
+    EXPECT_CALL(*mock_monitor, TestRouter("hosta"))
+        .WillOnce(Return(false))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_monitor, TestRouter("hostz")).WillRepeatedly(Return(true));
+
+    std::vector<HostInfo> polled_routers = { HostInfo("hosta", 5432, UP, true, nullptr, 100), HostInfo("hostz", 5432, UP, true, nullptr, 200) };
+    EXPECT_TRUE(mock_monitor->mock_update_router_health(polled_routers));
+    ASSERT_EQ(2, limitless_routers->size());
+    EXPECT_FALSE(limitless_routers->at(0).IsHostUp());
+    EXPECT_TRUE(limitless_routers->at(1).IsHostUp());
+
+    // marked up again once it is reachable
+    polled_routers = { HostInfo("hosta", 5432, UP, true, nullptr, 100), HostInfo("hostz", 5432, UP, true, nullptr, 200) };
+    EXPECT_FALSE(mock_monitor->mock_update_router_health(polled_routers));
+    EXPECT_TRUE(limitless_routers->at(0).IsHostUp());
+    EXPECT_TRUE(limitless_routers->at(1).IsHostUp());
+}
+
+TEST_F(LimitlessMonitorServiceTest, SlowServiceDoesNotBlockOthers) {
+    const auto open_delay = std::chrono::milliseconds(500);
+    LimitlessMonitorService limitless_monitor_service;
+
+    std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> fast_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
+    fast_monitor->test_limitless_routers.push_back(HostInfo("fast_host", 5432, UP, true, nullptr, 100));
+    EXPECT_CALL(*fast_monitor, Open(true, test_connection_string_immediate_c_str, test_host_port, TEST_LIMITLESS_MONITOR_INTERVAL_MS, testing::_, testing::_))
+        .Times(1)
+        .WillOnce(Invoke(fast_monitor.get(), &MOCK_LIMITLESS_ROUTER_MONITOR::MockOpen));
+    std::string fast_service_id = "fast_service";
+    limitless_monitor_service.NewService(fast_service_id, test_connection_string_immediate_c_str, test_host_port, fast_monitor);
+
+    // the first poll of this service takes a while, like a connect to an unresponsive shard group
+    std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> slow_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
+    slow_monitor->test_limitless_routers.push_back(HostInfo("slow_host", 5432, UP, true, nullptr, 100));
+    MOCK_LIMITLESS_ROUTER_MONITOR* slow_monitor_ptr = slow_monitor.get();
+    std::atomic<bool> slow_open_started = false;
+    EXPECT_CALL(*slow_monitor, Open(true, test_connection_string_immediate_c_str, test_host_port, TEST_LIMITLESS_MONITOR_INTERVAL_MS, testing::_, testing::_))
+        .Times(1)
+        .WillOnce(Invoke([slow_monitor_ptr, open_delay, &slow_open_started](bool block, const SQLTCHAR *conn_str, int port, unsigned int interval_ms,
+            std::shared_ptr<std::vector<HostInfo>>& limitless_routers, std::shared_ptr<std::mutex>& limitless_routers_mutex) {
+            slow_open_started = true;
+            std::this_thread::sleep_for(open_delay);
+            slow_monitor_ptr->MockOpen(block, conn_str, port, interval_ms, limitless_routers, limitless_routers_mutex);
+        }));
+    std::string slow_service_id = "slow_service";
+    std::thread slow_service_thread([&limitless_monitor_service, &slow_service_id, &slow_monitor] {
+        limitless_monitor_service.NewService(slow_service_id, test_connection_string_immediate_c_str, test_host_port, slow_monitor);
+    });
+
+    // wait for the slow service to start initializing
+    while (!slow_open_started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // the other service is not held up by the one initializing
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(limitless_monitor_service.CheckService(slow_service_id));
+    std::shared_ptr<HostInfo> host_info = limitless_monitor_service.GetHostInfo(fast_service_id);
+    limitless_monitor_service.IncrementReferenceCounter(fast_service_id);
+    limitless_monitor_service.DecrementReferenceCounter(fast_service_id);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, open_delay / 2);
+    ASSERT_TRUE(host_info != nullptr);
+    EXPECT_EQ(host_info->GetHost(), "fast_host");
+
+    // callers of the slow service wait for its first set of routers
+    host_info = limitless_monitor_service.GetHostInfo(slow_service_id);
+    ASSERT_TRUE(host_info != nullptr);
+    EXPECT_EQ(host_info->GetHost(), "slow_host");
+
+    slow_service_thread.join();
+    limitless_monitor_service.DecrementReferenceCounter(fast_service_id);
+    limitless_monitor_service.DecrementReferenceCounter(slow_service_id);
+    EXPECT_FALSE(limitless_monitor_service.CheckService(fast_service_id));
+    EXPECT_FALSE(limitless_monitor_service.CheckService(slow_service_id));
+}
+
+class LimitlessRouterSelectionTest : public testing::Test {
+  protected:
+    std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> mock_monitor;
+    SQLSTR conn_str;
+    LimitlessMonitorService limitless_monitor_service;
+    std::string service_id = "service_1";
+
+    // Runs per test case
+    void SetUp() override {
+        mock_monitor = std::make_shared<MOCK_LIMITLESS_ROUTER_MONITOR>();
+    }
+    void TearDown() override {
+        limitless_monitor_service.DecrementReferenceCounter(service_id);
+    }
+
+    void start_service(const SQLSTR& router_selection) {
+        std::map<SQLSTR, SQLSTR> conn_str_map;
+        conn_str_map[SERVER_HOST_KEY] = TEXT("limitless.shardgrp-1234.us-east-2.rds.amazonaws.com");
+        conn_str_map[LIMITLESS_MONITOR_INTERVAL_MS_KEY] = StringHelper::ToSQLSTR(std::to_string(TEST_LIMITLESS_MONITOR_INTERVAL_MS));
+        conn_str_map[LIMITLESS_MODE_KEY] = LIMITLESS_MODE_VALUE_IMMEDIATE;
+        conn_str_map[LIMITLESS_ROUTER_SELECTION_KEY] = router_selection;
+        conn_str = ConnectionStringHelper::BuildConnectionString(conn_str_map);
+
+        EXPECT_CALL(*mock_monitor, Open(true, testing::_, test_host_port, TEST_LIMITLESS_MONITOR_INTERVAL_MS, testing::_, testing::_))
+            .Times(1)
+            .WillOnce(Invoke(mock_monitor.get(), &MOCK_LIMITLESS_ROUTER_MONITOR::MockOpen));
+        std::shared_ptr<MOCK_LIMITLESS_ROUTER_MONITOR> monitor = mock_monitor;
+        ASSERT_TRUE(limitless_monitor_service.NewService(service_id, AS_SQLTCHAR(conn_str.c_str()), test_host_port, monitor));
+    }
+
+    std::map<std::string, int> select(int count) {
+        std::map<std::string, int> selections;
+        for (int i = 0; i < count; i++) {
+            std::shared_ptr<HostInfo> host_info = limitless_monitor_service.GetHostInfo(service_id);
+            if (host_info != nullptr) {
+                selections[host_info->GetHost()]++;
+            }
+        }
+        return selections;
+    }
+};
+
+TEST_F(LimitlessRouterSelectionTest, LeastOutstandingBalancesRouters) {
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hosta", 5432, UP, true, nullptr, 2));
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hostb", 5432, UP, true, nullptr, 1));
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hostc", 5432, UP, true, nullptr, 1));
+    start_service(LIMITLESS_ROUTER_SELECTION_VALUE_LEAST_OUTSTANDING);
+
+    // in proportion to the polled weights, without any release in between
+    std::map<std::string, int> selections = select(400);
+    EXPECT_NEAR(200, selections["hosta"], 2);
+    EXPECT_NEAR(100, selections["hostb"], 2);
+    EXPECT_NEAR(100, selections["hostc"], 2);
+}
+
+TEST_F(LimitlessRouterSelectionTest, PowerOfTwoBalancesRouters) {
+    for (const std::string& host : { "hosta", "hostb", "hostc", "hostd" }) {
+        mock_monitor->test_limitless_routers.push_back(HostInfo(host, 5432, UP, true, nullptr, 5));
+    }
+    start_service(LIMITLESS_ROUTER_SELECTION_VALUE_POWER_OF_TWO);
+
+    // the busier of two sampled routers is never picked, which keeps counts close together
+    std::map<std::string, int> selections = select(400);
+    ASSERT_EQ(4, selections.size());
+    for (const auto& [host, count] : selections) {
+        EXPECT_NEAR(100, count, 10) << host;
+    }
+}
+
+TEST_F(LimitlessRouterSelectionTest, ReleasedRouterPreferred) {
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hosta", 5432, UP, true, nullptr, 1));
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hostb", 5432, UP, true, nullptr, 1));
+    start_service(LIMITLESS_ROUTER_SELECTION_VALUE_LEAST_OUTSTANDING);
+
+    std::shared_ptr<HostInfo> first = limitless_monitor_service.GetHostInfo(service_id);
+    std::shared_ptr<HostInfo> second = limitless_monitor_service.GetHostInfo(service_id);
+    ASSERT_TRUE(first != nullptr && second != nullptr);
+    EXPECT_NE(first->GetHost(), second->GetHost());
+
+    limitless_monitor_service.ReleaseHost(service_id, first->GetHost());
+    for (int i = 0; i < 3; i++) {
+        std::shared_ptr<HostInfo> next = limitless_monitor_service.GetHostInfo(service_id);
+        ASSERT_TRUE(next != nullptr);
+        EXPECT_EQ(first->GetHost(), next->GetHost());
+        limitless_monitor_service.ReleaseHost(service_id, next->GetHost());
+    }
+
+    // releasing more than was handed out has no effect
+    limitless_monitor_service.ReleaseHost(service_id, first->GetHost());
+    limitless_monitor_service.ReleaseHost(service_id, "unknown");
+}
+
+TEST_F(LimitlessRouterSelectionTest, FailedRouterReleased) {
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hosta", 5432, UP, true, nullptr, 1));
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hostb", 5432, UP, true, nullptr, 1));
+    start_service(LIMITLESS_ROUTER_SELECTION_VALUE_LEAST_OUTSTANDING);
+
+    std::shared_ptr<HostInfo> failed = limitless_monitor_service.GetHostInfo(service_id);
+    std::shared_ptr<HostInfo> connected = limitless_monitor_service.GetHostInfo(service_id);
+    ASSERT_TRUE(failed != nullptr && connected != nullptr);
+    limitless_monitor_service.ReportRouterFailure(service_id, failed->GetHost());
+
+    // reachable again, and no longer counted for the connection that failed
+    EXPECT_CALL(*mock_monitor, TestRouter(testing::_)).WillRepeatedly(Return(true));
+    std::vector<HostInfo> polled_routers = mock_monitor->test_limitless_routers;
+    EXPECT_FALSE(mock_monitor->mock_update_router_health(polled_routers));
+    for (int i = 0; i < 3; i++) {
+        std::shared_ptr<HostInfo> next = limitless_monitor_service.GetHostInfo(service_id);
+        ASSERT_TRUE(next != nullptr);
+        EXPECT_EQ(failed->GetHost(), next->GetHost());
+        limitless_monitor_service.ReleaseHost(service_id, next->GetHost());
+    }
+}
+
+TEST_F(LimitlessRouterSelectionTest, DownRoutersSkipped) {
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hosta", 5432, UP, true, nullptr, 1));
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hostb", 5432, UP, true, nullptr, 1));
+    mock_monitor->test_limitless_routers.push_back(HostInfo("hostc", 5432, UP, true, nullptr, 1));
+    start_service(LIMITLESS_ROUTER_SELECTION_VALUE_POWER_OF_TWO);
+
+    limitless_monitor_service.ReportRouterFailure(service_id, "hostb");
+    std::map<std::string, int> selections = select(100);
+    EXPECT_EQ(0, selections["hostb"]);
+    EXPECT_EQ(100, selections["hosta"] + selections["hostc"]);
+
+    limitless_monitor_service.ReportRouterFailure(service_id, "hosta");
+    limitless_monitor_service.ReportRouterFailure(service_id, "hostc");
+    EXPECT_TRUE(limitless_monitor_service.GetHostInfo(service_id) == nullptr);
+}
@@ -0,0 +1,87 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "limitless_poll_interval.h"
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using std::chrono::milliseconds;
+
+namespace {
+    const std::vector<std::pair<std::string, double>> two_routers = { {"router1", 0.2}, {"router2", 0.4} };
+    const std::vector<std::pair<std::string, double>> three_routers = { {"router1", 0.2}, {"router2", 0.4}, {"router3", 0.0} };
+    const std::vector<std::pair<std::string, double>> shifted_load = { {"router1", 0.2}, {"router2", 0.6} };
+    const std::vector<std::pair<std::string, double>> noisy_load = { {"router1", 0.25}, {"router2", 0.35} };
+}
+
+class LimitlessPollIntervalTest : public testing::Test {
+protected:
+    // without jitter
+    LimitlessPollInterval poll_interval{ milliseconds(8000), milliseconds(32000), 0.0 };
+};
+
+TEST_F(LimitlessPollIntervalTest, BacksOffWhileUnchanged) {
+    EXPECT_EQ(milliseconds(8000), poll_interval.Update(two_routers, false));
+    EXPECT_EQ(milliseconds(16000), poll_interval.Update(two_routers, false));
+    // small load changes do not count
+    EXPECT_EQ(milliseconds(32000), poll_interval.Update(noisy_load, false));
+    EXPECT_EQ(milliseconds(32000), poll_interval.Update(noisy_load, false));
+}
+
+TEST_F(LimitlessPollIntervalTest, SpeedsUpOnChange) {
+    poll_interval.Update(two_routers, false);
+    poll_interval.Update(two_routers, false);
+
+    // router added
+    EXPECT_EQ(milliseconds(2000), poll_interval.Update(three_routers, false));
+    EXPECT_EQ(milliseconds(4000), poll_interval.Update(three_routers, false));
+    // router removed
+    EXPECT_EQ(milliseconds(2000), poll_interval.Update(two_routers, false));
+    // load shifted
+    EXPECT_EQ(milliseconds(2000), poll_interval.Update(shifted_load, false));
+}
+
+TEST_F(LimitlessPollIntervalTest, CappedWhileRoutersDown) {
+    poll_interval.Update(two_routers, false);
+    EXPECT_EQ(milliseconds(8000), poll_interval.Update(two_routers, true));
+    EXPECT_EQ(milliseconds(2000), poll_interval.Update(three_routers, true));
+}
+
+TEST_F(LimitlessPollIntervalTest, Reset) {
+    poll_interval.Update(two_routers, false);
+    poll_interval.Update(two_routers, false);
+    EXPECT_EQ(milliseconds(8000), poll_interval.Reset());
+
+    // the routers polled before the reset are still compared against
+    EXPECT_EQ(milliseconds(16000), poll_interval.Update(two_routers, false));
+}
+
+TEST_F(LimitlessPollIntervalTest, Jitter) {
+    LimitlessPollInterval jittered(milliseconds(8000), milliseconds(32000), 0.25);
+    bool varied = false;
+    milliseconds first = jittered.Reset();
+    for (int i = 0; i < 100; i++) {
+        milliseconds delay = jittered.Reset();
+        EXPECT_GE(delay, milliseconds(6000));
+        EXPECT_LE(delay, milliseconds(10000));
+        varied = varied || delay != first;
+    }
+    EXPECT_TRUE(varied);
+    EXPECT_EQ(milliseconds(8000), jittered.GetInterval());
+}
@@ -0,0 +1,92 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "limitless_query_helper.h"
+
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    const int test_host_port = 5432;
+    const double NO_LOAD = std::numeric_limits<double>::quiet_NaN();
+}
+
+class LimitlessQueryHelperTest : public testing::Test {
+protected:
+    std::unordered_map<std::string, double> smoothed_loads;
+
+    std::vector<HostInfo> poll(const std::vector<std::pair<std::string, double>>& router_loads, double smoothing) {
+        return LimitlessQueryHelper::SmoothRouterLoads(router_loads, smoothing, smoothed_loads, test_host_port);
+    }
+};
+
+TEST_F(LimitlessQueryHelperTest, WeightsKeepLoadResolution) {
+    std::vector<HostInfo> routers = poll({ {"router1", 0.41}, {"router2", 0.44}, {"router3", 0.0} }, 1.0);
+    ASSERT_EQ(3, routers.size());
+    EXPECT_EQ("router1", routers[0].GetHost());
+    EXPECT_EQ(test_host_port, routers[0].GetPort());
+    EXPECT_TRUE(routers[0].IsHostUp());
+
+    // both rounded to the same weight out of 10 before
+    EXPECT_EQ(590000, routers[0].GetWeight());
+    EXPECT_EQ(560000, routers[1].GetWeight());
+    EXPECT_EQ(LimitlessQueryHelper::MAX_WEIGHT, routers[2].GetWeight());
+}
+
+TEST_F(LimitlessQueryHelperTest, OutOfRangeLoadsClamped) {
+    std::vector<HostInfo> routers = poll({ {"negative", -0.2}, {"overloaded", 1.3}, {"no_load", NO_LOAD} }, 1.0);
+    ASSERT_EQ(3, routers.size());
+    EXPECT_EQ(LimitlessQueryHelper::MAX_WEIGHT, routers[0].GetWeight());
+    EXPECT_EQ(LimitlessQueryHelper::MIN_WEIGHT, routers[1].GetWeight());
+    EXPECT_EQ(LimitlessQueryHelper::MIN_WEIGHT, routers[2].GetWeight());
+}
+
+TEST_F(LimitlessQueryHelperTest, LoadSmoothedAcrossPolls) {
+    poll({ {"router1", 0.2}, {"router2", 0.6} }, 0.25);
+    EXPECT_DOUBLE_EQ(0.2, smoothed_loads["router1"]);
+
+    // a single spike moves the load by a quarter of the difference
+    std::vector<HostInfo> routers = poll({ {"router1", 1.0}, {"router2", 0.6} }, 0.25);
+    EXPECT_DOUBLE_EQ(0.4, smoothed_loads["router1"]);
+    EXPECT_EQ(600000, routers[0].GetWeight());
+    EXPECT_EQ(400000, routers[1].GetWeight());
+    EXPECT_GT(routers[0].GetWeight(), routers[1].GetWeight());
+
+    // a router without a load keeps its smoothed load
+    routers = poll({ {"router1", NO_LOAD}, {"router2", 0.6} }, 0.25);
+    EXPECT_DOUBLE_EQ(0.4, smoothed_loads["router1"]);
+    EXPECT_EQ(600000, routers[0].GetWeight());
+}
+
+TEST_F(LimitlessQueryHelperTest, RemovedRoutersForgotten) {
+    poll({ {"router1", 0.2}, {"router2", 0.6} }, 0.5);
+    poll({ {"router2", 0.6} }, 0.5);
+    EXPECT_FALSE(smoothed_loads.contains("router1"));
+
+    // starts over at its first sample when it comes back
+    std::vector<HostInfo> routers = poll({ {"router1", 0.9}, {"router2", 0.6} }, 0.5);
+    EXPECT_DOUBLE_EQ(0.9, smoothed_loads["router1"]);
+    EXPECT_EQ(100000, routers[0].GetWeight());
+}
+
+TEST_F(LimitlessQueryHelperTest, RoundRobinWeight) {
+    EXPECT_EQ(10, LimitlessQueryHelper::GetRoundRobinWeight(LimitlessQueryHelper::MAX_WEIGHT));
+    EXPECT_EQ(6, LimitlessQueryHelper::GetRoundRobinWeight(590000));
+    EXPECT_EQ(1, LimitlessQueryHelper::GetRoundRobinWeight(LimitlessQueryHelper::MIN_WEIGHT));
+}
@@ -33,6 +33,7 @@
 #include "limitless_monitor_service.h"
 
 #include "util/odbc_helper.h"
+#include "util/refresh_scheduler.h"
 
 #define TEST_LIMITLESS_MONITOR_INTERVAL_MS 250
 
@@ -92,14 +93,18 @@ class MOCK_LIMITLESS_ROUTER_MONITOR : public LimitlessRouterMonitor {
 public:
     MOCK_METHOD(void, Open, (bool, const SQLTCHAR *, int, unsigned int, std::shared_ptr<std::vector<HostInfo>>&, std::shared_ptr<std::mutex>&), ());
     MOCK_METHOD(bool, IsStopped, (), ());
+    MOCK_METHOD(bool, TestRouter, (const std::string&), ());
 
     std::vector<HostInfo> test_limitless_routers;
 
-    void mock_run(std::shared_ptr<std::vector<HostInfo>> limitless_routers, std::shared_ptr<std::mutex> limitless_routers_mutex) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(this->interval_ms));
+    bool mock_update_router_health(std::vector<HostInfo>& routers) {
+        return this->update_router_health(routers);
+    }
+
+    std::chrono::milliseconds mock_run(std::shared_ptr<std::vector<HostInfo>> limitless_routers, std::shared_ptr<std::mutex> limitless_routers_mutex) {
         std::lock_guard<std::mutex> guard(*limitless_routers_mutex);
         *limitless_routers = this->test_limitless_routers;
-        // join
+        return RefreshScheduler::STOP;
     }
 
     void MockOpen(
@@ -111,12 +116,16 @@ public:
         std::shared_ptr<std::mutex>& limitless_routers_mutex
     ) {
         this->interval_ms = TEST_LIMITLESS_MONITOR_INTERVAL_MS;
+        this->limitless_routers = limitless_routers;
+        this->limitless_routers_mutex = limitless_routers_mutex;
 
         if (block_and_query_immediately) {
             std::lock_guard<std::mutex> guard(*limitless_routers_mutex);
             *limitless_routers = this->test_limitless_routers;
         } else {
-            this->monitor_thread = std::make_shared<std::thread>(&MOCK_LIMITLESS_ROUTER_MONITOR::mock_run, this, limitless_routers, limitless_routers_mutex);
+            this->poll_task_id = RefreshScheduler::Schedule([this, limitless_routers, limitless_routers_mutex] {
+                return this->mock_run(limitless_routers, limitless_routers_mutex);
+            }, std::chrono::milliseconds(this->interval_ms));
         }
     }
 };
@@ -133,7 +142,7 @@ public:
     MOCK_METHOD(bool, BindColumn, (SQLHSTMT, SQLUSMALLINT, SQLSMALLINT, SQLPOINTER, SQLLEN, const std::string&), ());
     MOCK_METHOD(bool, FetchResults, (SQLHSTMT, const std::string&), ());
     MOCK_METHOD(std::string, MergeDiagRecs, (SQLHANDLE handle, int32_t handle_type, const std::string &custom_errmsg), ());
-    MOCK_METHOD(bool, TestConnectionToServer, (const SQLSTR &in_conn_str, const std::string &server), ());
+    MOCK_METHOD(bool, TestConnectionToServer, (const ConnectionStringTemplate &conn_template, const std::string &server), ());
 };
 
 class MOCK_CLUSTER_TOPOLOGY_QUERY_HELPER : public ClusterTopologyQueryHelper {
@@ -153,6 +162,7 @@ public:
     MOCK_METHOD(std::vector<HostInfo>, ForceRefresh, (bool, uint32_t), ());
     MOCK_METHOD(std::vector<HostInfo>, ForceRefresh, (SQLHDBC, uint32_t), ());
     MOCK_METHOD(void, StartMonitor, (), ());
+    MOCK_METHOD(std::shared_ptr<const TopologySnapshot>, GetTopologySnapshot, (), ());
 };
 
 #endif /* __MOCKOBJECTS_H__ */
@@ -67,3 +67,51 @@ TEST_F(ConnectionStringHelperTest, build_connection_string_long) {
     SQLSTR res = ConnectionStringHelper::BuildConnectionString(dest_map);
     EXPECT_EQ(TEXT("A=1;B=2"), res);
 }
+
+TEST_F(ConnectionStringHelperTest, parse_connection_string_braces) {
+    std::map<SQLSTR, SQLSTR> dest_map;
+    ConnectionStringHelper::ParseConnectionString(TEXT("DRIVER={Driver Name};PWD={a;b=}}c};key=value"), dest_map);
+    EXPECT_EQ(dest_map.size(), 3);
+    EXPECT_EQ(dest_map[TEXT("DRIVER")], TEXT("{Driver Name}"));
+    EXPECT_EQ(dest_map[TEXT("PWD")], TEXT("{a;b=}}c}"));
+    EXPECT_EQ(dest_map[TEXT("KEY")], TEXT("value"));
+}
+
+TEST_F(ConnectionStringHelperTest, parse_connection_string_malformed) {
+    std::map<SQLSTR, SQLSTR> dest_map;
+    ConnectionStringHelper::ParseConnectionString(TEXT(";;novalue;=orphan;EMPTY=;KEY==value;key2=value2"), dest_map);
+    EXPECT_EQ(dest_map.size(), 2);
+    EXPECT_EQ(dest_map[TEXT("KEY")], TEXT("=value"));
+    EXPECT_EQ(dest_map[TEXT("KEY2")], TEXT("value2"));
+}
+
+TEST_F(ConnectionStringHelperTest, connection_string_index) {
+    SQLSTR conn_str = TEXT("Server=host;PWD={a;b};Port=5432;ENABLECLUSTERFAILOVER=1");
+    ConnectionStringIndex index(conn_str);
+    EXPECT_EQ(index.GetAttributes().size(), 4);
+    EXPECT_TRUE(index.Contains(TEXT("SERVER")));
+    EXPECT_FALSE(index.Contains(TEXT("UID")));
+    EXPECT_EQ(index.Get(TEXT("port")), TEXT("5432"));
+    EXPECT_EQ(index.Get(TEXT("pwd")), TEXT("{a;b}"));
+    EXPECT_TRUE(index.Get(TEXT("UID")).empty());
+
+    EXPECT_EQ(TEXT("Server=other;PWD={a;b};Port=5432;ENABLECLUSTERFAILOVER=0"),
+              index.With({ { TEXT("SERVER"), TEXT("other") }, { TEXT("ENABLECLUSTERFAILOVER"), TEXT("0") }, { TEXT("UID"), TEXT("user") } }, false));
+    EXPECT_EQ(TEXT("Server=other;PWD={a;b};Port=5432;ENABLECLUSTERFAILOVER=1;UID=user"),
+              index.With({ { TEXT("SERVER"), TEXT("other") }, { TEXT("UID"), TEXT("user") } }, true));
+}
+
+TEST_F(ConnectionStringHelperTest, connection_string_template) {
+    ConnectionStringTemplate conn_template(TEXT("DRIVER={Driver};SERVER=cluster;PORT=5432;ENABLECLUSTERFAILOVER=1"),
+        { { TEXT("ENABLECLUSTERFAILOVER"), TEXT("0") } }, false);
+    EXPECT_EQ(TEXT("DRIVER={Driver};SERVER=host-a;PORT=5432;ENABLECLUSTERFAILOVER=0"), conn_template.ForHost(TEXT("host-a")));
+    EXPECT_EQ(TEXT("DRIVER={Driver};SERVER=host-b;PORT=5432;ENABLECLUSTERFAILOVER=0"), conn_template.ForHost(TEXT("host-b")));
+}
+
+TEST_F(ConnectionStringHelperTest, connection_string_template_without_server) {
+    ConnectionStringTemplate ignore_host(TEXT("DSN=dsn;"), { { TEXT("LIMITLESSENABLED"), TEXT("0") } }, false);
+    EXPECT_EQ(TEXT("DSN=dsn;"), ignore_host.ForHost(TEXT("host")));
+
+    ConnectionStringTemplate append_host(TEXT("DSN=dsn;"), { { TEXT("LIMITLESSENABLED"), TEXT("0") } }, true);
+    EXPECT_EQ(TEXT("DSN=dsn;LIMITLESSENABLED=0;SERVER=host"), append_host.ForHost(TEXT("host")));
+}
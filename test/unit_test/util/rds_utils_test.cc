@@ -14,7 +14,10 @@
 
 #include "rds_utils.h"
 
+#include <random>
+#include <regex>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -34,6 +37,66 @@ namespace {
     const std::string CHINA_REGION_CUSTON_DOMAIN = "custom-test-name.cluster-custom-XYZ.rds.cn-northwest-1.amazonaws.com.cn";
 }  // namespace
 
+// The regular expressions RdsUtils used to be implemented with, the parser has to give the same results
+namespace regex_reference {
+    const std::regex AURORA_DNS_PATTERN(
+        R"#((.+)\.(proxy-|cluster-|cluster-ro-|cluster-custom-|shardgrp-)?([a-zA-Z0-9]+\.([a-zA-Z0-9\-]+)\.rds\.amazonaws\.com))#",
+        std::regex_constants::icase);
+    const std::regex AURORA_PROXY_DNS_PATTERN(R"#((.+)\.(proxy-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#", std::regex_constants::icase);
+    const std::regex AURORA_CLUSTER_PATTERN(R"#((.+)\.(cluster-|cluster-ro-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
+                                            std::regex_constants::icase);
+    const std::regex AURORA_WRITER_CLUSTER_PATTERN(R"#((.+)\.(cluster-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
+                                                   std::regex_constants::icase);
+    const std::regex AURORA_READER_CLUSTER_PATTERN(R"#((.+)\.(cluster-ro-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
+                                                   std::regex_constants::icase);
+    const std::regex AURORA_CUSTOM_CLUSTER_PATTERN(R"#((.+)\.(cluster-custom-)+([a-zA-Z0-9]+\.[a-zA-Z0-9\-]+\.rds\.amazonaws\.com))#",
+                                                   std::regex_constants::icase);
+    const std::regex AURORA_CHINA_DNS_PATTERN(
+        R"#((.+)\.(proxy-|cluster-|cluster-ro-|cluster-custom-|shardgrp-)?([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#",
+        std::regex_constants::icase);
+    const std::regex AURORA_CHINA_PROXY_DNS_PATTERN(
+        R"#((.+)\.(proxy-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
+    const std::regex AURORA_CHINA_CLUSTER_PATTERN(
+        R"#((.+)\.(cluster-|cluster-ro-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#",
+        std::regex_constants::icase);
+    const std::regex AURORA_CHINA_WRITER_CLUSTER_PATTERN(
+        R"#((.+)\.(cluster-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
+    const std::regex AURORA_CHINA_READER_CLUSTER_PATTERN(
+        R"#((.+)\.(cluster-ro-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
+    const std::regex AURORA_CHINA_CUSTOM_CLUSTER_PATTERN(
+        R"#((.+)\.(cluster-custom-)+([a-zA-Z0-9]+\.(rds\.[a-zA-Z0-9\-]+|[a-zA-Z0-9\-]+\.rds)\.amazonaws\.com\.cn))#", std::regex_constants::icase);
+    const std::regex IPV4_PATTERN(
+        R"#(^(([1-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])\.){1}(([0-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])\.){2}([0-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])$)#");
+    const std::regex IPV6_PATTERN(R"#(^[0-9a-fA-F]{1,4}(:[0-9a-fA-F]{1,4}){7}$)#");
+    const std::regex IPV6_COMPRESSED_PATTERN(R"#(^(([0-9A-Fa-f]{1,4}(:[0-9A-Fa-f]{1,4}){0,5})?)::(([0-9A-Fa-f]{1,4}(:[0-9A-Fa-f]{1,4}){0,5})?)$)#");
+
+    bool Match(const std::string& host, const std::regex& pattern, const std::regex& china_pattern) {
+        return std::regex_match(host, pattern) || std::regex_match(host, china_pattern);
+    }
+
+    // Group of the first pattern that matches, if it satisfies the condition on the prefix group
+    std::string Search(const std::string& host, size_t group, int prefix_condition) {
+        for (const std::regex* pattern : { &AURORA_DNS_PATTERN, &AURORA_CHINA_DNS_PATTERN }) {
+            std::smatch m;
+            if (std::regex_search(host, m, *pattern) &&
+                (prefix_condition == 0 || (prefix_condition > 0) == !m.str(2).empty())) {
+                return m.str(group);
+            }
+        }
+        return std::string();
+    }
+
+    std::string GetRdsClusterHostUrl(const std::string& host) {
+        for (const std::regex* pattern : { &AURORA_CLUSTER_PATTERN, &AURORA_CHINA_CLUSTER_PATTERN }) {
+            std::smatch m;
+            if (std::regex_search(host, m, *pattern)) {
+                return m.str(1) + ".cluster-" + m.str(3);
+            }
+        }
+        return std::string();
+    }
+}  // namespace regex_reference
+
 class RdsUtilsTest : public testing::Test {
    protected:
     static void SetUpTestSuite() {}
@@ -151,6 +214,128 @@ TEST_F(RdsUtilsTest, GetRdsInstanceId) {
     EXPECT_EQ(std::string(), RdsUtils::GetRdsInstanceId(US_EAST_REGION_CLUSTER));
 }
 
+TEST_F(RdsUtilsTest, GetRdsRegion) {
+    EXPECT_EQ("us-east-2", RdsUtils::GetRdsRegion(US_EAST_REGION_CLUSTER));
+    EXPECT_EQ("us-east-2", RdsUtils::GetRdsRegion(US_EAST_REGION_INSTANCE));
+    EXPECT_EQ("rds.cn-northwest-1", RdsUtils::GetRdsRegion(CHINA_REGION_CLUSTER));
+    EXPECT_EQ(std::string(), RdsUtils::GetRdsRegion("localhost"));
+}
+
+TEST_F(RdsUtilsTest, ParseHost) {
+    RdsHostInfo info = RdsUtils::ParseHost(CHINA_REGION_CLUSTER_READ_ONLY);
+    EXPECT_TRUE(info.is_rds_dns);
+    EXPECT_TRUE(info.is_rds_cluster_dns);
+    EXPECT_TRUE(info.is_rds_reader_cluster_dns);
+    EXPECT_FALSE(info.is_rds_writer_cluster_dns);
+    EXPECT_TRUE(info.is_china);
+    EXPECT_EQ(RdsPrefixType::CLUSTER_RO, info.prefix_type);
+    EXPECT_EQ("database-test-name", info.cluster_id);
+    EXPECT_TRUE(info.instance_id.empty());
+    EXPECT_EQ("XYZ.rds.cn-northwest-1.amazonaws.com.cn", info.instance_host_domain);
+    EXPECT_EQ("rds.cn-northwest-1", info.region);
+
+    info = RdsUtils::ParseHost(US_EAST_REGION_INSTANCE);
+    EXPECT_TRUE(info.is_rds_dns);
+    EXPECT_FALSE(info.is_rds_cluster_dns);
+    EXPECT_FALSE(info.is_china);
+    EXPECT_EQ(RdsPrefixType::NONE, info.prefix_type);
+    EXPECT_EQ("instance-test-name", info.instance_id);
+    EXPECT_TRUE(info.cluster_host_id.empty());
+}
+
+TEST_F(RdsUtilsTest, IpAddresses) {
+    EXPECT_TRUE(RdsUtils::IsIpv4("10.0.0.255"));
+    EXPECT_FALSE(RdsUtils::IsIpv4("0.1.2.3"));
+    EXPECT_FALSE(RdsUtils::IsIpv4("10.01.2.3"));
+    EXPECT_FALSE(RdsUtils::IsIpv4("10.1.2.256"));
+    EXPECT_FALSE(RdsUtils::IsIpv4("10.1.2"));
+
+    EXPECT_TRUE(RdsUtils::IsIpv6("2001:db8:0:0:0:ff00:42:8329"));
+    EXPECT_TRUE(RdsUtils::IsIpv6("2001:db8::ff00:42:8329"));
+    EXPECT_TRUE(RdsUtils::IsIpv6("::1"));
+    EXPECT_TRUE(RdsUtils::IsIpv6("::"));
+    EXPECT_FALSE(RdsUtils::IsIpv6("2001::db8::1"));
+    EXPECT_FALSE(RdsUtils::IsIpv6("2001:db8:0:0:0:ff00:42"));
+}
+
+// Differential test of the parser against the regular expressions, on random hosts built out of endpoint fragments
+TEST_F(RdsUtilsTest, MatchesRegexReference) {
+    const std::vector<std::string> fragments = {
+        ".", ".", ".", "-", "rds", "RDS", "amazonaws", "com", "cn", "proxy-", "cluster-", "Cluster-", "cluster-ro-",
+        "cluster-custom-", "shardgrp-", "XYZ", "xyz1", "us-east-2", "cn-northwest-1", "database", "a", "?", "_", "\n", "\r",
+        ".rds.amazonaws.com", ".amazonaws.com.cn", ".rds.cn-north-1"
+    };
+    const std::vector<std::string> seeds = {
+        US_EAST_REGION_CLUSTER, US_EAST_REGION_CLUSTER_READ_ONLY, US_EAST_REGION_INSTANCE, US_EAST_REGION_PROXY,
+        US_EAST_REGION_CUSTON_DOMAIN, CHINA_REGION_CLUSTER, CHINA_REGION_CLUSTER_READ_ONLY, CHINA_REGION_PROXY,
+        CHINA_REGION_CUSTON_DOMAIN, "a.shardgrp-XYZ.cn-north-1.rds.amazonaws.com.cn", "a.cluster-cluster-ro-XYZ.rds.rds.amazonaws.com.cn"
+    };
+
+    // The regular expressions backtrack a lot, keep the number of hosts reasonable
+    std::mt19937 rng(20240611);
+    auto pick = [&rng](size_t size) { return std::uniform_int_distribution<size_t>(0, size - 1)(rng); };
+    for (int i = 0; i < 1000; i++) {
+        std::string host;
+        if (i % 2 == 0) {
+            size_t count = 1 + pick(12);
+            for (size_t j = 0; j < count; j++) {
+                host += fragments[pick(fragments.size())];
+            }
+        } else {
+            // Mutate a valid endpoint by replacing, inserting or erasing a fragment
+            host = seeds[pick(seeds.size())];
+            for (size_t mutations = 1 + pick(3); mutations > 0; mutations--) {
+                size_t pos = pick(host.size() + 1);
+                switch (pick(3)) {
+                    case 0:
+                        host.insert(pos, fragments[pick(fragments.size())]);
+                        break;
+                    case 1:
+                        host.erase(pos, 1 + pick(4));
+                        break;
+                    default:
+                        host.replace(pos, 1 + pick(4), fragments[pick(fragments.size())]);
+                        break;
+                }
+            }
+        }
+
+        using namespace regex_reference;
+        SCOPED_TRACE(host);
+        ASSERT_EQ(Match(host, AURORA_DNS_PATTERN, AURORA_CHINA_DNS_PATTERN), RdsUtils::IsRdsDns(host));
+        ASSERT_EQ(Match(host, AURORA_CLUSTER_PATTERN, AURORA_CHINA_CLUSTER_PATTERN), RdsUtils::IsRdsClusterDns(host));
+        ASSERT_EQ(Match(host, AURORA_PROXY_DNS_PATTERN, AURORA_CHINA_PROXY_DNS_PATTERN), RdsUtils::IsRdsProxyDns(host));
+        ASSERT_EQ(Match(host, AURORA_WRITER_CLUSTER_PATTERN, AURORA_CHINA_WRITER_CLUSTER_PATTERN), RdsUtils::IsRdsWriterClusterDns(host));
+        ASSERT_EQ(Match(host, AURORA_READER_CLUSTER_PATTERN, AURORA_CHINA_READER_CLUSTER_PATTERN), RdsUtils::IsRdsReaderClusterDns(host));
+        ASSERT_EQ(Match(host, AURORA_CUSTOM_CLUSTER_PATTERN, AURORA_CHINA_CUSTOM_CLUSTER_PATTERN), RdsUtils::IsRdsCustomClusterDns(host));
+        ASSERT_EQ(regex_reference::GetRdsClusterHostUrl(host), RdsUtils::GetRdsClusterHostUrl(host));
+        ASSERT_EQ(Search(host, 1, 1), RdsUtils::GetRdsClusterId(host));
+        ASSERT_EQ(Search(host, 1, -1), RdsUtils::GetRdsInstanceId(host));
+        std::string domain = Search(host, 3, 0);
+        ASSERT_EQ(domain.empty() ? domain : "?." + domain, RdsUtils::GetRdsInstanceHostPattern(host));
+        ASSERT_EQ(Search(host, 4, 0), RdsUtils::GetRdsRegion(host));
+    }
+}
+
+TEST_F(RdsUtilsTest, IpAddressesMatchRegexReference) {
+    const std::vector<std::string> groups = { "", "0", "1", "9", "25", "199", "255", "256", "01", "a", "F", "g", "ffff", "12345" };
+    const std::vector<std::string> separators = { ".", ".", ":", ":", "::", "\n" };
+
+    std::mt19937 rng(20240611);
+    auto pick = [&rng](size_t size) { return std::uniform_int_distribution<size_t>(0, size - 1)(rng); };
+    for (int i = 0; i < 20000; i++) {
+        std::string host = groups[pick(groups.size())];
+        for (size_t count = pick(10); count > 0; count--) {
+            host += separators[pick(separators.size())] + groups[pick(groups.size())];
+        }
+
+        using namespace regex_reference;
+        SCOPED_TRACE(host);
+        ASSERT_EQ(std::regex_match(host, IPV4_PATTERN), RdsUtils::IsIpv4(host));
+        ASSERT_EQ(std::regex_match(host, IPV6_PATTERN) || std::regex_match(host, IPV6_COMPRESSED_PATTERN), RdsUtils::IsIpv6(host));
+    }
+}
+
 #ifdef WIN32
 TEST_F(RdsUtilsTest, sqlwchar_to_string_converted) {
     EXPECT_EQ("Wide character string", StringHelper::ToString(L"Wide character string"));
@@ -0,0 +1,191 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "refresh_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using std::chrono::milliseconds;
+
+namespace {
+    const std::chrono::seconds wait_timeout = std::chrono::seconds(5);
+    const milliseconds long_interval = milliseconds(std::chrono::minutes(10));
+
+    // Polls until the condition holds, tasks run on the scheduler's workers
+    template <typename Condition>
+    bool wait_for(Condition condition) {
+        auto deadline = std::chrono::steady_clock::now() + wait_timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(milliseconds(5));
+        }
+        return true;
+    }
+}
+
+class RefreshSchedulerTest : public testing::Test {
+  protected:
+    // Runs once per suite
+    static void SetUpTestSuite() {}
+    static void TearDownTestSuite() {}
+    // Runs per test case
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(RefreshSchedulerTest, runs_until_stopped) {
+    std::atomic<int> runs = 0;
+    uint64_t task_id = RefreshScheduler::Schedule([&runs] {
+        return ++runs < 3 ? milliseconds(10) : RefreshScheduler::STOP;
+    }, milliseconds(0));
+
+    EXPECT_TRUE(wait_for([&runs] { return runs == 3; }));
+    std::this_thread::sleep_for(milliseconds(50));
+    EXPECT_EQ(3, runs);
+
+    // Already removed
+    RefreshScheduler::Cancel(task_id);
+}
+
+TEST_F(RefreshSchedulerTest, cancel_waiting_task_is_immediate) {
+    std::atomic<int> runs = 0;
+    uint64_t task_id = RefreshScheduler::Schedule([&runs] {
+        runs++;
+        return long_interval;
+    }, milliseconds(0));
+    EXPECT_TRUE(wait_for([&runs] { return runs == 1; }));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    RefreshScheduler::Cancel(task_id);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, milliseconds(100));
+
+    RefreshScheduler::Wake(task_id);
+    std::this_thread::sleep_for(milliseconds(50));
+    EXPECT_EQ(1, runs);
+}
+
+TEST_F(RefreshSchedulerTest, cancel_waits_for_running_task) {
+    std::promise<void> started;
+    std::atomic<bool> finished = false;
+    uint64_t task_id = RefreshScheduler::Schedule([&started, &finished] {
+        started.set_value();
+        std::this_thread::sleep_for(milliseconds(200));
+        finished = true;
+        return milliseconds(0);
+    }, milliseconds(0));
+
+    ASSERT_EQ(std::future_status::ready, started.get_future().wait_for(wait_timeout));
+    RefreshScheduler::Cancel(task_id);
+    EXPECT_TRUE(finished);
+}
+
+TEST_F(RefreshSchedulerTest, task_cancels_itself) {
+    size_t task_count = RefreshScheduler::GetTaskCount();
+    std::atomic<int> runs = 0;
+    std::atomic<uint64_t> task_id = 0;
+    std::promise<void> scheduled;
+    std::shared_future<void> scheduled_future = scheduled.get_future().share();
+    task_id = RefreshScheduler::Schedule([&runs, &task_id, scheduled_future] {
+        scheduled_future.wait();
+        runs++;
+        RefreshScheduler::Cancel(task_id);
+        return milliseconds(0);
+    }, milliseconds(0));
+    scheduled.set_value();
+
+    EXPECT_TRUE(wait_for([task_count] { return RefreshScheduler::GetTaskCount() == task_count; }));
+    EXPECT_EQ(1, runs);
+}
+
+TEST_F(RefreshSchedulerTest, wake_runs_waiting_task) {
+    size_t task_count = RefreshScheduler::GetTaskCount();
+    std::atomic<int> runs = 0;
+    uint64_t task_id = RefreshScheduler::Schedule([&runs] {
+        runs++;
+        return long_interval;
+    }, long_interval);
+
+    std::this_thread::sleep_for(milliseconds(50));
+    EXPECT_EQ(0, runs);
+
+    RefreshScheduler::Wake(task_id);
+    EXPECT_TRUE(wait_for([&runs] { return runs == 1; }));
+    RefreshScheduler::Wake(task_id);
+    EXPECT_TRUE(wait_for([&runs] { return runs == 2; }));
+
+    RefreshScheduler::Cancel(task_id);
+    EXPECT_EQ(task_count, RefreshScheduler::GetTaskCount());
+}
+
+TEST_F(RefreshSchedulerTest, earlier_task_runs_first) {
+    std::atomic<int> runs = 0;
+    uint64_t late_task_id = RefreshScheduler::Schedule([] { return RefreshScheduler::STOP; }, long_interval);
+    RefreshScheduler::Schedule([&runs] {
+        runs++;
+        return RefreshScheduler::STOP;
+    }, milliseconds(10));
+
+    EXPECT_TRUE(wait_for([&runs] { return runs == 1; }));
+    RefreshScheduler::Cancel(late_task_id);
+}
+
+TEST_F(RefreshSchedulerTest, blocked_tasks_do_not_delay_others) {
+    // More blocked refreshes than idle workers kept, as when several clusters stop answering
+    const int blocked_count = static_cast<int>(RefreshScheduler::GetPoolSize()) + 2;
+    std::promise<void> unblock;
+    std::shared_future<void> unblocked = unblock.get_future().share();
+    std::atomic<int> blocked = 0;
+
+    std::vector<uint64_t> task_ids;
+    for (int i = 0; i < blocked_count; i++) {
+        task_ids.push_back(RefreshScheduler::Schedule([&blocked, unblocked] {
+            blocked++;
+            unblocked.wait_for(wait_timeout);
+            return RefreshScheduler::STOP;
+        }, milliseconds(0)));
+    }
+    EXPECT_TRUE(wait_for([&blocked, blocked_count] { return blocked == blocked_count; }));
+
+    std::atomic<int> runs = 0;
+    task_ids.push_back(RefreshScheduler::Schedule([&runs] {
+        return ++runs < 3 ? milliseconds(10) : RefreshScheduler::STOP;
+    }, milliseconds(0)));
+    EXPECT_TRUE(wait_for([&runs] { return runs == 3; }));
+    EXPECT_GT(RefreshScheduler::GetWorkerCount(), static_cast<uint32_t>(blocked_count));
+
+    unblock.set_value();
+    for (uint64_t task_id : task_ids) {
+        RefreshScheduler::Cancel(task_id);
+    }
+}
+
+TEST_F(RefreshSchedulerTest, failed_task_removed) {
+    size_t task_count = RefreshScheduler::GetTaskCount();
+    uint64_t task_id = RefreshScheduler::Schedule([]() -> milliseconds {
+        throw std::runtime_error("refresh failed");
+    }, milliseconds(0));
+
+    EXPECT_TRUE(wait_for([task_count] { return RefreshScheduler::GetTaskCount() == task_count; }));
+    RefreshScheduler::Cancel(task_id);
+}
@@ -16,6 +16,7 @@
 
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -156,3 +157,30 @@ TEST_F(SlidingCacheMapTest, ttl_update_get) {
     EXPECT_EQ(1, cache.Size());
     EXPECT_STREQ(cache_val_a.c_str(), cache.Get(cache_key_a).c_str());
 }
+
+TEST_F(SlidingCacheMapTest, concurrent_access) {
+    SlidingCacheMap<std::string, std::string> cache;
+    const int thread_count = 8;
+    const int keys_per_thread = 500;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; t++) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < keys_per_thread; i++) {
+                std::string key = std::to_string(t) + "_" + std::to_string(i);
+                cache.Put(key, key);
+                EXPECT_STREQ(key.c_str(), cache.Get(key).c_str());
+                // Shared keys are read by every thread
+                cache.putIfAbsent(cache_key_a, cache_val_a);
+                EXPECT_STREQ(cache_val_a.c_str(), cache.Get(cache_key_a).c_str());
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(thread_count * keys_per_thread + 1, cache.Size());
+    cache.Clear();
+    EXPECT_EQ(0, cache.Size());
+}